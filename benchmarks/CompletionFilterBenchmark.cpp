@@ -0,0 +1,166 @@
+/**
+ * Benchmark of completion filtering on a large symbol list.
+ *
+ * Usage: CompletionFilterBenchmark [options]
+ *   --items N     Completion items to generate (default 20000)
+ *   --legacy      Also time the lowercase prefix filter and full sort
+ *                 CompletionWidget used before CompletionModel
+ *
+ * Types a few identifiers one character at a time, as the popup sees
+ * them, and reports the slowest and average time per keystroke. The
+ * top matches for each full identifier are printed to make changes to
+ * the ranking visible.
+ */
+
+#include "editor/CompletionModel.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+constexpr int TOP_SHOWN = 5;
+
+// Library-style names: a few word parts joined in camelCase or with
+// underscores, so boundaries and humps both occur
+QList<LSPCompletionItem> generateItems(int count)
+{
+    static const char* const WORDS[] = {
+        "get", "set", "value", "string", "buffer", "index", "node", "tree",
+        "parse", "token", "stream", "reader", "writer", "file", "path", "list",
+        "map", "hash", "count", "size", "begin", "end", "insert", "remove",
+        "update", "render", "layout", "widget", "model", "view", "item", "data",
+    };
+    constexpr int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    QList<LSPCompletionItem> items;
+    items.reserve(count);
+    quint32 seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        int parts = 2 + (seed >> 8) % 3;
+        bool snake = (seed >> 20) % 4 == 0;
+        QString label;
+        for (int p = 0; p < parts; ++p) {
+            seed = seed * 1103515245u + 12345u;
+            QString word = QString::fromLatin1(WORDS[(seed >> 8) % WORD_COUNT]);
+            if (p > 0) {
+                if (snake) {
+                    label += QLatin1Char('_');
+                } else {
+                    word[0] = word[0].toUpper();
+                }
+            }
+            label += word;
+        }
+        label += QString::number(i % 97);
+
+        LSPCompletionItem item;
+        item.label = label;
+        item.kind = (seed >> 16) % 2 ? CompletionItemKind::Method : CompletionItemKind::Field;
+        items.append(item);
+    }
+    return items;
+}
+
+// The filter CompletionWidget::populateList ran on every keystroke
+int runLegacy(const QList<LSPCompletionItem>& items, const QString& prefix)
+{
+    QList<LSPCompletionItem> filtered;
+    QString lowerPrefix = prefix.toLower();
+    for (const LSPCompletionItem& item : items) {
+        if (lowerPrefix.isEmpty() || item.label.toLower().startsWith(lowerPrefix)) {
+            filtered.append(item);
+        }
+    }
+    std::sort(filtered.begin(), filtered.end(),
+        [&lowerPrefix](const LSPCompletionItem& a, const LSPCompletionItem& b) {
+            bool aExact = a.label.toLower().startsWith(lowerPrefix);
+            bool bExact = b.label.toLower().startsWith(lowerPrefix);
+            if (aExact != bExact) return aExact;
+            return a.label.toLower() < b.label.toLower();
+        });
+    return filtered.size();
+}
+
+template <typename Filter>
+void report(QTextStream& out, const QString& name, const QStringList& words, Filter filter)
+{
+    qint64 worstNs = 0;
+    qint64 totalNs = 0;
+    int keystrokes = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        for (const QString& word : words) {
+            for (int length = 1; length <= word.size(); ++length) {
+                QElapsedTimer timer;
+                timer.start();
+                filter(word.left(length));
+                qint64 elapsed = timer.nsecsElapsed();
+                worstNs = qMax(worstNs, elapsed);
+                totalNs += elapsed;
+                ++keystrokes;
+            }
+        }
+    }
+
+    out << QString("%1: %2 keystrokes, average %3 ms, worst %4 ms\n")
+               .arg(name, -8)
+               .arg(keystrokes)
+               .arg(totalNs / 1e6 / keystrokes, 0, 'f', 3)
+               .arg(worstNs / 1e6, 0, 'f', 3);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+
+    int itemCount = 20000;
+    bool legacy = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--legacy") {
+            legacy = true;
+        } else if (arg == "--items" && i + 1 < argc) {
+            itemCount = QString::fromLocal8Bit(argv[++i]).toInt();
+        }
+    }
+
+    QList<LSPCompletionItem> items = generateItems(itemCount);
+    const QStringList words = {"getValue", "gv", "parse_token", "ptk", "wdgLay", "insertNode"};
+
+    // Receiving the list is paid once per server response
+    CompletionModel model;
+    QElapsedTimer timer;
+    timer.start();
+    model.setItems(items, QString());
+    out << QString("setItems: %1 items in %2 ms\n").arg(items.size()).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 3);
+
+    report(out, "model", words, [&model](const QString& filter) {
+        model.setFilter(filter);
+    });
+
+    for (const QString& word : words) {
+        model.setFilter(word);
+        QStringList top;
+        for (int row = 0; row < qMin(TOP_SHOWN, model.rowCount()); ++row) {
+            top << model.item(row).label;
+        }
+        out << QString("  %1 -> %2\n").arg(word, -12).arg(top.join(", "));
+    }
+
+    if (legacy) {
+        report(out, "legacy", words, [&items](const QString& filter) {
+            runLegacy(items, filter);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * Scriptable stand-in for the XXML language server.
+ *
+ * Speaks Content-Length framed JSON-RPC over stdio and answers the
+ * requests XXMLStudio sends with generated payloads of configurable size,
+ * optionally after a delay. Used by LSPClientBenchmark; also handy for
+ * poking at the IDE without the real toolchain.
+ *
+ * Usage: FakeLspServer [options]
+ *   --completion-items N   Items per completion response (default 50)
+ *   --symbols N            Top-level symbols per documentSymbol response (default 20)
+ *   --diagnostics N        Diagnostics published after didOpen/didChange (default 0)
+ *   --hover-bytes N        Size of the hover markdown (default 256)
+ *   --delay-ms N           Delay before every response (default 0)
+ *   --script FILE          JSON object mapping method -> {"result"|"error", "delayMs"}
+ *                          whose entries replace the generated responses
+ *
+ * Every option can also be given as an environment variable, e.g.
+ * FAKE_LSP_COMPLETION_ITEMS, since LSPClient does not pass arguments
+ * through. Unknown arguments (such as -I paths) are ignored.
+ */
+
+#include "lsp/MessageFramer.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QThread>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace XXMLStudio;
+
+namespace {
+
+struct Options {
+    int completionItems = 50;
+    int symbols = 20;
+    int diagnostics = 0;
+    int hoverBytes = 256;
+    int delayMs = 0;
+    QJsonObject script;
+};
+
+int intOption(const char* envName, int fallback)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(envName, &ok);
+    return ok ? value : fallback;
+}
+
+bool loadScript(const QString& path, QJsonObject& script)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "FakeLspServer: cannot open %s\n", qPrintable(path));
+        return false;
+    }
+    script = QJsonDocument::fromJson(file.readAll()).object();
+    return true;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    options.completionItems = intOption("FAKE_LSP_COMPLETION_ITEMS", options.completionItems);
+    options.symbols = intOption("FAKE_LSP_SYMBOLS", options.symbols);
+    options.diagnostics = intOption("FAKE_LSP_DIAGNOSTICS", options.diagnostics);
+    options.hoverBytes = intOption("FAKE_LSP_HOVER_BYTES", options.hoverBytes);
+    options.delayMs = intOption("FAKE_LSP_DELAY_MS", options.delayMs);
+
+    QString scriptPath = qEnvironmentVariable("FAKE_LSP_SCRIPT");
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        QByteArray arg(argv[i]);
+        QByteArray value(argv[i + 1]);
+        if (arg == "--completion-items") {
+            options.completionItems = value.toInt();
+        } else if (arg == "--symbols") {
+            options.symbols = value.toInt();
+        } else if (arg == "--diagnostics") {
+            options.diagnostics = value.toInt();
+        } else if (arg == "--hover-bytes") {
+            options.hoverBytes = value.toInt();
+        } else if (arg == "--delay-ms") {
+            options.delayMs = value.toInt();
+        } else if (arg == "--script") {
+            scriptPath = QString::fromLocal8Bit(value);
+        } else {
+            continue;
+        }
+        ++i;
+    }
+
+    return scriptPath.isEmpty() || loadScript(scriptPath, options.script);
+}
+
+QJsonObject range(int line, int startCharacter, int endCharacter)
+{
+    return QJsonObject{
+        {"start", QJsonObject{{"line", line}, {"character", startCharacter}}},
+        {"end", QJsonObject{{"line", line}, {"character", endCharacter}}}
+    };
+}
+
+QJsonValue completionResult(const Options& options)
+{
+    QJsonArray items;
+    for (int i = 0; i < options.completionItems; ++i) {
+        items.append(QJsonObject{
+            {"label", QString("member%1").arg(i)},
+            {"kind", 2 + i % 20},
+            {"detail", QString("Integer^ member%1(String^ name)").arg(i)},
+            {"insertText", QString("member%1").arg(i)}
+        });
+    }
+    return QJsonObject{{"isIncomplete", false}, {"items", items}};
+}
+
+QJsonValue hoverResult(const Options& options)
+{
+    return QJsonObject{
+        {"contents", QJsonObject{
+            {"kind", "markdown"},
+            {"value", QString(options.hoverBytes, QLatin1Char('x'))}
+        }},
+        {"range", range(0, 0, 8)}
+    };
+}
+
+QJsonValue symbolsResult(const Options& options)
+{
+    QJsonArray symbols;
+    for (int i = 0; i < options.symbols; ++i) {
+        QJsonArray children;
+        for (int j = 0; j < 5; ++j) {
+            children.append(QJsonObject{
+                {"name", QString("method%1").arg(j)},
+                {"kind", 6},
+                {"range", range(i * 10 + j + 1, 4, 40)},
+                {"selectionRange", range(i * 10 + j + 1, 11, 18)}
+            });
+        }
+        symbols.append(QJsonObject{
+            {"name", QString("Class%1").arg(i)},
+            {"kind", 5},
+            {"range", range(i * 10, 0, 1)},
+            {"selectionRange", range(i * 10, 10, 16)},
+            {"children", children}
+        });
+    }
+    return symbols;
+}
+
+QJsonValue locationsResult(const QJsonObject& params)
+{
+    QString uri = params["textDocument"].toObject()["uri"].toString();
+    return QJsonArray{QJsonObject{{"uri", uri}, {"range", range(0, 0, 8)}}};
+}
+
+// Returns as soon as some input is available, unlike fread
+qsizetype readStdin(char* buffer, qsizetype size)
+{
+#ifdef Q_OS_WIN
+    return _read(0, buffer, static_cast<unsigned int>(size));
+#else
+    return ::read(STDIN_FILENO, buffer, static_cast<size_t>(size));
+#endif
+}
+
+class FakeServer
+{
+public:
+    explicit FakeServer(const Options& options) : m_options(options) {}
+
+    // Returns the process exit code
+    int run()
+    {
+        char buffer[64 * 1024];
+        QByteArray body;
+        while (!m_exit) {
+            qsizetype read = readStdin(buffer, sizeof(buffer));
+            if (read <= 0) {
+                break;  // Client closed the pipe
+            }
+
+            m_framer.append(QByteArray(buffer, read));
+            MessageFramer::Result result;
+            while (!m_exit && (result = m_framer.next(body)) != MessageFramer::Result::NeedMoreData) {
+                if (result == MessageFramer::Result::Message) {
+                    handle(QJsonDocument::fromJson(body).object());
+                }
+            }
+        }
+        return m_shutdown ? 0 : 1;
+    }
+
+private:
+    void handle(const QJsonObject& message)
+    {
+        QString method = message["method"].toString();
+        QJsonObject params = message["params"].toObject();
+
+        if (!message.contains("id")) {
+            handleNotification(method, params);
+            return;
+        }
+
+        QJsonValue id = message["id"];
+        QJsonObject response{{"jsonrpc", "2.0"}, {"id", id}};
+        int delayMs = m_options.delayMs;
+
+        if (m_options.script.contains(method)) {
+            QJsonObject canned = m_options.script[method].toObject();
+            delayMs = canned["delayMs"].toInt(delayMs);
+            if (canned.contains("error")) {
+                response["error"] = canned["error"];
+            } else {
+                response["result"] = canned["result"];
+            }
+        } else if (method == "initialize") {
+            response["result"] = QJsonObject{
+                {"capabilities", QJsonObject{
+                    {"textDocumentSync", 2},
+                    {"completionProvider", QJsonObject{{"triggerCharacters", QJsonArray{".", ":"}}}},
+                    {"hoverProvider", true},
+                    {"definitionProvider", true},
+                    {"referencesProvider", true},
+                    {"documentSymbolProvider", true}
+                }},
+                {"serverInfo", QJsonObject{{"name", "FakeLspServer"}}}
+            };
+        } else if (method == "shutdown") {
+            m_shutdown = true;
+            response["result"] = QJsonValue::Null;
+        } else if (method == "textDocument/completion") {
+            response["result"] = completionResult(m_options);
+        } else if (method == "textDocument/hover") {
+            response["result"] = hoverResult(m_options);
+        } else if (method == "textDocument/documentSymbol") {
+            response["result"] = symbolsResult(m_options);
+        } else if (method == "textDocument/definition" || method == "textDocument/references") {
+            response["result"] = locationsResult(params);
+        } else {
+            response["error"] = QJsonObject{
+                {"code", -32601},
+                {"message", QString("Method not found: %1").arg(method)}
+            };
+        }
+
+        if (delayMs > 0) {
+            QThread::msleep(delayMs);
+        }
+        write(response);
+    }
+
+    void handleNotification(const QString& method, const QJsonObject& params)
+    {
+        if (method == "exit") {
+            m_exit = true;
+        } else if (method == "textDocument/didOpen" || method == "textDocument/didChange") {
+            publishDiagnostics(params["textDocument"].toObject()["uri"].toString());
+        }
+        // Everything else, including $/cancelRequest, is ignored: requests
+        // are answered in order as soon as they are read
+    }
+
+    void publishDiagnostics(const QString& uri)
+    {
+        if (m_options.diagnostics <= 0) {
+            return;
+        }
+
+        QJsonArray diagnostics;
+        for (int i = 0; i < m_options.diagnostics; ++i) {
+            diagnostics.append(QJsonObject{
+                {"range", range(i, 4, 18)},
+                {"severity", 1 + i % 4},
+                {"source", "xxml"},
+                {"message", QString("Undeclared identifier 'value%1'").arg(i)}
+            });
+        }
+
+        write(QJsonObject{
+            {"jsonrpc", "2.0"},
+            {"method", "textDocument/publishDiagnostics"},
+            {"params", QJsonObject{{"uri", uri}, {"diagnostics", diagnostics}}}
+        });
+    }
+
+    void write(const QJsonObject& message)
+    {
+        QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        QByteArray header = "Content-Length: " + QByteArray::number(json.size()) + "\r\n\r\n";
+        std::fwrite(header.constData(), 1, header.size(), stdout);
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    Options m_options;
+    MessageFramer m_framer;
+    bool m_shutdown = false;
+    bool m_exit = false;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    FakeServer server(options);
+    return server.run();
+}
@@ -0,0 +1,232 @@
+/**
+ * Benchmark of parsing `git status --porcelain=v2 -z` output.
+ *
+ * Usage: GitStatusBenchmark [options]
+ *   --entries N   Status entries to generate (default 200000)
+ *   --chunk N     Bytes per chunk fed to the streaming parser, like
+ *                 reads from the process pipe (default 65536)
+ *   --legacy      Also time the line-splitting parser GitManager used
+ *                 before, on the same entries without -z
+ *
+ * Generates a status of mostly untracked and modified files under
+ * build-style directories, with some renames and conflicts, then parses
+ * it whole and in chunks and reports the best time of a few runs.
+ */
+
+#include "git/GitStatusParser.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+#include <limits>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+
+// The same entries with NUL terminators for -z and with newlines
+struct GeneratedStatus {
+    QByteArray nulTerminated;
+    QByteArray newlineTerminated;
+};
+
+GeneratedStatus generateStatus(int count)
+{
+    static const char* const DIRS[] = {
+        "build", "out", "gen", "obj", "src", "node_modules", "third_party", "cache",
+    };
+    constexpr int DIR_COUNT = sizeof(DIRS) / sizeof(DIRS[0]);
+
+    GeneratedStatus status;
+    auto add = [&status](const QByteArray& record) {
+        status.nulTerminated += record;
+        status.nulTerminated += '\0';
+        status.newlineTerminated += record;
+        status.newlineTerminated += '\n';
+    };
+    add("# branch.oid 3f2a9c1d5e7b8a0f4c6d2e1b9a8f7c6d5e4b3a21");
+    add("# branch.head main");
+    add("# branch.upstream origin/main");
+    add("# branch.ab +2 -5");
+
+    quint32 seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        QByteArray path = DIRS[(seed >> 8) % DIR_COUNT];
+        path += '/';
+        path += QByteArray::number((seed >> 12) % 64);
+        path += "/generated file ";
+        path += QByteArray::number(i);
+        path += ".o";
+
+        const int kind = (seed >> 20) % 100;
+        if (kind < 60) {
+            add("? " + path);
+        } else if (kind < 90) {
+            add("1 .M N... 100644 100644 100644 e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 "
+                "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 " + path);
+        } else if (kind < 95) {
+            // Without -z the original path follows a tab on the same line
+            QByteArray record = "2 R. N... 100644 100644 100644 e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 "
+                                "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 R100 " + path;
+            status.nulTerminated += record + '\0' + "old/" + path + '\0';
+            status.newlineTerminated += record + '\t' + "old/" + path + '\n';
+        } else {
+            add("u UU N... 100644 100644 100644 100644 e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 "
+                "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 e69de29bb2d1d6434b8b29ae775ad8c2e48c5391 " + path);
+        }
+    }
+    return status;
+}
+
+GitFileStatus legacyStatusChar(QChar c)
+{
+    switch (c.toLatin1()) {
+    case 'M': return GitFileStatus::Modified;
+    case 'T': return GitFileStatus::TypeChanged;
+    case 'A': return GitFileStatus::Added;
+    case 'D': return GitFileStatus::Deleted;
+    case 'R': return GitFileStatus::Renamed;
+    case 'C': return GitFileStatus::Copied;
+    case 'U': return GitFileStatus::Conflicted;
+    case '?': return GitFileStatus::Untracked;
+    case '!': return GitFileStatus::Ignored;
+    default: return GitFileStatus::Unmodified;
+    }
+}
+
+// GitManager::parseStatus before the -z parser, including decoding the
+// whole output to a QString first
+GitRepositoryStatus parseLegacy(const QByteArray& bytes)
+{
+    GitRepositoryStatus status;
+    QString output = QString::fromUtf8(bytes);
+    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+
+    for (const QString& line : lines) {
+        if (line.startsWith("# branch.head ")) {
+            status.branch = line.mid(14);
+            if (status.branch == "(detached)") {
+                status.detachedHead = true;
+            }
+        } else if (line.startsWith("# branch.upstream ")) {
+            status.upstream = line.mid(18);
+        } else if (line.startsWith("# branch.ab ")) {
+            QRegularExpression re("\\+(-?\\d+)\\s+(-?\\d+)");
+            QRegularExpressionMatch match = re.match(line);
+            if (match.hasMatch()) {
+                status.aheadCount = match.captured(1).toInt();
+                status.behindCount = -match.captured(2).toInt();
+            }
+        } else if (line.startsWith("1 ") || line.startsWith("2 ")) {
+            GitStatusEntry entry;
+            QStringList parts = line.split(' ');
+            if (parts.size() >= 9) {
+                QString xy = parts[1];
+                entry.indexStatus = legacyStatusChar(xy[0]);
+                entry.workTreeStatus = legacyStatusChar(xy[1]);
+
+                if (line.startsWith("2 ")) {
+                    QString pathPart = parts.mid(8).join(' ');
+                    int tabIndex = pathPart.indexOf('\t');
+                    if (tabIndex != -1) {
+                        entry.path = pathPart.left(tabIndex);
+                        entry.oldPath = pathPart.mid(tabIndex + 1);
+                    } else {
+                        entry.path = pathPart;
+                    }
+                } else {
+                    entry.path = parts.mid(8).join(' ');
+                }
+                status.entries.append(entry);
+            }
+        } else if (line.startsWith("u ")) {
+            GitStatusEntry entry;
+            QStringList parts = line.split(' ');
+            if (parts.size() >= 11) {
+                entry.indexStatus = GitFileStatus::Conflicted;
+                entry.workTreeStatus = GitFileStatus::Conflicted;
+                entry.path = parts.mid(10).join(' ');
+                status.entries.append(entry);
+            }
+        } else if (line.startsWith("? ")) {
+            GitStatusEntry entry;
+            entry.indexStatus = GitFileStatus::Untracked;
+            entry.workTreeStatus = GitFileStatus::Untracked;
+            entry.path = line.mid(2);
+            status.entries.append(entry);
+        }
+    }
+
+    return status;
+}
+
+template <typename Parse>
+void report(QTextStream& out, const QString& name, qsizetype bytes, Parse parse)
+{
+    qint64 bestNs = std::numeric_limits<qint64>::max();
+    int entries = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        entries = parse();
+        bestNs = qMin(bestNs, timer.nsecsElapsed());
+    }
+
+    out << QString("%1: %2 entries in %3 ms (%4 MB/s)\n")
+               .arg(name, -10)
+               .arg(entries)
+               .arg(bestNs / 1e6, 0, 'f', 3)
+               .arg(bytes / 1e6 / (bestNs / 1e9), 0, 'f', 1);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+
+    int entryCount = 200000;
+    int chunkSize = 65536;
+    bool legacy = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--legacy") {
+            legacy = true;
+        } else if (arg == "--entries" && i + 1 < argc) {
+            entryCount = QString::fromLocal8Bit(argv[++i]).toInt();
+        } else if (arg == "--chunk" && i + 1 < argc) {
+            chunkSize = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        }
+    }
+
+    const GeneratedStatus status = generateStatus(entryCount);
+    const QByteArray& output = status.nulTerminated;
+    out << QString("status: %1 entries, %2 MB\n").arg(entryCount).arg(output.size() / 1e6, 0, 'f', 1);
+
+    report(out, "whole", output.size(), [&output]() {
+        return GitStatusParser::parse(output).entries.size();
+    });
+
+    report(out, "streamed", output.size(), [&output, chunkSize]() {
+        GitStatusParser parser;
+        for (qsizetype offset = 0; offset < output.size(); offset += chunkSize) {
+            parser.feed(output.constData() + offset, qMin<qsizetype>(chunkSize, output.size() - offset));
+        }
+        parser.finish();
+        return parser.takeStatus().entries.size();
+    });
+
+    if (legacy) {
+        const QByteArray& lines = status.newlineTerminated;
+        report(out, "legacy", lines.size(), [&lines]() {
+            return parseLegacy(lines).entries.size();
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * Benchmark of XXML syntax highlighting on a large document.
+ *
+ * Usage: HighlighterBenchmark [options]
+ *   --lines N     Lines of generated XXML to highlight (default 100000)
+ *   --file PATH   Highlight this file instead of generated code
+ *   --verify      Also run the regular expression cascade XXMLLexer
+ *                 replaced and compare their per-character formats
+ *
+ * Reports the time XXMLLexer needs on its own and the time a full
+ * QSyntaxHighlighter::rehighlight() takes on a QTextDocument. With
+ * --verify, any character classified differently is printed and the
+ * exit code is 1, which makes a directory of real sources usable as a
+ * golden corpus: for f in *.xxml; do HighlighterBenchmark --verify --file $f; done
+ */
+
+#include "editor/XXMLLexer.h"
+#include "editor/XXMLSyntaxHighlighter.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextDocument>
+#include <QTextStream>
+
+using namespace XXMLStudio;
+
+namespace {
+
+struct Options {
+    int lines = 100000;
+    QString filePath;
+    bool verify = false;
+};
+
+Options parseOptions(const QStringList& args)
+{
+    Options options;
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& arg = args[i];
+        if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--lines" && i + 1 < args.size()) {
+            options.lines = args[++i].toInt();
+        } else if (arg == "--file" && i + 1 < args.size()) {
+            options.filePath = args[++i];
+        }
+    }
+    return options;
+}
+
+// A class with the constructs the highlighter distinguishes; repeated
+// with fresh names until the requested size is reached
+QStringList generateSource(int lineCount)
+{
+    static const char* const TEMPLATE[] = {
+        "#import Language::Core;",
+        "// Generated class %1 with <angle> and \"string\" content",
+        "/* Block comment for %1",
+        "   spanning <several> lines */",
+        "[ Class <Shape%1> Final Extends None",
+        "    [ Public <>",
+        "        Property <width> Types Integer^;",
+        "        Property <values> Types List<Integer>^;",
+        "        Property <callback> Types F(Integer^)(String^)^;",
+        "        Constructor = default;",
+        "        Method <area%1> Returns Integer^ Parameters (Parameter <scale> Types Integer&) Do",
+        "        {",
+        "            Instantiate Integer^ As <result> = width.multiply(scale);",
+        "            Instantiate Float^ As <ratio> = Float::Constructor(3.14f);",
+        "            For (Integer^ <i> = 0 .. 10) -> {",
+        "                If (result.greaterThan(0x1F)) -> { Set result = result.add(i); }",
+        "                Run System::Console::printLine(String::Constructor(\"Area: \\\"%1\\\"\"));",
+        "            }",
+        "            Return this.width.add(result);",
+        "        }",
+        "    ]",
+        "]",
+    };
+    constexpr int TEMPLATE_LINES = sizeof(TEMPLATE) / sizeof(TEMPLATE[0]);
+
+    QStringList lines;
+    lines.reserve(lineCount);
+    for (int i = 0; i < lineCount; ++i) {
+        QString line = QString::fromLatin1(TEMPLATE[i % TEMPLATE_LINES]);
+        if (line.contains("%1")) {
+            line = line.arg(i / TEMPLATE_LINES);
+        }
+        lines.append(line);
+    }
+    return lines;
+}
+
+// The regular expression cascade used before XXMLLexer, kept only as the
+// reference for --verify
+class ReferenceHighlighter
+{
+public:
+    ReferenceHighlighter()
+    {
+        add("\\b[a-z][a-zA-Z0-9_]*\\b", FormatType::Variable);
+
+        const QStringList keywords = {
+            "Namespace", "Class", "Structure", "Final", "Extends", "None",
+            "Public", "Private", "Protected", "Static",
+            "Property", "Types", "NativeType", "NativeStructure",
+            "default", "Method", "Returns", "Parameters", "Parameter",
+            "Entrypoint", "Instantiate", "Let", "As", "Run",
+            "For", "While", "If", "Else", "Exit", "Return", "Break", "Continue",
+            "Constrains", "Constraint", "Require", "Truth", "TypeOf", "On",
+            "Templates", "Compiletime", "Do", "Set", "Lambda",
+            "Annotation", "Annotate", "Allows", "Processor", "Retain", "AnnotationAllow",
+            "Aligns", "CallbackType", "Convention", "Enumeration", "Value"
+        };
+        for (const QString& keyword : keywords) {
+            add("\\b" + keyword + "\\b", FormatType::Keyword);
+        }
+
+        add("(?<=\\[\\s)(Constructor|Destructor)\\b", FormatType::Keyword);
+        add("(?<=(Public|Private|Protected)\\s)(Constructor|Destructor)\\b", FormatType::Keyword);
+        add("\\b(true|false)\\b", FormatType::Keyword);
+        add("\\bthis\\b", FormatType::This);
+        add("\\bF\\s*\\([^)]*\\)\\s*\\([^)]*\\)", FormatType::Type);
+        add("\\b[A-Z][a-zA-Z0-9_]*(?:@[A-Z][a-zA-Z0-9_]*)+", FormatType::TemplateInst);
+        add("\\b[A-Z][a-zA-Z0-9_]*<[^>]+>", FormatType::Type);
+        add("\\b[A-Z][a-zA-Z0-9_]*(?=[\\^&%])", FormatType::Type);
+        add("(?<=Types\\s{1,20})[A-Z][a-zA-Z0-9_]*", FormatType::Type);
+        add("(?<=Returns\\s{1,20})[A-Z][a-zA-Z0-9_]*", FormatType::Type);
+        add("(?<=Extends\\s{1,20})[A-Z][a-zA-Z0-9_]*(?!one)", FormatType::Type);
+        add("\\b[A-Z][a-zA-Z0-9_]*(?=::)", FormatType::Type);
+        add("(?<=::)[A-Z][a-zA-Z0-9_]*|(?<=::)[a-z][a-zA-Z0-9_]*", FormatType::MethodCall);
+        add("\\b[a-z][a-zA-Z0-9_]*(?=\\s*\\()", FormatType::MethodCall);
+        add("(?<=Run\\s)[a-z][a-zA-Z0-9_]*", FormatType::Variable);
+        add("(?<=Run\\s)[A-Z][a-zA-Z0-9_]*", FormatType::Type);
+        add("(?<=Do\\s)[a-zA-Z_][a-zA-Z0-9_]*", FormatType::MethodCall);
+        add("(?<=\\.)[a-zA-Z_][a-zA-Z0-9_]*", FormatType::Identifier);
+        add("(?<=\\.)[a-zA-Z_][a-zA-Z0-9_]*(?=\\s*\\()", FormatType::MethodCall);
+        add("(?<=this\\.)[a-zA-Z_][a-zA-Z0-9_]*", FormatType::Variable);
+        add("(?<=this\\.)[a-zA-Z_][a-zA-Z0-9_]*(?=\\s*\\()", FormatType::MethodCall);
+        add("(?<=For\\s)[a-z][a-zA-Z0-9_]*", FormatType::Variable);
+        add("(?<=Let\\s)[a-z][a-zA-Z0-9_]*", FormatType::Variable);
+        add("(?<=Set\\s)[a-z][a-zA-Z0-9_]*", FormatType::Variable);
+        add("(?<=As\\s)[A-Z][a-zA-Z0-9_]*", FormatType::Type);
+        add("(?<=Instantiate\\s)[A-Z][a-zA-Z0-9_]*", FormatType::Type);
+        add("(?<=(If|While)\\s)[a-z][a-zA-Z0-9_]*", FormatType::Variable);
+        add("[\\^&%]", FormatType::Ownership);
+        add("[\\[\\]]", FormatType::Bracket);
+        add("->", FormatType::Operator);
+        add("\\.\\.", FormatType::Operator);
+        add("::", FormatType::Operator);
+        add("\\b[0-9]+\\.?[0-9]*([eE][+-]?[0-9]+)?[fFdDlLuU]*\\b", FormatType::Number);
+        add("\\b0[xX][0-9a-fA-F]+[uUlL]*\\b", FormatType::Number);
+        add("\\b0[bB][01]+[uUlL]*\\b", FormatType::Number);
+        add("\"(?:[^\"\\\\]|\\\\.)*\"", FormatType::String);
+        add("'(?:[^'\\\\]|\\\\.)'", FormatType::String);
+        add("(?<=#import\\s)[A-Za-z_][A-Za-z0-9_]*(?:::[A-Za-z_][A-Za-z0-9_]*)*", FormatType::ImportPath);
+        add("#import\\b", FormatType::Import);
+        add("//[^\n]*", FormatType::Comment);
+        add("[<>]", FormatType::Operator);
+        add("(?<=<)[a-z][a-zA-Z0-9_]*(?=>)", FormatType::Variable);
+        add("(?<=<)[A-Z][a-zA-Z0-9_]*(?:::[a-zA-Z_][a-zA-Z0-9_]*)*(?=>)", FormatType::Type);
+        add("(?<=Method\\s<)[a-zA-Z_][a-zA-Z0-9_]*(?=>)", FormatType::MethodCall);
+    }
+
+    // Patterns this Qt's PCRE2 rejects (variable-length lookbehind needs 10.43+)
+    QStringList invalidPatterns() const
+    {
+        QStringList invalid;
+        for (const Rule& rule : m_rules) {
+            if (!rule.pattern.isValid()) {
+                invalid.append(rule.pattern.pattern());
+            }
+        }
+        return invalid;
+    }
+
+    // Per-character format (-1 for none); returns the block state
+    int highlight(const QString& text, int previousState, QVector<int>& formats) const
+    {
+        formats.fill(-1, text.size());
+        for (const Rule& rule : m_rules) {
+            QRegularExpressionMatchIterator it = rule.pattern.globalMatch(text);
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                for (qsizetype i = match.capturedStart(); i < match.capturedEnd(); ++i) {
+                    formats[i] = static_cast<int>(rule.formatType);
+                }
+            }
+        }
+
+        QVector<XXMLLexer::Span> comments;
+        int state = XXMLLexer::lexBlockComments(text, previousState, comments);
+        for (const XXMLLexer::Span& span : comments) {
+            for (int i = span.start; i < span.start + span.length; ++i) {
+                formats[i] = static_cast<int>(FormatType::Comment);
+            }
+        }
+        return state;
+    }
+
+private:
+    struct Rule {
+        QRegularExpression pattern;
+        FormatType formatType;
+    };
+
+    void add(const QString& pattern, FormatType formatType)
+    {
+        m_rules.append({QRegularExpression(pattern), formatType});
+    }
+
+    QVector<Rule> m_rules;
+};
+
+int lexerFormats(const QString& text, int previousState, QVector<int>& formats)
+{
+    formats.fill(-1, text.size());
+    QVector<XXMLLexer::Span> spans;
+    XXMLLexer::lexLine(text, false, spans);
+    int state = XXMLLexer::lexBlockComments(text, previousState, spans);
+    for (const XXMLLexer::Span& span : spans) {
+        for (int i = span.start; i < span.start + span.length; ++i) {
+            formats[i] = static_cast<int>(span.formatType);
+        }
+    }
+    return state;
+}
+
+void reportRate(QTextStream& out, const QString& name, qint64 ns, int lines, qint64 chars)
+{
+    double seconds = ns / 1e9;
+    out << QString("%1: %2 ms, %3 lines/s, %4 MB/s\n")
+               .arg(name, -22)
+               .arg(ns / 1e6, 0, 'f', 1)
+               .arg(lines / seconds, 0, 'f', 0)
+               .arg(chars * 2 / (1024.0 * 1024.0) / seconds, 0, 'f', 1);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // No window is ever shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    Options options = parseOptions(app.arguments());
+
+    QStringList lines;
+    if (options.filePath.isEmpty()) {
+        lines = generateSource(options.lines);
+    } else {
+        QFile file(options.filePath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            out << "Cannot open " << options.filePath << "\n";
+            return 1;
+        }
+        lines = QString::fromUtf8(file.readAll()).split('\n');
+    }
+
+    qint64 chars = 0;
+    for (const QString& line : lines) {
+        chars += line.size();
+    }
+    out << QString("%1 lines, %2 characters\n").arg(lines.size()).arg(chars);
+
+    // Lexer alone, the way highlightBlock drives it
+    QVector<XXMLLexer::Span> spans;
+    int state = XXMLLexer::Normal;
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString& line : lines) {
+        spans.clear();
+        XXMLLexer::lexLine(line, false, spans);
+        state = XXMLLexer::lexBlockComments(line, state, spans);
+    }
+    reportRate(out, "XXMLLexer", timer.nsecsElapsed(), lines.size(), chars);
+
+    // Full QSyntaxHighlighter pass, including QTextLayout format updates
+    QTextDocument document;
+    document.setPlainText(lines.join('\n'));
+    XXMLSyntaxHighlighter highlighter(&document);
+    timer.restart();
+    highlighter.rehighlight();
+    reportRate(out, "rehighlight()", timer.nsecsElapsed(), lines.size(), chars);
+
+    if (!options.verify) {
+        return 0;
+    }
+
+    ReferenceHighlighter reference;
+    const QStringList invalid = reference.invalidPatterns();
+    for (const QString& pattern : invalid) {
+        out << "warning: reference pattern not supported by this Qt: " << pattern << "\n";
+    }
+
+    QVector<int> expected;
+    QVector<int> actual;
+    int referenceState = XXMLLexer::Normal;
+    int lexerState = XXMLLexer::Normal;
+    int mismatches = 0;
+    qint64 referenceNs = 0;
+    for (int lineNumber = 0; lineNumber < lines.size(); ++lineNumber) {
+        const QString& line = lines[lineNumber];
+
+        timer.restart();
+        referenceState = reference.highlight(line, referenceState, expected);
+        referenceNs += timer.nsecsElapsed();
+
+        lexerState = lexerFormats(line, lexerState, actual);
+        if (expected != actual || referenceState != lexerState) {
+            if (++mismatches <= 20) {
+                int column = 0;
+                while (column < line.size() && expected[column] == actual[column]) {
+                    ++column;
+                }
+                out << QString("line %1, column %2: %3\n").arg(lineNumber + 1).arg(column + 1).arg(line);
+            }
+        }
+    }
+    reportRate(out, "regex cascade", referenceNs, lines.size(), chars);
+
+    out << QString("%1 of %2 lines differ from the regex cascade\n").arg(mismatches).arg(lines.size());
+    return mismatches == 0 ? 0 : 1;
+}
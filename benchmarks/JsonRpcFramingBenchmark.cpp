@@ -0,0 +1,179 @@
+/**
+ * Throughput benchmark for the LSP Content-Length framing.
+ *
+ * Usage: JsonRpcFramingBenchmark [recorded-traffic-file] [--legacy]
+ *
+ * Without a file, synthesizes a burst of publishDiagnostics messages.
+ * The traffic is fed through MessageFramer in pipe-sized chunks, the
+ * same way JsonRpcClient receives it from the server. --legacy also
+ * runs the previous regex/remove(0, n) parser for comparison.
+ */
+
+#include "lsp/MessageFramer.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QTextStream>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+
+QByteArray frame(const QByteArray& body)
+{
+    return "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+}
+
+// Roughly what a workspace-wide diagnostics burst looks like
+QByteArray synthesizeTraffic(qsizetype targetBytes)
+{
+    QByteArray traffic;
+    int fileIndex = 0;
+    while (traffic.size() < targetBytes) {
+        QByteArray diagnostics;
+        int count = 1 + (fileIndex * 7) % 40;
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) {
+                diagnostics += ',';
+            }
+            diagnostics += "{\"range\":{\"start\":{\"line\":" + QByteArray::number(i * 3)
+                + ",\"character\":4},\"end\":{\"line\":" + QByteArray::number(i * 3)
+                + ",\"character\":18}},\"severity\":1,\"source\":\"xxml\","
+                  "\"message\":\"Undeclared identifier 'value" + QByteArray::number(i) + "'\"}";
+        }
+        QByteArray body = "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\","
+                          "\"params\":{\"uri\":\"file:///project/src/File" + QByteArray::number(fileIndex)
+            + ".xxml\",\"diagnostics\":[" + diagnostics + "]}}";
+        traffic += frame(body);
+        ++fileIndex;
+    }
+    return traffic;
+}
+
+// Splits traffic into varying pipe-sized chunks (4 KiB .. 64 KiB)
+QList<QByteArray> chunk(const QByteArray& traffic)
+{
+    QList<QByteArray> chunks;
+    quint32 seed = 12345;
+    qsizetype pos = 0;
+    while (pos < traffic.size()) {
+        seed = seed * 1103515245u + 12345u;
+        qsizetype size = 4096 + (seed >> 8) % (60 * 1024);
+        chunks.append(traffic.mid(pos, size));
+        pos += size;
+    }
+    return chunks;
+}
+
+qsizetype runFramer(const QList<QByteArray>& chunks)
+{
+    MessageFramer framer;
+    QByteArray body;
+    qsizetype messages = 0;
+    for (const QByteArray& data : chunks) {
+        framer.append(data);
+        while (framer.next(body) == MessageFramer::Result::Message) {
+            ++messages;
+        }
+    }
+    return messages;
+}
+
+// The parser JsonRpcClient used before MessageFramer
+qsizetype runLegacy(const QList<QByteArray>& chunks)
+{
+    static QRegularExpression headerRegex(R"(Content-Length:\s*(\d+)\r\n\r\n)");
+    QByteArray buffer;
+    qsizetype messages = 0;
+    for (const QByteArray& data : chunks) {
+        buffer.append(data);
+        while (!buffer.isEmpty()) {
+            QRegularExpressionMatch match = headerRegex.match(QString::fromUtf8(buffer));
+            if (!match.hasMatch()) {
+                break;
+            }
+            int headerEnd = match.capturedEnd();
+            int contentLength = match.captured(1).toInt();
+            if (buffer.size() < headerEnd + contentLength) {
+                break;
+            }
+            QByteArray body = buffer.mid(headerEnd, contentLength);
+            buffer.remove(0, headerEnd + contentLength);
+            ++messages;
+        }
+    }
+    return messages;
+}
+
+template <typename Parser>
+void report(QTextStream& out, const QString& name, const QList<QByteArray>& chunks,
+            qsizetype totalBytes, Parser parser)
+{
+    qint64 bestNs = -1;
+    qsizetype messages = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        messages = parser(chunks);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (bestNs < 0 || elapsed < bestNs) {
+            bestNs = elapsed;
+        }
+    }
+
+    double seconds = bestNs / 1e9;
+    out << QString("%1: %2 messages, %3 MB in %4 ms -> %5 MB/s, %6 msg/s\n")
+               .arg(name, -8)
+               .arg(messages)
+               .arg(totalBytes / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(seconds * 1000.0, 0, 'f', 2)
+               .arg(totalBytes / (1024.0 * 1024.0) / seconds, 0, 'f', 1)
+               .arg(messages / seconds, 0, 'f', 0);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+
+    QByteArray traffic;
+    bool legacy = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--legacy") {
+            legacy = true;
+            continue;
+        }
+        QFile file(arg);
+        if (!file.open(QIODevice::ReadOnly)) {
+            out << "Cannot open " << arg << ": " << file.errorString() << "\n";
+            return 1;
+        }
+        traffic = file.readAll();
+    }
+
+    if (traffic.isEmpty()) {
+        traffic = synthesizeTraffic(32 * 1024 * 1024);
+    }
+
+    QList<QByteArray> chunks = chunk(traffic);
+    report(out, "framer", chunks, traffic.size(), runFramer);
+
+    if (legacy) {
+        // Quadratic; keep the input small enough to finish
+        QByteArray sample = traffic.left(2 * 1024 * 1024);
+        QList<QByteArray> sampleChunks = chunk(sample);
+        report(out, "framer", sampleChunks, sample.size(), runFramer);
+        report(out, "legacy", sampleChunks, sample.size(), runLegacy);
+    }
+
+    return 0;
+}
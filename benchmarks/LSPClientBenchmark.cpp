@@ -0,0 +1,242 @@
+/**
+ * End-to-end benchmark of LSPClient/JsonRpcClient against FakeLspServer.
+ *
+ * Usage: LSPClientBenchmark [options]
+ *   --server PATH          FakeLspServer executable (default: next to this binary)
+ *   --requests N           Sequential completion round trips (default 500)
+ *   --pipelined N          Definition requests sent back to back (default 5000)
+ *   --changes N            didChange notifications, each answered with diagnostics (default 500)
+ *   --completion-items N   Passed to the server (default 200)
+ *   --diagnostics N        Diagnostics per publish (default 50)
+ *   --delay-ms N           Server-side delay per response (default 0)
+ *
+ * Reports round-trip percentiles, messages/second and bytes/second, and
+ * the server/decode/UI breakdown collected by LSPTrafficMonitor.
+ */
+
+#include "lsp/LSPClient.h"
+#include "lsp/LSPTrafficMonitor.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <functional>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int TIMEOUT_MS = 30000;
+
+struct Options {
+    QString serverPath;
+    int requests = 500;
+    int pipelined = 5000;
+    int changes = 500;
+    int completionItems = 200;
+    int diagnostics = 50;
+    int delayMs = 0;
+};
+
+Options parseOptions(const QStringList& args)
+{
+    Options options;
+    options.serverPath = QDir(QCoreApplication::applicationDirPath()).filePath("FakeLspServer");
+#ifdef Q_OS_WIN
+    options.serverPath += ".exe";
+#endif
+
+    for (int i = 1; i + 1 < args.size(); i += 2) {
+        const QString& arg = args[i];
+        const QString& value = args[i + 1];
+        if (arg == "--server") {
+            options.serverPath = value;
+        } else if (arg == "--requests") {
+            options.requests = value.toInt();
+        } else if (arg == "--pipelined") {
+            options.pipelined = value.toInt();
+        } else if (arg == "--changes") {
+            options.changes = value.toInt();
+        } else if (arg == "--completion-items") {
+            options.completionItems = value.toInt();
+        } else if (arg == "--diagnostics") {
+            options.diagnostics = value.toInt();
+        } else if (arg == "--delay-ms") {
+            options.delayMs = value.toInt();
+        }
+    }
+    return options;
+}
+
+// LSPClient logs every completion through qDebug
+void quietMessageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type != QtDebugMsg) {
+        QTextStream(stderr) << message << "\n";
+    }
+}
+
+bool waitUntil(const std::function<bool()>& done)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > TIMEOUT_MS) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+double percentile(QList<qint64> samples, double p)
+{
+    if (samples.isEmpty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    qsizetype rank = qBound<qsizetype>(0, static_cast<qsizetype>(p / 100.0 * samples.size()), samples.size() - 1);
+    return samples[rank] / 1e6;
+}
+
+void reportThroughput(QTextStream& out, const QString& name, int messages, qint64 bytes, qint64 ns)
+{
+    double seconds = ns / 1e9;
+    out << QString("%1: %2 messages in %3 ms -> %4 msg/s, %5 MB/s\n")
+               .arg(name, -10)
+               .arg(messages)
+               .arg(seconds * 1000.0, 0, 'f', 1)
+               .arg(messages / seconds, 0, 'f', 0)
+               .arg(bytes / (1024.0 * 1024.0) / seconds, 0, 'f', 2);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(quietMessageHandler);
+    QTextStream out(stdout);
+
+    Options options = parseOptions(app.arguments());
+    if (!QFileInfo::exists(options.serverPath)) {
+        out << "Fake server not found: " << options.serverPath << "\n";
+        return 1;
+    }
+
+    // LSPClient passes no arguments through, so configure via environment
+    qputenv("FAKE_LSP_COMPLETION_ITEMS", QByteArray::number(options.completionItems));
+    qputenv("FAKE_LSP_DIAGNOSTICS", QByteArray::number(options.diagnostics));
+    qputenv("FAKE_LSP_DELAY_MS", QByteArray::number(options.delayMs));
+
+    // Keeps processEvents() waking up if the server stops answering
+    QTimer heartbeat;
+    heartbeat.start(100);
+
+    LSPClient client;
+    LSPTrafficMonitor* monitor = client.trafficMonitor();
+
+    bool ready = false;
+    QString lastError;
+    QObject::connect(&client, &LSPClient::initialized, [&ready]() { ready = true; });
+    QObject::connect(&client, &LSPClient::error, [&lastError](const QString& message) { lastError = message; });
+
+    client.start(options.serverPath);
+    if (!waitUntil([&]() { return ready || !lastError.isEmpty(); }) || !ready) {
+        out << "Server did not initialize: " << lastError << "\n";
+        return 1;
+    }
+
+    const QString uri = "file:///bench/Main.xxml";
+    const QString text = "[ Entrypoint\n{\n    Instantiate Integer^ As <x> = Integer::Constructor(0);\n}\n]\n";
+    int version = 1;
+    client.openDocument(uri, "xxml", version, text);
+
+    // Sequential round trips: one completion at a time
+    int completions = 0;
+    QObject::connect(&client, &LSPClient::completionReceived,
+                     [&completions](const QString&, const QList<LSPCompletionItem>&, int) { ++completions; });
+
+    QList<qint64> roundTrips;
+    qint64 bytesBefore = monitor->bytesIn() + monitor->bytesOut();
+    QElapsedTimer total;
+    total.start();
+    for (int i = 0; i < options.requests; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        int expected = completions + 1;
+        client.requestCompletion(uri, 2, 30);
+        if (!waitUntil([&]() { return completions >= expected; })) {
+            out << "Timed out waiting for completion " << i << "\n";
+            return 1;
+        }
+        roundTrips.append(timer.nsecsElapsed());
+    }
+    qint64 sequentialNs = total.nsecsElapsed();
+
+    out << QString("completion round trip (%1 items): p50 %2 ms, p95 %3 ms, p99 %4 ms\n")
+               .arg(options.completionItems)
+               .arg(percentile(roundTrips, 50), 0, 'f', 3)
+               .arg(percentile(roundTrips, 95), 0, 'f', 3)
+               .arg(percentile(roundTrips, 99), 0, 'f', 3);
+    reportThroughput(out, "sequential", options.requests * 2,
+                     monitor->bytesIn() + monitor->bytesOut() - bytesBefore, sequentialNs);
+
+    // Pipelined requests: everything in flight at once
+    int definitions = 0;
+    QObject::connect(&client, &LSPClient::definitionReceived,
+                     [&definitions](const QString&, const QList<LSPLocation>&) { ++definitions; });
+
+    bytesBefore = monitor->bytesIn() + monitor->bytesOut();
+    total.restart();
+    for (int i = 0; i < options.pipelined; ++i) {
+        client.requestDefinition(uri, 2, 10 + i % 20);
+    }
+    if (!waitUntil([&]() { return definitions >= options.pipelined; })) {
+        out << "Timed out with " << definitions << " of " << options.pipelined << " definitions\n";
+        return 1;
+    }
+    reportThroughput(out, "pipelined", options.pipelined * 2,
+                     monitor->bytesIn() + monitor->bytesOut() - bytesBefore, total.nsecsElapsed());
+
+    // Notification traffic: didChange answered by publishDiagnostics
+    int publishes = 0;
+    QObject::connect(&client, &LSPClient::diagnosticsReceived,
+                     [&publishes](const QString&, const QList<LSPDiagnostic>&) { ++publishes; });
+
+    bytesBefore = monitor->bytesIn() + monitor->bytesOut();
+    total.restart();
+    for (int i = 0; i < options.changes; ++i) {
+        client.changeDocument(uri, ++version, text);
+    }
+    if (!waitUntil([&]() { return publishes >= options.changes; })) {
+        out << "Timed out with " << publishes << " of " << options.changes << " diagnostics\n";
+        return 1;
+    }
+    reportThroughput(out, "diagnostics", options.changes * 2,
+                     monitor->bytesIn() + monitor->bytesOut() - bytesBefore, total.nsecsElapsed());
+
+    // Where the time went, per method
+    out << "\nmethod                              server p95  decode p95  ui p95\n";
+    for (const LSPTrafficMonitor::MethodStats& stats : monitor->methodStats()) {
+        if (stats.server.isEmpty() && stats.ui.isEmpty()) {
+            continue;
+        }
+        out << QString("%1 %2 %3 %4\n")
+                   .arg(stats.method, -34)
+                   .arg(QString("%1 ms").arg(stats.server.percentileMs(95), 0, 'f', 3), 11)
+                   .arg(QString("%1 ms").arg(stats.decode.percentileMs(95), 0, 'f', 3), 11)
+                   .arg(QString("%1 ms").arg(stats.ui.percentileMs(95), 0, 'f', 3), 11);
+    }
+    out.flush();
+
+    client.stop();
+    waitUntil([&]() { return client.state() == LSPClient::State::Disconnected; });
+    return 0;
+}
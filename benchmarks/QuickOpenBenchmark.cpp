@@ -0,0 +1,168 @@
+/**
+ * Benchmark of Go to File filtering on a large project tree.
+ *
+ * Usage: QuickOpenBenchmark [options]
+ *   --files N     Paths to generate (default 200000)
+ *   --verify      Also check that matches spread across a deep path,
+ *                 which score below zero, are still listed; the exit
+ *                 code is 1 if one is missing
+ *
+ * Builds a snapshot from generated paths, then types a few queries one
+ * character at a time, as the palette sees them, and reports the
+ * slowest and average time per keystroke. The top matches for each full
+ * query are printed to make changes to the ranking visible.
+ */
+
+#include "core/FuzzyMatcher.h"
+#include "dialogs/QuickOpenModel.h"
+#include "project/ProjectFileIndex.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+constexpr int TOP_SHOWN = 5;
+
+// Source-tree-like paths: a few nested directories from a small
+// vocabulary, so names and directories both repeat
+QStringList generatePaths(int count)
+{
+    static const char* const DIRS[] = {
+        "src", "lib", "core", "editor", "project", "git", "panels", "widgets",
+        "tests", "third_party", "platform", "render", "io", "net", "util", "docs",
+    };
+    static const char* const STEMS[] = {
+        "CodeEditor", "FileLoader", "index", "main", "TextSearch", "Parser",
+        "token_stream", "ProjectManager", "GitStatusModel", "utils", "Widget", "README",
+    };
+    static const char* const EXTENSIONS[] = {".cpp", ".h", ".xxml", ".md", ".txt", ".json"};
+    constexpr int DIR_COUNT = sizeof(DIRS) / sizeof(DIRS[0]);
+    constexpr int STEM_COUNT = sizeof(STEMS) / sizeof(STEMS[0]);
+    constexpr int EXTENSION_COUNT = sizeof(EXTENSIONS) / sizeof(EXTENSIONS[0]);
+
+    QStringList paths;
+    paths.reserve(count);
+    quint32 seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        int depth = 1 + (seed >> 8) % 5;
+        QString path;
+        for (int d = 0; d < depth; ++d) {
+            seed = seed * 1103515245u + 12345u;
+            path += QString::fromLatin1(DIRS[(seed >> 8) % DIR_COUNT]);
+            path += QString::number((seed >> 16) % 8);
+            path += QLatin1Char('/');
+        }
+        seed = seed * 1103515245u + 12345u;
+        path += QString::fromLatin1(STEMS[(seed >> 8) % STEM_COUNT]);
+        path += QString::number(i % 50);
+        path += QString::fromLatin1(EXTENSIONS[(seed >> 16) % EXTENSION_COUNT]);
+        paths.append(path);
+    }
+    return paths;
+}
+
+// A pattern whose characters are far apart in a deep path still matches
+bool verifyLongGaps(QTextStream& out)
+{
+    QString deep = QStringLiteral("alpha/");
+    for (int i = 0; i < 40; ++i) {
+        deep += QStringLiteral("build%1/").arg(i);
+    }
+    deep += QStringLiteral("output.bin");
+    const QStringList paths = {deep, QStringLiteral("docs/readme.md")};
+    const QString query = QStringLiteral("alphaoutput");
+
+    bool ok = true;
+    FuzzyMatcher matcher(query);
+    int score = matcher.score(deep);
+    if (score == FuzzyMatcher::NO_MATCH) {
+        out << QString("verify: FuzzyMatcher rejected %1 for \"%2\"\n").arg(deep, query);
+        ok = false;
+    }
+
+    QuickOpenModel model;
+    model.setSnapshot(ProjectFileIndex::snapshotOf(QStringLiteral("/project"), paths));
+    model.setFilter(query);
+    if (model.matchCount() != 1 || !model.filePath(0).endsWith(QStringLiteral("output.bin"))) {
+        out << QString("verify: QuickOpenModel found %1 matches for \"%2\", expected the deep path\n")
+                   .arg(model.matchCount()).arg(query);
+        ok = false;
+    }
+
+    out << QString("verify: long-gap match scores %1, %2\n").arg(score).arg(ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+
+    int fileCount = 200000;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--verify") {
+            verify = true;
+        } else if (arg == "--files" && i + 1 < argc) {
+            fileCount = QString::fromLocal8Bit(argv[++i]).toInt();
+        }
+    }
+
+    const QStringList paths = generatePaths(fileCount);
+    const QStringList queries = {"codeed", "CodeEditor12.cpp", "src/edit", "gsm", "readme.md", "prjmgr"};
+
+    // Building the snapshot is paid once per walk of the tree
+    QElapsedTimer timer;
+    timer.start();
+    auto snapshot = ProjectFileIndex::snapshotOf(QStringLiteral("/project"), paths);
+    out << QString("snapshot: %1 files, %2 directories, %3 names in %4 ms\n")
+               .arg(snapshot->fileCount())
+               .arg(snapshot->directories.size())
+               .arg(snapshot->names.size())
+               .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 3);
+
+    QuickOpenModel model;
+    model.setSnapshot(snapshot);
+
+    qint64 worstNs = 0;
+    qint64 totalNs = 0;
+    int keystrokes = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        for (const QString& query : queries) {
+            for (int length = 1; length <= query.size(); ++length) {
+                timer.start();
+                model.setFilter(query.left(length));
+                qint64 elapsed = timer.nsecsElapsed();
+                worstNs = qMax(worstNs, elapsed);
+                totalNs += elapsed;
+                ++keystrokes;
+            }
+        }
+    }
+    out << QString("filter: %1 keystrokes, average %2 ms, worst %3 ms\n")
+               .arg(keystrokes)
+               .arg(totalNs / 1e6 / keystrokes, 0, 'f', 3)
+               .arg(worstNs / 1e6, 0, 'f', 3);
+
+    for (const QString& query : queries) {
+        model.setFilter(query);
+        QStringList top;
+        for (int row = 0; row < qMin(TOP_SHOWN, model.rowCount()); ++row) {
+            top << model.filePath(row).mid(QStringLiteral("/project/").size());
+        }
+        out << QString("  %1 -> %2 matches: %3\n").arg(query, -16).arg(model.matchCount()).arg(top.join(", "));
+    }
+
+    if (verify && !verifyLongGaps(out)) {
+        return 1;
+    }
+    return 0;
+}
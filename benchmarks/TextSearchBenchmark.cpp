@@ -0,0 +1,149 @@
+/**
+ * Benchmark of TextSearch, the engine behind Replace All and Find in
+ * Files, on a large generated document.
+ *
+ * Usage: TextSearchBenchmark [options]
+ *   --lines N     Lines to generate (default 200000)
+ *   --verify      Also check that matches stay within lines, as they did
+ *                 with QPlainTextEdit::find(); the exit code is 1 if any
+ *                 case finds different ranges
+ *
+ * Reports the best of a few runs of findAll() for a literal and a few
+ * regular expressions, including anchored ones.
+ */
+
+#include "editor/TextSearch.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <limits>
+
+using namespace XXMLStudio;
+
+namespace {
+
+constexpr int ITERATIONS = 5;
+
+// Indented source-like lines, some with trailing spaces
+QString generateText(int lines)
+{
+    static const char* const STATEMENTS[] = {
+        "Instantiate Integer^ As <count> = Integer::Constructor(0);",
+        "Run Console::printLine(String::Constructor(\"hello\"));",
+        "Return count;",
+        "If (count > limit) -> {",
+        "}",
+        "// TODO: remove the temporary buffer",
+    };
+    constexpr int STATEMENT_COUNT = sizeof(STATEMENTS) / sizeof(STATEMENTS[0]);
+
+    QString text;
+    quint32 seed = 12345;
+    for (int i = 0; i < lines; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        text += QString((seed >> 8) % 4 * 4, QLatin1Char(' '));
+        text += QString::fromLatin1(STATEMENTS[(seed >> 12) % STATEMENT_COUNT]);
+        if ((seed >> 20) % 5 == 0) {
+            text += QStringLiteral("   ");
+        }
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+TextSearch::Options regexOptions()
+{
+    TextSearch::Options options;
+    options.useRegex = true;
+    return options;
+}
+
+void report(QTextStream& out, const QString& text, const QString& pattern, const TextSearch::Options& options)
+{
+    TextSearch search(pattern, options);
+    qint64 bestNs = std::numeric_limits<qint64>::max();
+    int matches = 0;
+    for (int i = 0; i < ITERATIONS; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        matches = search.findAll(text).size();
+        bestNs = qMin(bestNs, timer.nsecsElapsed());
+    }
+    out << QString("%1 %2: %3 matches in %4 ms\n")
+               .arg(options.useRegex ? "regex  " : "literal")
+               .arg(pattern, -24)
+               .arg(matches)
+               .arg(bestNs / 1e6, 0, 'f', 3);
+    out.flush();
+}
+
+// Each case lists the ranges QPlainTextEdit::find() visited, one block
+// at a time
+bool verify(QTextStream& out)
+{
+    struct Case {
+        const char* pattern;
+        const char* text;
+        QVector<TextSearch::Range> expected;
+    };
+    const Case cases[] = {
+        {"^\\s+", "  a\n    b\nc\n", {{0, 2}, {4, 4}}},
+        {"\\s+$", "a  \nb \nc", {{1, 2}, {5, 1}}},
+        {"^foo", "foo\nfoo bar\nbar foo", {{0, 3}, {4, 3}}},
+        {"bar$", "foo bar\r\nbar foo\r\nbar", {{4, 3}, {18, 3}}},
+        {"[^x]+", "ab\ncd", {{0, 2}, {3, 2}}},
+        {"a.*b", "a\nb\naxb", {{4, 3}}},
+    };
+
+    bool ok = true;
+    for (const Case& c : cases) {
+        const QString text = QString::fromLatin1(c.text);
+        const QVector<TextSearch::Range> ranges = TextSearch(QString::fromLatin1(c.pattern), regexOptions()).findAll(text);
+        bool same = ranges.size() == c.expected.size();
+        for (int i = 0; same && i < ranges.size(); ++i) {
+            same = ranges[i].start == c.expected[i].start && ranges[i].length == c.expected[i].length;
+        }
+        if (!same) {
+            QStringList found;
+            for (const TextSearch::Range& range : ranges) {
+                found << QString("%1+%2").arg(range.start).arg(range.length);
+            }
+            out << QString("verify: %1 found [%2]\n").arg(QString::fromLatin1(c.pattern), found.join(", "));
+            ok = false;
+        }
+    }
+    out << QString("verify: %1\n").arg(ok ? "ok" : "FAILED");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+
+    int lineCount = 200000;
+    bool verifyRanges = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--verify") {
+            verifyRanges = true;
+        } else if (arg == "--lines" && i + 1 < argc) {
+            lineCount = QString::fromLocal8Bit(argv[++i]).toInt();
+        }
+    }
+
+    const QString text = generateText(lineCount);
+    out << QString("text: %1 lines, %2 MB\n").arg(lineCount).arg(text.size() * 2 / 1e6, 0, 'f', 1);
+
+    report(out, text, QStringLiteral("count"), TextSearch::Options());
+    report(out, text, QStringLiteral("Integer::\\w+"), regexOptions());
+    report(out, text, QStringLiteral("^\\s+"), regexOptions());
+    report(out, text, QStringLiteral("\\s+$"), regexOptions());
+
+    if (verifyRanges && !verify(out)) {
+        return 1;
+    }
+    return 0;
+}
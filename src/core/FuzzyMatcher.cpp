@@ -0,0 +1,153 @@
+#include "FuzzyMatcher.h"
+
+#include <QChar>
+
+namespace XXMLStudio {
+
+namespace {
+
+enum class CharClass { Delimiter, Lower, Upper, Digit };
+
+inline char16_t fold(char16_t ch)
+{
+    if (ch < 0x80) {
+        return (ch >= u'A' && ch <= u'Z') ? char16_t(ch + (u'a' - u'A')) : ch;
+    }
+    return QChar::toLower(ch);
+}
+
+inline CharClass classOf(char16_t ch)
+{
+    if (ch >= u'a' && ch <= u'z') return CharClass::Lower;
+    if (ch >= u'A' && ch <= u'Z') return CharClass::Upper;
+    if (ch >= u'0' && ch <= u'9') return CharClass::Digit;
+    if (ch < 0x80) return CharClass::Delimiter;
+    if (QChar::isLower(ch)) return CharClass::Lower;
+    if (QChar::isUpper(ch)) return CharClass::Upper;
+    if (QChar::isLetterOrNumber(ch)) return CharClass::Lower;
+    return CharClass::Delimiter;
+}
+
+// Bonus for a character matched right after a character of class previous
+inline int boundaryBonus(CharClass previous, CharClass current)
+{
+    if (current == CharClass::Delimiter) {
+        return 0;
+    }
+    if (previous == CharClass::Delimiter) {
+        return FuzzyMatcher::BONUS_BOUNDARY;
+    }
+    if ((previous == CharClass::Lower && current == CharClass::Upper)
+        || (previous != CharClass::Digit && current == CharClass::Digit)) {
+        return FuzzyMatcher::BONUS_CAMEL;
+    }
+    return 0;
+}
+
+// Letters and digits get a bit each; everything else shares the rest
+inline quint64 maskBit(char16_t folded)
+{
+    if (folded >= u'a' && folded <= u'z') return quint64(1) << (folded - u'a');
+    if (folded >= u'0' && folded <= u'9') return quint64(1) << (26 + folded - u'0');
+    return quint64(1) << (36 + folded % 28);
+}
+
+} // namespace
+
+FuzzyMatcher::FuzzyMatcher(const QString& pattern)
+{
+    setPattern(pattern);
+}
+
+void FuzzyMatcher::setPattern(const QString& pattern)
+{
+    m_pattern = pattern;
+    m_foldedPattern.resize(pattern.size());
+    for (qsizetype i = 0; i < pattern.size(); ++i) {
+        m_foldedPattern[i] = QChar(fold(pattern[i].unicode()));
+    }
+    m_mask = charMask(pattern);
+}
+
+quint64 FuzzyMatcher::charMask(QStringView text)
+{
+    quint64 mask = 0;
+    for (QChar ch : text) {
+        mask |= maskBit(fold(ch.unicode()));
+    }
+    return mask;
+}
+
+int FuzzyMatcher::score(QStringView candidate, quint64 candidateMask) const
+{
+    const qsizetype patternLength = m_foldedPattern.size();
+    if (patternLength == 0) {
+        return 0;
+    }
+    if ((candidateMask & m_mask) != m_mask || candidate.size() < patternLength) {
+        return NO_MATCH;
+    }
+
+    const char16_t* pattern = reinterpret_cast<const char16_t*>(m_foldedPattern.constData());
+    const char16_t* text = candidate.utf16();
+    const qsizetype length = candidate.size();
+
+    // Forward: the first position where the whole pattern has been seen
+    qsizetype end = -1;
+    for (qsizetype i = 0, p = 0; i < length; ++i) {
+        if (fold(text[i]) == pattern[p] && ++p == patternLength) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0) {
+        return NO_MATCH;
+    }
+
+    // Backward from there: the latest start, giving the tightest window
+    qsizetype start = end;
+    for (qsizetype i = end, p = patternLength - 1; i >= 0; --i) {
+        if (fold(text[i]) == pattern[p] && p-- == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    // Score the window
+    int score = 0;
+    int consecutive = 0;
+    bool inGap = false;
+    CharClass previous = start > 0 ? classOf(text[start - 1]) : CharClass::Delimiter;
+    for (qsizetype i = start, p = 0; i <= end; ++i) {
+        char16_t ch = text[i];
+        CharClass current = classOf(ch);
+        if (p < patternLength && fold(ch) == pattern[p]) {
+            int bonus = boundaryBonus(previous, current);
+            if (consecutive > 0) {
+                bonus = qMax(bonus, BONUS_CONSECUTIVE);
+            }
+            if (p == 0) {
+                bonus *= BONUS_FIRST_CHAR_MULTIPLIER;
+            }
+            score += SCORE_MATCH + bonus;
+            if (ch == m_pattern[p].unicode()) {
+                ++score;  // Exact case breaks ties
+            }
+            ++p;
+            ++consecutive;
+            inGap = false;
+        } else {
+            score -= inGap ? PENALTY_GAP_EXTENSION : PENALTY_GAP_START;
+            consecutive = 0;
+            inGap = true;
+        }
+        previous = current;
+    }
+
+    if (start == 0 && end == patternLength - 1) {
+        score += BONUS_PREFIX;
+    }
+    return score;
+}
+
+} // namespace XXMLStudio
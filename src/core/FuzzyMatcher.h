@@ -0,0 +1,61 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QString>
+#include <QStringView>
+#include <limits>
+
+namespace XXMLStudio {
+
+/**
+ * Case-insensitive subsequence matcher in the style of fzf.
+ *
+ * A candidate matches when the pattern's characters appear in it in
+ * order. Matches score higher when they start words (after '_', '.',
+ * '/' and the like), hit camelCase humps, run consecutively or begin
+ * the candidate, and lower for every character skipped in between.
+ *
+ * Candidates are rejected first by comparing 64-bit character-set masks,
+ * which settles most non-matches with a single AND. Callers filtering a
+ * fixed list repeatedly should compute each candidate's mask once with
+ * charMask() and pass it to score().
+ */
+class FuzzyMatcher
+{
+public:
+    explicit FuzzyMatcher(const QString& pattern = QString());
+
+    void setPattern(const QString& pattern);
+    QString pattern() const { return m_pattern; }
+
+    // Score of the best match found, or NO_MATCH. Matches with long gaps
+    // score below zero, so compare against NO_MATCH rather than 0.
+    // An empty pattern matches everything with score 0.
+    int score(QStringView candidate, quint64 candidateMask) const;
+    int score(QStringView candidate) const { return score(candidate, charMask(candidate)); }
+
+    // Set of case-folded characters in the text, hashed to 64 bits
+    static quint64 charMask(QStringView text);
+
+    static constexpr int NO_MATCH = std::numeric_limits<int>::min();
+
+    // Score components, as in fzf
+    static constexpr int SCORE_MATCH = 16;
+    static constexpr int PENALTY_GAP_START = 3;
+    static constexpr int PENALTY_GAP_EXTENSION = 1;
+    static constexpr int BONUS_BOUNDARY = 8;
+    static constexpr int BONUS_CAMEL = 7;
+    static constexpr int BONUS_CONSECUTIVE = PENALTY_GAP_START + PENALTY_GAP_EXTENSION;
+    static constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+    // Keeps plain prefix matches ahead, as the old prefix filter did
+    static constexpr int BONUS_PREFIX = 2 * SCORE_MATCH;
+
+private:
+    QString m_pattern;
+    QString m_foldedPattern;
+    quint64 m_mask = 0;
+};
+
+} // namespace XXMLStudio
+
+#endif // FUZZYMATCHER_H
@@ -231,6 +231,17 @@ void Settings::setWordWrap(bool wrap)
     emit editorSettingsChanged();
 }
 
+int Settings::largeFileThresholdMB() const
+{
+    return m_settings.value("Editor/largeFileThresholdMB", 64).toInt();
+}
+
+void Settings::setLargeFileThresholdMB(int megabytes)
+{
+    m_settings.setValue("Editor/largeFileThresholdMB", megabytes);
+    emit editorSettingsChanged();
+}
+
 // =============================================================================
 // Build settings
 // =============================================================================
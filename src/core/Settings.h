@@ -58,6 +58,10 @@ public:
     bool wordWrap() const;
     void setWordWrap(bool wrap);
 
+    // Files at least this large open in the read-only large file viewer
+    int largeFileThresholdMB() const;
+    void setLargeFileThresholdMB(int megabytes);
+
     // Build settings
     QString activeConfiguration() const;
     void setActiveConfiguration(const QString& config);
@@ -0,0 +1,115 @@
+#include "QuickOpenDialog.h"
+#include "QuickOpenModel.h"
+#include "../project/ProjectFileIndex.h"
+
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QVBoxLayout>
+
+namespace XXMLStudio {
+
+QuickOpenDialog::QuickOpenDialog(ProjectFileIndex* index, QWidget* parent)
+    : QDialog(parent)
+    , m_index(index)
+{
+    setWindowTitle(tr("Go to File"));
+    resize(640, 420);
+    setupUi();
+
+    m_model->setSnapshot(m_index->snapshot());
+    m_listView->setCurrentIndex(m_model->index(0, 0));
+    updateStatus();
+
+    // The tree may still be indexing, or change while the palette is open
+    connect(m_index, &ProjectFileIndex::changed, this, [this]() {
+        m_model->setSnapshot(m_index->snapshot());
+        m_listView->setCurrentIndex(m_model->index(0, 0));
+        updateStatus();
+    });
+}
+
+QuickOpenDialog::~QuickOpenDialog()
+{
+}
+
+void QuickOpenDialog::setupUi()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(4, 4, 4, 4);
+    mainLayout->setSpacing(4);
+
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Type part of a file name or path..."));
+    m_filterEdit->installEventFilter(this);
+    mainLayout->addWidget(m_filterEdit);
+
+    m_model = new QuickOpenModel(this);
+
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_listView->setFocusPolicy(Qt::NoFocus);
+    mainLayout->addWidget(m_listView);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: #888;");
+    mainLayout->addWidget(m_statusLabel);
+
+    // Connections
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_model->setFilter(text);
+        m_listView->setCurrentIndex(m_model->index(0, 0));
+        updateStatus();
+    });
+    connect(m_filterEdit, &QLineEdit::returnPressed, this, [this]() {
+        acceptRow(m_listView->currentIndex().row());
+    });
+    connect(m_listView, &QListView::activated, this, [this](const QModelIndex& index) {
+        acceptRow(index.row());
+    });
+}
+
+bool QuickOpenDialog::eventFilter(QObject* watched, QEvent* event)
+{
+    // Keep typing in the filter while the arrow keys move the selection
+    if (watched == m_filterEdit && event->type() == QEvent::KeyPress) {
+        QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+        switch (keyEvent->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QCoreApplication::sendEvent(m_listView, event);
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
+
+void QuickOpenDialog::updateStatus()
+{
+    if (!m_index->isReady()) {
+        m_statusLabel->setText(tr("Indexing project files..."));
+    } else if (m_filterEdit->text().isEmpty()) {
+        m_statusLabel->setText(tr("%n file(s) in project", "", m_model->fileCount()));
+    } else if (m_model->matchCount() > m_model->rowCount()) {
+        m_statusLabel->setText(tr("Best %1 of %n matching file(s)", "", m_model->matchCount()).arg(m_model->rowCount()));
+    } else {
+        m_statusLabel->setText(tr("%n matching file(s)", "", m_model->matchCount()));
+    }
+}
+
+void QuickOpenDialog::acceptRow(int row)
+{
+    QString path = m_model->filePath(row);
+    if (path.isEmpty()) {
+        return;
+    }
+    m_selectedFile = path;
+    accept();
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,48 @@
+#ifndef QUICKOPENDIALOG_H
+#define QUICKOPENDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+
+namespace XXMLStudio {
+
+class ProjectFileIndex;
+class QuickOpenModel;
+
+/**
+ * Go to File palette: type part of a file's name or path, pick from the
+ * ranked matches.
+ */
+class QuickOpenDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit QuickOpenDialog(ProjectFileIndex* index, QWidget* parent = nullptr);
+    ~QuickOpenDialog();
+
+    QString selectedFile() const { return m_selectedFile; }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void setupUi();
+    void updateStatus();
+    void acceptRow(int row);
+
+    ProjectFileIndex* m_index = nullptr;
+    QuickOpenModel* m_model = nullptr;
+
+    QLineEdit* m_filterEdit = nullptr;
+    QListView* m_listView = nullptr;
+    QLabel* m_statusLabel = nullptr;
+
+    QString m_selectedFile;
+};
+
+} // namespace XXMLStudio
+
+#endif // QUICKOPENDIALOG_H
@@ -0,0 +1,132 @@
+#include "QuickOpenModel.h"
+
+#include <QDir>
+#include <algorithm>
+#include <numeric>
+
+namespace XXMLStudio {
+
+QuickOpenModel::QuickOpenModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void QuickOpenModel::setSnapshot(std::shared_ptr<const ProjectFileIndex::Snapshot> snapshot)
+{
+    m_snapshot = std::move(snapshot);
+    m_matches.resize(fileCount());
+    std::iota(m_matches.begin(), m_matches.end(), 0);
+    applyFilter();
+}
+
+void QuickOpenModel::setFilter(const QString& filter)
+{
+    QString previous = m_matcher.pattern();
+    if (filter == previous) {
+        return;
+    }
+
+    // A longer filter only matches a subset of what the shorter one did
+    if (!filter.startsWith(previous, Qt::CaseInsensitive)) {
+        m_matches.resize(fileCount());
+        std::iota(m_matches.begin(), m_matches.end(), 0);
+    }
+    m_matcher.setPattern(filter);
+    applyFilter();
+}
+
+void QuickOpenModel::applyFilter()
+{
+    struct Scored {
+        int score;
+        int file;
+    };
+    QVector<Scored> scored;
+
+    if (m_snapshot && m_matcher.pattern().isEmpty()) {
+        // Nothing typed: the first files in path order
+        for (int i = 0; i < qMin<qsizetype>(m_matches.size(), MAX_ROWS); ++i) {
+            scored.append({0, m_matches[i]});
+        }
+    } else if (m_snapshot) {
+        const quint64 patternMask = FuzzyMatcher::charMask(m_matcher.pattern());
+        scored.reserve(m_matches.size());
+        int kept = 0;
+        for (int file : std::as_const(m_matches)) {
+            const ProjectFileIndex::Snapshot::File& entry = m_snapshot->files[file];
+            if ((entry.pathMask & patternMask) != patternMask) {
+                continue;
+            }
+
+            int score = m_matcher.score(m_snapshot->names[entry.name], m_snapshot->nameMasks[entry.name]);
+            if (score != FuzzyMatcher::NO_MATCH) {
+                score += NAME_MATCH_TIER;
+            } else {
+                const QString& dir = m_snapshot->directories[entry.directory];
+                m_pathBuffer.resize(0);
+                if (!dir.isEmpty()) {
+                    m_pathBuffer.append(dir);
+                    m_pathBuffer.append(QLatin1Char('/'));
+                }
+                m_pathBuffer.append(m_snapshot->names[entry.name]);
+                score = m_matcher.score(m_pathBuffer, entry.pathMask);
+            }
+            if (score != FuzzyMatcher::NO_MATCH) {
+                scored.append({score, file});
+                m_matches[kept++] = file;
+            }
+        }
+        m_matches.resize(kept);
+
+        // Only the rows that can be shown need to be in order; files are
+        // numbered in path order, which settles ties
+        auto last = scored.begin() + qMin<qsizetype>(scored.size(), MAX_ROWS);
+        std::partial_sort(scored.begin(), last, scored.end(), [](const Scored& a, const Scored& b) {
+            if (a.score != b.score) return a.score > b.score;
+            return a.file < b.file;
+        });
+        scored.resize(last - scored.begin());
+    }
+
+    beginResetModel();
+    m_rows.resize(scored.size());
+    for (int i = 0; i < m_rows.size(); ++i) {
+        m_rows[i] = scored[i].file;
+    }
+    endResetModel();
+}
+
+QString QuickOpenModel::filePath(int row) const
+{
+    if (row >= 0 && row < m_rows.size()) {
+        return m_snapshot->absolutePath(m_rows[row]);
+    }
+    return QString();
+}
+
+int QuickOpenModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant QuickOpenModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const int file = m_rows[index.row()];
+    switch (role) {
+    case Qt::DisplayRole: {
+        QStringView dir = m_snapshot->directory(file);
+        QString name = m_snapshot->fileName(file).toString();
+        return dir.isEmpty() ? name : QString("%1    %2").arg(name, QDir::toNativeSeparators(dir.toString()));
+    }
+    case Qt::ToolTipRole:
+        return QDir::toNativeSeparators(m_snapshot->absolutePath(file));
+    default:
+        return QVariant();
+    }
+}
+
+} // namespace XXMLStudio
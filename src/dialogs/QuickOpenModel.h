@@ -0,0 +1,67 @@
+#ifndef QUICKOPENMODEL_H
+#define QUICKOPENMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <memory>
+#include "../core/FuzzyMatcher.h"
+#include "../project/ProjectFileIndex.h"
+
+namespace XXMLStudio {
+
+/**
+ * List model behind Go to File: the project files matching the typed
+ * text, best match first.
+ *
+ * Files whose name matches rank above files that only match across
+ * their directories, so "codeed" finds CodeEditor.cpp before some
+ * code/editor/ subtree. Each file is rejected by its path's character
+ * mask before any string is touched, and while the filter only grows,
+ * only the previous matches are scored again.
+ */
+class QuickOpenModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit QuickOpenModel(QObject* parent = nullptr);
+
+    void setSnapshot(std::shared_ptr<const ProjectFileIndex::Snapshot> snapshot);
+    int fileCount() const { return m_snapshot ? m_snapshot->fileCount() : 0; }
+
+    void setFilter(const QString& filter);
+    QString filter() const { return m_matcher.pattern(); }
+    // Files matching the filter, beyond the rows shown
+    int matchCount() const { return m_matches.size(); }
+
+    // Absolute path of the file at row, or an empty string
+    QString filePath(int row) const;
+
+    // QAbstractItemModel interface
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    static constexpr int MAX_ROWS = 100;
+
+private:
+    // Narrows m_matches to the files matching the current pattern
+    void applyFilter();
+
+    std::shared_ptr<const ProjectFileIndex::Snapshot> m_snapshot;
+    FuzzyMatcher m_matcher;
+
+    // Every file matching the filter, for narrowing on the next keystroke
+    QVector<int> m_matches;
+    // The best of them in display order
+    QVector<int> m_rows;
+
+    // Reused to join directory and name for matching across both
+    QString m_pathBuffer;
+
+    // Puts any match in the file name ahead of path-only matches
+    static constexpr int NAME_MATCH_TIER = 1 << 20;
+};
+
+} // namespace XXMLStudio
+
+#endif // QUICKOPENMODEL_H
@@ -105,6 +105,19 @@ QWidget* SettingsDialog::createEditorTab()
 
     layout->addWidget(indentGroup);
 
+    // Large files group
+    QGroupBox* largeFileGroup = new QGroupBox(tr("Large Files"), widget);
+    QFormLayout* largeFileLayout = new QFormLayout(largeFileGroup);
+
+    m_largeFileThresholdSpinBox = new QSpinBox(widget);
+    m_largeFileThresholdSpinBox->setRange(1, 4096);
+    m_largeFileThresholdSpinBox->setValue(64);
+    m_largeFileThresholdSpinBox->setSuffix(tr(" MB"));
+    m_largeFileThresholdSpinBox->setToolTip(tr("Files of at least this size open read-only in the large file viewer"));
+    largeFileLayout->addRow(tr("Open read-only from:"), m_largeFileThresholdSpinBox);
+
+    layout->addWidget(largeFileGroup);
+
     layout->addStretch();
     return widget;
 }
@@ -180,6 +193,7 @@ void SettingsDialog::loadSettings()
     m_showLineNumbersCheck->setChecked(m_settings->showLineNumbers());
     m_highlightCurrentLineCheck->setChecked(m_settings->highlightCurrentLine());
     m_wordWrapCheck->setChecked(m_settings->wordWrap());
+    m_largeFileThresholdSpinBox->setValue(m_settings->largeFileThresholdMB());
     m_toolchainPathEdit->setText(m_settings->toolchainPath());
 
     // Appearance
@@ -199,6 +213,7 @@ void SettingsDialog::saveSettings()
     m_settings->setShowLineNumbers(m_showLineNumbersCheck->isChecked());
     m_settings->setHighlightCurrentLine(m_highlightCurrentLineCheck->isChecked());
     m_settings->setWordWrap(m_wordWrapCheck->isChecked());
+    m_settings->setLargeFileThresholdMB(m_largeFileThresholdSpinBox->value());
     m_settings->setToolchainPath(m_toolchainPathEdit->text());
 
     // Appearance
@@ -50,6 +50,7 @@ private:
     QCheckBox* m_showLineNumbersCheck = nullptr;
     QCheckBox* m_highlightCurrentLineCheck = nullptr;
     QCheckBox* m_wordWrapCheck = nullptr;
+    QSpinBox* m_largeFileThresholdSpinBox = nullptr;
 
     // Toolchain settings
     QLineEdit* m_toolchainPathEdit = nullptr;
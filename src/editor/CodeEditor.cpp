@@ -1,14 +1,18 @@
 #include "CodeEditor.h"
 #include "XXMLSyntaxHighlighter.h"
 #include "CompletionWidget.h"
+#include "TextSearch.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QPainter>
 #include <QTextBlock>
 #include <QScrollBar>
 #include <QToolTip>
 #include <QRegularExpression>
 
+#include <algorithm>
+
 namespace XXMLStudio {
 
 CodeEditor::CodeEditor(QWidget* parent)
@@ -36,10 +40,16 @@ void CodeEditor::setupEditor()
     // Create completion timer for delayed triggering
     m_completionTimer = new QTimer(this);
     m_completionTimer->setSingleShot(true);
-    connect(m_completionTimer, &QTimer::timeout, this, [this]() {
-        int line = currentLine() - 1;  // LSP uses 0-based
-        int character = currentColumn() - 1;
-        emit completionRequested(line, character);
+    connect(m_completionTimer, &QTimer::timeout, this, &CodeEditor::requestCompletion);
+    connect(m_completionWidget, &CompletionWidget::refreshRequested, this, [this]() {
+        m_completionTimer->start(COMPLETION_DELAY_MS);
+    });
+
+    m_viewportTimer = new QTimer(this);
+    m_viewportTimer->setSingleShot(true);
+    m_viewportTimer->setInterval(VIEWPORT_DELAY_MS);
+    connect(m_viewportTimer, &QTimer::timeout, this, [this]() {
+        emit viewportChanged(firstVisibleLine(), lastVisibleLine());
     });
 
     // Set editor properties
@@ -69,8 +79,103 @@ void CodeEditor::setupConnections()
 
     // Emit documentChanged when text changes (for LSP sync)
     connect(document(), &QTextDocument::contentsChanged, this, [this]() {
+        // Edits can bring diagnostics into view without scrolling
+        if (!m_diagnosticMarks.isEmpty()) {
+            updateDiagnosticSelections();
+        }
         emit documentChanged();
     });
+    connect(document(), &QTextDocument::contentsChange,
+            this, &CodeEditor::onContentsChange);
+}
+
+void CodeEditor::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_loading) {
+        return;  // Picked up in one go by setLoading(false)
+    }
+
+    // contentsChange may over-report (it includes the trailing paragraph
+    // separator and format-only changes), so clamp to the actual text and
+    // trim the parts that did not change.
+    int docLength = document()->characterCount() - 1;
+    position = qBound(0, position, static_cast<int>(m_syncedText.size()));
+    charsRemoved = qBound(0, charsRemoved, static_cast<int>(m_syncedText.size()) - position);
+    charsAdded = qBound(0, charsAdded, docLength - position);
+
+    QString removed = m_syncedText.mid(position, charsRemoved);
+    QString added = plainTextAt(position, charsAdded);
+
+    int prefix = 0;
+    int maxPrefix = qMin(removed.size(), added.size());
+    while (prefix < maxPrefix && removed[prefix] == added[prefix]) {
+        ++prefix;
+    }
+    int suffix = 0;
+    int maxSuffix = maxPrefix - prefix;
+    while (suffix < maxSuffix
+           && removed[removed.size() - 1 - suffix] == added[added.size() - 1 - suffix]) {
+        ++suffix;
+    }
+
+    if (prefix == removed.size() && prefix == added.size()) {
+        return;  // Formatting only
+    }
+
+    removed = removed.mid(prefix, removed.size() - prefix - suffix);
+    added = added.mid(prefix, added.size() - prefix - suffix);
+    position += prefix;
+
+    m_syncedText.replace(position, removed.size(), added);
+
+    m_completionWidget->documentChanged(position, removed.size(), added);
+
+    if (m_syncedText.size() != docLength) {
+        // Lost track of the document; resynchronize with the full text
+        m_completionWidget->invalidateCache();
+        m_syncedText = toPlainText();
+        LSPTextChange change;
+        change.text = m_syncedText;
+        emit documentEdited(change);
+        return;
+    }
+
+    // The text before the change is untouched, so the start position is
+    // the same in the old and new document
+    QTextBlock block = document()->findBlock(position);
+    LSPPosition start{block.blockNumber(), position - block.position()};
+
+    LSPPosition end = start;
+    int newlines = removed.count(QLatin1Char('\n'));
+    if (newlines > 0) {
+        end.line += newlines;
+        end.character = removed.size() - removed.lastIndexOf(QLatin1Char('\n')) - 1;
+    } else {
+        end.character += removed.size();
+    }
+
+    LSPTextChange change;
+    change.range = LSPRange{start, end};
+    change.text = added;
+    emit documentEdited(change);
+}
+
+QString CodeEditor::plainTextAt(int position, int length) const
+{
+    if (length <= 0) {
+        return QString();
+    }
+
+    QTextCursor cursor(document());
+    cursor.setPosition(position);
+    cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+
+    // Match toPlainText() so the synced copy equals what gets saved
+    QString text = cursor.selectedText();
+    text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+    text.replace(QChar::LineSeparator, QLatin1Char('\n'));
+    text.replace(QChar::Nbsp, QLatin1Char(' '));
+    return text;
 }
 
 int CodeEditor::lineNumberAreaWidth() const
@@ -101,6 +206,9 @@ void CodeEditor::updateLineNumberArea(const QRect& rect, int dy)
 {
     if (dy) {
         m_lineNumberArea->scroll(0, dy);
+        m_highlighter->setVisibleRange(firstVisibleLine(), lastVisibleLine());
+        updateDiagnosticSelections();
+        m_viewportTimer->start();
     } else {
         m_lineNumberArea->update(0, rect.y(), m_lineNumberArea->width(), rect.height());
     }
@@ -117,6 +225,12 @@ void CodeEditor::resizeEvent(QResizeEvent* event)
     QRect cr = contentsRect();
     m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(),
                                         lineNumberAreaWidth(), cr.height()));
+
+    if (event->size().height() != event->oldSize().height()) {
+        m_highlighter->setVisibleRange(firstVisibleLine(), lastVisibleLine());
+        updateDiagnosticSelections();
+        m_viewportTimer->start();
+    }
 }
 
 void CodeEditor::highlightCurrentLine()
@@ -134,36 +248,30 @@ void CodeEditor::highlightCurrentLine()
         extraSelections.append(selection);
     }
 
-    // Bracket matching
-    static const QString openBrackets = "([{";
-    static const QString closeBrackets = ")]}";
-
-    QTextCursor cursor = textCursor();
-    int pos = cursor.position();
-    QChar currentChar = document()->characterAt(pos);
-    QChar prevChar = pos > 0 ? document()->characterAt(pos - 1) : QChar();
-
+    // Bracket matching, against the brackets the highlighter found in
+    // code, so a bracket inside a string or comment never matches
     int bracketPos = -1;
     QChar bracket;
     bool searchForward = true;
 
-    // Check current position or previous position for brackets
-    if (openBrackets.contains(currentChar)) {
-        bracketPos = pos;
-        bracket = currentChar;
-        searchForward = true;
-    } else if (closeBrackets.contains(currentChar)) {
-        bracketPos = pos;
-        bracket = currentChar;
-        searchForward = false;
-    } else if (closeBrackets.contains(prevChar)) {
-        bracketPos = pos - 1;
-        bracket = prevChar;
-        searchForward = false;
-    } else if (openBrackets.contains(prevChar)) {
-        bracketPos = pos - 1;
-        bracket = prevChar;
-        searchForward = true;
+    QTextCursor cursor = textCursor();
+    if (!m_loading && m_highlighter) {
+        QTextBlock block = cursor.block();
+        int column = cursor.positionInBlock();
+        const QVector<XXMLLexer::Bracket>& brackets = m_highlighter->bracketData(block)->brackets;
+        auto it = std::lower_bound(brackets.cbegin(), brackets.cend(), column - 1,
+                                   [](const XXMLLexer::Bracket& b, int position) { return b.position < position; });
+
+        // The bracket after the caret wins over the one before it
+        const XXMLLexer::Bracket* found = nullptr;
+        for (; it != brackets.cend() && it->position <= column; ++it) {
+            found = &*it;
+        }
+        if (found) {
+            bracketPos = block.position() + found->position;
+            bracket = QChar(found->ch);
+            searchForward = XXMLBlockData::isOpenBracket(found->ch);
+        }
     }
 
     if (bracketPos >= 0) {
@@ -188,51 +296,84 @@ void CodeEditor::highlightCurrentLine()
         }
     }
 
-    // Add diagnostic underlines
-    for (const Diagnostic& diag : m_diagnostics) {
-        QTextEdit::ExtraSelection selection;
+    // Diagnostic underlines are cached separately, so moving the caret
+    // only rebuilds the two selections above
+    m_lineSelections = extraSelections;
+    setExtraSelections(m_lineSelections + m_diagnosticSelections);
+}
 
-        QColor underlineColor;
-        switch (diag.severity) {
-            case Diagnostic::Severity::Error:
-                underlineColor = QColor(255, 0, 0);
-                break;
-            case Diagnostic::Severity::Warning:
-                underlineColor = QColor(255, 200, 0);
-                break;
-            case Diagnostic::Severity::Info:
-                underlineColor = QColor(0, 150, 255);
-                break;
-            case Diagnostic::Severity::Hint:
-                underlineColor = QColor(100, 100, 100);
-                break;
-        }
+void CodeEditor::updateDiagnosticSelections()
+{
+    m_diagnosticSelections.clear();
 
-        selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
-        selection.format.setUnderlineColor(underlineColor);
+    if (!m_diagnosticMarks.isEmpty()) {
+        QTextBlock last = document()->findBlockByNumber(lastVisibleLine());
+        int from = firstVisibleBlock().position();
+        int to = last.isValid() ? last.position() + last.length() : document()->characterCount();
 
-        // Position cursor at diagnostic location
-        QTextBlock startBlock = document()->findBlockByLineNumber(diag.startLine - 1);
-        QTextBlock endBlock = document()->findBlockByLineNumber(diag.endLine - 1);
+        for (int i : diagnosticsIn(from, to)) {
+            const DiagnosticMark& mark = m_diagnosticMarks[i];
+            if (!mark.range.hasSelection()) {
+                continue;
+            }
 
-        if (startBlock.isValid() && endBlock.isValid()) {
-            int startPos = startBlock.position() + diag.startColumn - 1;
-            int endPos = endBlock.position() + diag.endColumn - 1;
+            QColor underlineColor;
+            switch (mark.severity) {
+                case Diagnostic::Severity::Error:
+                    underlineColor = QColor(255, 0, 0);
+                    break;
+                case Diagnostic::Severity::Warning:
+                    underlineColor = QColor(255, 200, 0);
+                    break;
+                case Diagnostic::Severity::Info:
+                    underlineColor = QColor(0, 150, 255);
+                    break;
+                case Diagnostic::Severity::Hint:
+                    underlineColor = QColor(100, 100, 100);
+                    break;
+            }
 
-            // Clamp to block bounds
-            startPos = qMax(startPos, startBlock.position());
-            endPos = qMin(endPos, endBlock.position() + endBlock.length() - 1);
+            QTextEdit::ExtraSelection selection;
+            selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+            selection.format.setUnderlineColor(underlineColor);
+            selection.cursor = mark.range;
+            m_diagnosticSelections.append(selection);
+        }
+    }
 
-            if (startPos < endPos) {
-                selection.cursor = QTextCursor(document());
-                selection.cursor.setPosition(startPos);
-                selection.cursor.setPosition(endPos, QTextCursor::KeepAnchor);
-                extraSelections.append(selection);
-            }
+    setExtraSelections(m_lineSelections + m_diagnosticSelections);
+}
+
+QVector<int> CodeEditor::diagnosticsIn(int from, int to) const
+{
+    QVector<int> result;
+
+    // Marks are sorted by start; everything from hi on starts after the range
+    auto startsAfter = std::upper_bound(m_diagnosticMarks.constBegin(), m_diagnosticMarks.constEnd(), to,
+        [](int position, const DiagnosticMark& mark) { return position < mark.range.selectionStart(); });
+    int hi = static_cast<int>(startsAfter - m_diagnosticMarks.constBegin());
+
+    // The furthest end seen so far only grows, so skip every prefix that
+    // ends before the range in one binary search
+    int lo = 0;
+    int count = hi;
+    while (count > 0) {
+        int step = count / 2;
+        int mid = lo + step;
+        if (m_diagnosticMarks[m_diagnosticFurthestEnd[mid]].range.selectionEnd() < from) {
+            lo = mid + 1;
+            count -= step + 1;
+        } else {
+            count = step;
         }
     }
 
-    setExtraSelections(extraSelections);
+    for (int i = lo; i < hi; ++i) {
+        if (m_diagnosticMarks[i].range.selectionEnd() >= from) {
+            result.append(i);
+        }
+    }
+    return result;
 }
 
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent* event)
@@ -251,6 +392,22 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent* event)
 
     int bookmarkAreaWidth = 16;
 
+    // Most severe diagnostic starting on each visible line
+    QHash<int, Diagnostic::Severity> lineSeverities;
+    if (!m_diagnosticMarks.isEmpty()) {
+        QTextBlock last = document()->findBlockByNumber(lastVisibleLine());
+        int to = last.isValid() ? last.position() + last.length() : document()->characterCount();
+        for (int i : diagnosticsIn(block.position(), to)) {
+            const DiagnosticMark& mark = m_diagnosticMarks[i];
+            int line = document()->findBlock(mark.range.selectionStart()).blockNumber();
+            auto it = lineSeverities.find(line);
+            // Severity values are ordered from most to least severe
+            if (it == lineSeverities.end() || mark.severity < *it) {
+                lineSeverities.insert(line, mark.severity);
+            }
+        }
+    }
+
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
             int lineNumber = blockNumber + 1;
@@ -271,17 +428,9 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent* event)
             }
 
             // Check if line has diagnostic
-            bool hasError = false;
-            bool hasWarning = false;
-            for (const Diagnostic& diag : m_diagnostics) {
-                if (diag.startLine == lineNumber) {
-                    if (diag.severity == Diagnostic::Severity::Error) {
-                        hasError = true;
-                    } else if (diag.severity == Diagnostic::Severity::Warning) {
-                        hasWarning = true;
-                    }
-                }
-            }
+            Diagnostic::Severity severity = lineSeverities.value(blockNumber, Diagnostic::Severity::Hint);
+            bool hasError = severity == Diagnostic::Severity::Error;
+            bool hasWarning = severity == Diagnostic::Severity::Warning;
 
             // Highlight current line number (VS 2022 colors)
             if (blockNumber == textCursor().blockNumber()) {
@@ -646,6 +795,76 @@ void CodeEditor::setAutoClosePairs(bool enable)
     m_autoClosePairs = enable;
 }
 
+void CodeEditor::setLoading(bool loading)
+{
+    if (m_loading == loading) return;
+    m_loading = loading;
+
+    setReadOnly(loading);
+    document()->setUndoRedoEnabled(!loading);
+
+    // Highlight once the whole text is in rather than chunk by chunk,
+    // with the long-line guard already decided
+    if (!loading) {
+        detectLongLines();
+    }
+    m_highlighter->setDocument(loading ? nullptr : document());
+
+    if (!loading) {
+        m_syncedText = toPlainText();
+        m_completionWidget->invalidateCache();
+        document()->setModified(false);
+    }
+    highlightCurrentLine();
+
+    if (!loading && m_pendingLine > 0) {
+        int line = m_pendingLine;
+        m_pendingLine = 0;
+        goToPosition(line, m_pendingColumn);
+    }
+}
+
+bool CodeEditor::hasLongLines(const QString& text)
+{
+    qsizetype lineStart = 0;
+    while (lineStart < text.size()) {
+        qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd < 0) {
+            lineEnd = text.size();
+        }
+        if (lineEnd - lineStart > LONG_LINE_CHARS) {
+            return true;
+        }
+        lineStart = lineEnd + 1;
+    }
+    return false;
+}
+
+void CodeEditor::detectLongLines()
+{
+    bool hasLongLine = false;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        if (block.length() > LONG_LINE_CHARS) {
+            hasLongLine = true;
+            break;
+        }
+    }
+    setLongLineGuard(hasLongLine);
+}
+
+void CodeEditor::setLongLineGuard(bool enable)
+{
+    if (m_longLineGuard == enable) return;
+    m_longLineGuard = enable;
+
+    m_highlighter->setMaxHighlightLength(enable ? LONG_LINE_HIGHLIGHT_CHARS : 0);
+
+    // Wrapping at the widget width keeps a huge line from becoming a
+    // multi-million pixel wide layout; the text itself is unchanged
+    setLineWrapMode(enable ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    setWordWrapMode(enable ? QTextOption::WrapAnywhere : QTextOption::WrapAtWordBoundaryOrAnywhere);
+}
+
 void CodeEditor::setSyntaxTheme(SyntaxTheme theme)
 {
     if (m_highlighter) {
@@ -661,8 +880,46 @@ SyntaxTheme CodeEditor::syntaxTheme() const
     return SyntaxTheme::VSCodeDark;
 }
 
+void CodeEditor::setSemanticTokens(const QList<LSPSemanticToken>& tokens)
+{
+    if (m_highlighter) {
+        m_highlighter->setSemanticTokens(tokens);
+    }
+}
+
+void CodeEditor::setSemanticTokens(const QList<LSPSemanticToken>& tokens, int firstLine, int lastLine)
+{
+    if (m_highlighter) {
+        m_highlighter->setSemanticTokens(tokens, firstLine, lastLine);
+    }
+}
+
+void CodeEditor::clearSemanticTokens()
+{
+    if (m_highlighter) {
+        m_highlighter->clearSemanticTokens();
+    }
+}
+
+int CodeEditor::firstVisibleLine() const
+{
+    return firstVisibleBlock().blockNumber();
+}
+
+int CodeEditor::lastVisibleLine() const
+{
+    QTextBlock block = cursorForPosition(QPoint(0, viewport()->height() - 1)).block();
+    return block.isValid() ? block.blockNumber() : blockCount() - 1;
+}
+
 void CodeEditor::goToLine(int line)
 {
+    if (m_loading) {
+        // The line may not have arrived yet
+        m_pendingLine = qMax(1, line);
+        m_pendingColumn = 1;
+        return;
+    }
     if (line < 1) line = 1;
     if (line > blockCount()) line = blockCount();
 
@@ -674,6 +931,11 @@ void CodeEditor::goToLine(int line)
 
 void CodeEditor::goToPosition(int line, int column)
 {
+    if (m_loading) {
+        m_pendingLine = qMax(1, line);
+        m_pendingColumn = column;
+        return;
+    }
     if (line < 1) line = 1;
     if (line > blockCount()) line = blockCount();
 
@@ -695,27 +957,67 @@ void CodeEditor::goToPosition(int line, int column)
 void CodeEditor::setDiagnostics(const QList<Diagnostic>& diagnostics)
 {
     m_diagnostics = diagnostics;
-    highlightCurrentLine();  // Refresh extra selections
+
+    // Anchor each diagnostic to a cursor so it follows later edits
+    m_diagnosticMarks.clear();
+    m_diagnosticMarks.reserve(diagnostics.size());
+    for (int i = 0; i < diagnostics.size(); ++i) {
+        const Diagnostic& diag = diagnostics[i];
+        QTextBlock startBlock = document()->findBlockByNumber(diag.startLine - 1);
+        QTextBlock endBlock = document()->findBlockByNumber(diag.endLine - 1);
+        if (!startBlock.isValid() || !endBlock.isValid()) {
+            continue;
+        }
+
+        // Clamp to block bounds
+        int startPos = qMax(startBlock.position() + diag.startColumn - 1, startBlock.position());
+        int endPos = qMin(endBlock.position() + diag.endColumn - 1, endBlock.position() + endBlock.length() - 1);
+
+        DiagnosticMark mark;
+        mark.range = QTextCursor(document());
+        mark.range.setPosition(qMin(startPos, startBlock.position() + startBlock.length() - 1));
+        mark.range.setPosition(qMax(endPos, mark.range.position()), QTextCursor::KeepAnchor);
+        mark.severity = diag.severity;
+        mark.index = i;
+        m_diagnosticMarks.append(mark);
+    }
+
+    // Edits move the cursors but never reorder them, so the order and the
+    // furthest-end prefix stay valid until the next publish
+    std::stable_sort(m_diagnosticMarks.begin(), m_diagnosticMarks.end(),
+        [](const DiagnosticMark& a, const DiagnosticMark& b) {
+            return a.range.selectionStart() < b.range.selectionStart();
+        });
+    m_diagnosticFurthestEnd.resize(m_diagnosticMarks.size());
+    for (int i = 0; i < m_diagnosticMarks.size(); ++i) {
+        int previous = i > 0 ? m_diagnosticFurthestEnd[i - 1] : i;
+        bool extends = m_diagnosticMarks[i].range.selectionEnd() >= m_diagnosticMarks[previous].range.selectionEnd();
+        m_diagnosticFurthestEnd[i] = extends ? i : previous;
+    }
+
+    updateDiagnosticSelections();
     m_lineNumberArea->update();  // Refresh line number colors
 }
 
 void CodeEditor::clearDiagnostics()
 {
     m_diagnostics.clear();
-    highlightCurrentLine();
+    m_diagnosticMarks.clear();
+    m_diagnosticFurthestEnd.clear();
+    updateDiagnosticSelections();
     m_lineNumberArea->update();
 }
 
 QString CodeEditor::diagnosticAt(int line, int column) const
 {
-    for (const Diagnostic& diag : m_diagnostics) {
-        if (line >= diag.startLine && line <= diag.endLine) {
-            if (line == diag.startLine && column < diag.startColumn) continue;
-            if (line == diag.endLine && column > diag.endColumn) continue;
-            return diag.message;
-        }
+    QTextBlock block = document()->findBlockByNumber(line - 1);
+    if (!block.isValid()) {
+        return QString();
     }
-    return QString();
+
+    int position = block.position() + column - 1;
+    QVector<int> hits = diagnosticsIn(position, position);
+    return hits.isEmpty() ? QString() : m_diagnostics.value(m_diagnosticMarks[hits.first()].index).message;
 }
 
 // Bookmarks
@@ -787,37 +1089,30 @@ bool CodeEditor::findPrevious(const QString& text, bool caseSensitive, bool whol
 int CodeEditor::replaceAll(const QString& searchText, const QString& replaceText,
                            bool caseSensitive, bool wholeWord, bool useRegex)
 {
-    int count = 0;
-    QTextCursor cursor = textCursor();
-    cursor.beginEditBlock();
-
-    // Start from beginning
-    cursor.movePosition(QTextCursor::Start);
-    setTextCursor(cursor);
-
-    QTextDocument::FindFlags flags = buildFindFlags(caseSensitive, wholeWord, false);
-
-    while (true) {
-        bool found;
-        if (useRegex) {
-            QRegularExpression regex(searchText);
-            if (!caseSensitive) {
-                regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-            }
-            found = QPlainTextEdit::find(regex);
-        } else {
-            found = QPlainTextEdit::find(searchText, flags);
-        }
-
-        if (!found) break;
-
-        QTextCursor tc = textCursor();
-        tc.insertText(replaceText);
-        ++count;
+    TextSearch::Options options;
+    options.caseSensitive = caseSensitive;
+    options.wholeWord = wholeWord;
+    options.useRegex = useRegex;
+
+    // Find every match in one pass over a snapshot, then replace them
+    // back to front so the earlier ranges stay valid. The edit block
+    // makes this one undo step and one contentsChange.
+    TextSearch search(searchText, options);
+    const QVector<TextSearch::Range> ranges = search.findAll(toPlainText());
+    if (ranges.isEmpty()) {
+        return 0;
     }
 
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    for (auto it = ranges.crbegin(); it != ranges.crend(); ++it) {
+        cursor.setPosition(it->start);
+        cursor.setPosition(it->start + it->length, QTextCursor::KeepAnchor);
+        cursor.insertText(replaceText);
+    }
     cursor.endEditBlock();
-    return count;
+
+    return ranges.size();
 }
 
 bool CodeEditor::replaceCurrent(const QString& replaceText)
@@ -848,46 +1143,65 @@ void CodeEditor::highlightMatchingBracket()
 
 int CodeEditor::findMatchingBracket(int pos, QChar bracket, bool forward) const
 {
-    static const QString openBrackets = "([{";
-    static const QString closeBrackets = ")]}";
-
-    int direction = forward ? 1 : -1;
-    QChar matchBracket;
-
-    if (openBrackets.contains(bracket)) {
-        matchBracket = closeBrackets[openBrackets.indexOf(bracket)];
-    } else if (closeBrackets.contains(bracket)) {
-        matchBracket = openBrackets[closeBrackets.indexOf(bracket)];
-    } else {
+    int kind = XXMLBlockData::bracketKind(bracket.unicode());
+    if (kind < 0 || !m_highlighter) {
         return -1;
     }
 
-    int depth = 1;
-    int currentPos = pos + direction;
-    int docLength = document()->characterCount();
-
-    while (currentPos >= 0 && currentPos < docLength && depth > 0) {
-        QChar ch = document()->characterAt(currentPos);
-        if (ch == bracket) {
-            depth++;
-        } else if (ch == matchBracket) {
-            depth--;
+    // Each block summarises its brackets, so a block that cannot contain
+    // the match is stepped over without looking at its text
+    QTextBlock block = document()->findBlock(pos);
+    int column = pos - block.position();
+    int depth = 0;
+    bool first = true;
+
+    while (block.isValid()) {
+        // In long-line mode a stray bracket must not scan megabytes of text
+        if (m_longLineGuard && !first
+            && (forward ? block.position() > pos + BRACKET_MATCH_WINDOW
+                        : block.position() + block.length() < pos - BRACKET_MATCH_WINDOW)) {
+            break;
         }
-        if (depth == 0) {
-            return currentPos;
+
+        const XXMLBlockData* data = m_highlighter->bracketData(block);
+        const XXMLBlockData::BracketSummary& summary = data->bracketSummary[kind];
+        if (!first && depth + (forward ? summary.minPrefix : summary.minSuffix) >= 0) {
+            depth += forward ? summary.net : -summary.net;
+        } else {
+            const QVector<XXMLLexer::Bracket>& brackets = data->brackets;
+            int count = brackets.size();
+            for (int i = forward ? 0 : count - 1; i >= 0 && i < count; i += forward ? 1 : -1) {
+                const XXMLLexer::Bracket& b = brackets[i];
+                if (XXMLBlockData::bracketKind(b.ch) != kind) {
+                    continue;
+                }
+                if (first && (forward ? b.position <= column : b.position >= column)) {
+                    continue;
+                }
+                if (m_longLineGuard && qAbs(block.position() + b.position - pos) > BRACKET_MATCH_WINDOW) {
+                    return -1;
+                }
+                // Openers deepen the search forward, closers backward
+                depth += XXMLBlockData::isOpenBracket(b.ch) == forward ? 1 : -1;
+                if (depth < 0) {
+                    return block.position() + b.position;
+                }
+            }
         }
-        currentPos += direction;
+
+        first = false;
+        block = forward ? block.next() : block.previous();
     }
 
     return -1;
 }
 
 // Autocomplete methods
-void CodeEditor::showCompletions(const QList<LSPCompletionItem>& items)
+void CodeEditor::showCompletions(const QList<LSPCompletionItem>& items, bool isIncomplete)
 {
     qDebug() << "CodeEditor::showCompletions called with" << items.size() << "items";
     if (m_completionWidget) {
-        m_completionWidget->showCompletions(items);
+        m_completionWidget->showCompletions(items, isIncomplete);
     } else {
         qDebug() << "CodeEditor: m_completionWidget is null!";
     }
@@ -914,6 +1228,14 @@ void CodeEditor::triggerCompletion()
         m_completionTimer->stop();
     }
 
+    requestCompletion();
+}
+
+void CodeEditor::requestCompletion()
+{
+    // Track the word at the cursor so the response can be cached for it
+    m_completionWidget->beginRequest();
+
     // Request completion at current position
     int line = currentLine() - 1;  // LSP uses 0-based
     int character = currentColumn() - 1;
@@ -934,6 +1256,12 @@ void CodeEditor::scheduleCompletion()
         return;
     }
 
+    // Still extending the word of the last complete list: filter it locally
+    if (m_completionWidget->showCachedCompletions()) {
+        m_completionTimer->stop();
+        return;
+    }
+
     // Schedule completion after a short delay
     if (m_completionTimer) {
         m_completionTimer->start(COMPLETION_DELAY_MS);
@@ -51,6 +51,21 @@ public:
     QString filePath() const { return m_filePath; }
     void setFilePath(const QString& path) { m_filePath = path; }
 
+    // While loading, the editor is read-only and unhighlighted, and its
+    // text is not tracked for incremental sync
+    void setLoading(bool loading);
+    bool isLoading() const { return m_loading; }
+
+    // Long-line guard: for files with pathologically long lines (minified
+    // or generated code), highlighting is capped per line, lines are
+    // soft-wrapped for display and bracket matching looks only nearby.
+    // detectLongLines() turns it on when the current text needs it;
+    // hasLongLines() checks text before it is set, which is cheaper.
+    static bool hasLongLines(const QString& text);
+    void detectLongLines();
+    void setLongLineGuard(bool enable);
+    bool longLineGuard() const { return m_longLineGuard; }
+
     // Line number area
     void lineNumberAreaPaintEvent(QPaintEvent* event);
     int lineNumberAreaWidth() const;
@@ -66,7 +81,17 @@ public:
     void setSyntaxTheme(SyntaxTheme theme);
     SyntaxTheme syntaxTheme() const;
 
-    // Navigation
+    // Semantic highlighting from the language server (0-based lines)
+    void setSemanticTokens(const QList<LSPSemanticToken>& tokens);
+    void setSemanticTokens(const QList<LSPSemanticToken>& tokens, int firstLine, int lastLine);
+    void clearSemanticTokens();
+
+    // Visible block range (0-based)
+    int firstVisibleLine() const;
+    int lastVisibleLine() const;
+
+    // Navigation (1-based). While loading, the position is kept and
+    // applied once the text is complete.
     void goToLine(int line);
     void goToPosition(int line, int column);
 
@@ -93,11 +118,11 @@ public:
     int currentColumn() const;
 
     // Autocomplete
-    void showCompletions(const QList<LSPCompletionItem>& items);
+    void showCompletions(const QList<LSPCompletionItem>& items, bool isIncomplete = false);
     void hideCompletions();
     bool isCompletionVisible() const;
 
-    // Request completion manually (Ctrl+Space)
+    // Request completion from the server, bypassing the cache (Ctrl+Space)
     void triggerCompletion();
 
 signals:
@@ -111,6 +136,12 @@ signals:
     // Document changed signal for LSP sync
     void documentChanged();
 
+    // Ranged edit (in pre-edit coordinates) for incremental LSP sync
+    void documentEdited(const LSPTextChange& change);
+
+    // Visible lines changed after scrolling or resizing (0-based, debounced)
+    void viewportChanged(int firstLine, int lastLine);
+
 protected:
     void resizeEvent(QResizeEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
@@ -124,6 +155,7 @@ private slots:
     void updateLineNumberArea(const QRect& rect, int dy);
     void onModificationChanged(bool changed);
     void onCursorPositionChanged();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
 
 private:
     void setupEditor();
@@ -131,10 +163,18 @@ private:
     void paintDiagnostics(QPainter& painter);
     void paintBookmarks(QPainter& painter);
     QTextDocument::FindFlags buildFindFlags(bool caseSensitive, bool wholeWord, bool backward) const;
+    void updateDiagnosticSelections();
+    QVector<int> diagnosticsIn(int from, int to) const;
     void highlightMatchingBracket();
     int findMatchingBracket(int pos, QChar bracket, bool forward) const;
+    QString plainTextAt(int position, int length) const;
 
     QString m_filePath;
+    bool m_loading = false;
+    // Navigation requested while loading, 0 for none
+    int m_pendingLine = 0;
+    int m_pendingColumn = 0;
+    bool m_longLineGuard = false;
     LineNumberArea* m_lineNumberArea = nullptr;
     XXMLSyntaxHighlighter* m_highlighter = nullptr;
     bool m_showLineNumbers = true;
@@ -143,9 +183,30 @@ private:
     bool m_autoClosePairs = true;
     int m_tabWidth = 4;
 
+    // Copy of the text as of the last contentsChange, used to recover
+    // the pre-edit range of each change for incremental sync
+    QString m_syncedText;
+
     // Diagnostics
     QList<Diagnostic> m_diagnostics;
 
+    // Diagnostics anchored to cursors that follow edits, sorted by start.
+    // m_diagnosticFurthestEnd[i] is the mark among [0, i] that ends last,
+    // which lets diagnosticsIn() find the ones overlapping a range without
+    // a full scan.
+    struct DiagnosticMark {
+        QTextCursor range;
+        Diagnostic::Severity severity = Diagnostic::Severity::Error;
+        int index = 0;  // Into m_diagnostics
+    };
+    QVector<DiagnosticMark> m_diagnosticMarks;
+    QVector<int> m_diagnosticFurthestEnd;
+
+    // Extra selections: cursor line and brackets, rebuilt on every caret
+    // move, and underlines for the visible diagnostics, rebuilt on scroll
+    QList<QTextEdit::ExtraSelection> m_lineSelections;
+    QList<QTextEdit::ExtraSelection> m_diagnosticSelections;
+
     // Bookmarks (1-based line numbers)
     QSet<int> m_bookmarkedLines;
 
@@ -157,9 +218,19 @@ private:
     QTimer* m_completionTimer = nullptr;
     static constexpr int COMPLETION_DELAY_MS = 100;
 
+    // Long-line guard thresholds, in characters
+    static constexpr int LONG_LINE_CHARS = 20000;
+    static constexpr int LONG_LINE_HIGHLIGHT_CHARS = 10000;
+    static constexpr int BRACKET_MATCH_WINDOW = 20000;
+
+    // Debounces viewportChanged while scrolling
+    QTimer* m_viewportTimer = nullptr;
+    static constexpr int VIEWPORT_DELAY_MS = 150;
+
     // Trigger characters for autocomplete
     bool isTriggerCharacter(QChar ch) const;
     void scheduleCompletion();
+    void requestCompletion();
 };
 
 /**
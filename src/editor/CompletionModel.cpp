@@ -0,0 +1,198 @@
+#include "CompletionModel.h"
+
+#include <QFile>
+#include <algorithm>
+#include <numeric>
+
+namespace XXMLStudio {
+
+CompletionModel::CompletionModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void CompletionModel::setItems(const QList<LSPCompletionItem>& items, const QString& filter)
+{
+    m_items = items;
+    m_matcher.setPattern(filter);
+
+    m_masks.resize(m_items.size());
+    for (int i = 0; i < m_items.size(); ++i) {
+        m_masks[i] = FuzzyMatcher::charMask(m_items[i].label);
+    }
+
+    // Equal scores fall back to alphabetical order; ranking once here
+    // keeps string comparisons out of every keystroke
+    QVector<int> order(m_items.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_items[a].label.compare(m_items[b].label, Qt::CaseInsensitive) < 0;
+    });
+    m_alphabeticalRank.resize(m_items.size());
+    for (int i = 0; i < order.size(); ++i) {
+        m_alphabeticalRank[order[i]] = i;
+    }
+
+    m_matches.resize(m_items.size());
+    std::iota(m_matches.begin(), m_matches.end(), 0);
+    applyFilter();
+}
+
+void CompletionModel::clear()
+{
+    beginResetModel();
+    m_items.clear();
+    m_masks.clear();
+    m_alphabeticalRank.clear();
+    m_matches.clear();
+    m_rows.clear();
+    m_matcher.setPattern(QString());
+    endResetModel();
+}
+
+void CompletionModel::setFilter(const QString& filter)
+{
+    QString previous = m_matcher.pattern();
+    if (filter == previous) {
+        return;
+    }
+
+    // A longer filter only matches a subset of what the shorter one did
+    if (!filter.startsWith(previous, Qt::CaseInsensitive)) {
+        m_matches.resize(m_items.size());
+        std::iota(m_matches.begin(), m_matches.end(), 0);
+    }
+    m_matcher.setPattern(filter);
+    applyFilter();
+}
+
+void CompletionModel::applyFilter()
+{
+    struct Scored {
+        int score;
+        int item;
+    };
+    QVector<Scored> scored;
+    scored.reserve(m_matches.size());
+    int kept = 0;
+    for (int item : std::as_const(m_matches)) {
+        int score = m_matcher.score(m_items[item].label, m_masks[item]);
+        if (score != FuzzyMatcher::NO_MATCH) {
+            scored.append({score, item});
+            m_matches[kept++] = item;
+        }
+    }
+    m_matches.resize(kept);
+
+    // Only the rows that can be shown need to be in order
+    auto better = [this](const Scored& a, const Scored& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return m_alphabeticalRank[a.item] < m_alphabeticalRank[b.item];
+    };
+    auto last = scored.begin() + qMin<qsizetype>(scored.size(), MAX_ROWS);
+    std::partial_sort(scored.begin(), last, scored.end(), better);
+
+    beginResetModel();
+    m_rows.resize(last - scored.begin());
+    for (int i = 0; i < m_rows.size(); ++i) {
+        m_rows[i] = scored[i].item;
+    }
+    endResetModel();
+}
+
+LSPCompletionItem CompletionModel::item(int row) const
+{
+    if (row >= 0 && row < m_rows.size()) {
+        return m_items[m_rows[row]];
+    }
+    return LSPCompletionItem{};
+}
+
+int CompletionModel::rowForLabel(const QString& label) const
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_items[m_rows[row]].label == label) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+int CompletionModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant CompletionModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const LSPCompletionItem& item = m_items[m_rows[index.row()]];
+    switch (role) {
+    case Qt::DisplayRole:
+        return item.label;
+    case Qt::DecorationRole:
+        return iconForKind(item.kind);
+    case Qt::ToolTipRole:
+        return item.detail.isEmpty() ? QVariant() : QVariant(item.detail);
+    default:
+        return QVariant();
+    }
+}
+
+QIcon CompletionModel::iconForKind(CompletionItemKind kind) const
+{
+    auto cached = m_iconCache.constFind(static_cast<int>(kind));
+    if (cached != m_iconCache.constEnd()) {
+        return *cached;
+    }
+
+    // Return simple colored icons based on kind
+    // In a full implementation, these would be actual icon files
+    QString iconPath;
+    switch (kind) {
+        case CompletionItemKind::Method:
+        case CompletionItemKind::Function:
+            iconPath = ":/icons/Method.svg";
+            break;
+        case CompletionItemKind::Constructor:
+            iconPath = ":/icons/Constructor.svg";
+            break;
+        case CompletionItemKind::Field:
+        case CompletionItemKind::Property:
+            iconPath = ":/icons/Field.svg";
+            break;
+        case CompletionItemKind::Variable:
+            iconPath = ":/icons/Variable.svg";
+            break;
+        case CompletionItemKind::Class:
+        case CompletionItemKind::Interface:
+        case CompletionItemKind::Struct:
+            iconPath = ":/icons/Class.svg";
+            break;
+        case CompletionItemKind::Module:
+            iconPath = ":/icons/Namespace.svg";
+            break;
+        case CompletionItemKind::Enum:
+            iconPath = ":/icons/Enum.svg";
+            break;
+        case CompletionItemKind::Keyword:
+            iconPath = ":/icons/Keyword.svg";
+            break;
+        case CompletionItemKind::Snippet:
+            iconPath = ":/icons/Snippet.svg";
+            break;
+        default:
+            iconPath = ":/icons/Property.svg";
+            break;
+    }
+
+    // Empty icon if the file doesn't exist
+    QIcon icon = QFile::exists(iconPath) ? QIcon(iconPath) : QIcon();
+    m_iconCache.insert(static_cast<int>(kind), icon);
+    return icon;
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,72 @@
+#ifndef COMPLETIONMODEL_H
+#define COMPLETIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QIcon>
+#include <QVector>
+#include "../core/FuzzyMatcher.h"
+#include "../lsp/LSPProtocol.h"
+
+namespace XXMLStudio {
+
+/**
+ * List model behind the completion popup.
+ *
+ * Holds the completion items from the server and exposes the ones
+ * matching the typed word, best match first. Rows are plain indices into
+ * the item list, so the view only ever asks for the few it paints.
+ *
+ * Each item's character mask and alphabetical rank are computed once
+ * when the list arrives; filtering then costs one mask test per item
+ * plus a fuzzy match for the survivors. While the filter only grows,
+ * items that failed the previous filter are not looked at again.
+ */
+class CompletionModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit CompletionModel(QObject* parent = nullptr);
+
+    void setItems(const QList<LSPCompletionItem>& items, const QString& filter);
+    void clear();
+
+    void setFilter(const QString& filter);
+    QString filter() const { return m_matcher.pattern(); }
+
+    // Item shown at row, or an empty item if row is out of range
+    LSPCompletionItem item(int row) const;
+
+    // Row showing the item with this label, or -1
+    int rowForLabel(const QString& label) const;
+
+    // QAbstractItemModel interface
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    // Narrows m_matches to the items matching the current pattern
+    void applyFilter();
+    QIcon iconForKind(CompletionItemKind kind) const;
+
+    QList<LSPCompletionItem> m_items;
+    QVector<quint64> m_masks;
+    QVector<int> m_alphabeticalRank;
+
+    FuzzyMatcher m_matcher;
+
+    // Every item matching the filter, for narrowing on the next keystroke
+    QVector<int> m_matches;
+    // The best of them in display order
+    QVector<int> m_rows;
+
+    mutable QHash<int, QIcon> m_iconCache;
+
+    // More suggestions than this are never worth scrolling through
+    static constexpr int MAX_ROWS = 1000;
+};
+
+} // namespace XXMLStudio
+
+#endif // COMPLETIONMODEL_H
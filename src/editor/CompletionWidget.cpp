@@ -10,6 +10,8 @@
 #include <QStandardPaths>
 #include <QDateTime>
 #include <QTextStream>
+#include <QTextBlock>
+#include <algorithm>
 
 // Debug logging to file
 static void logToFile(const QString& message) {
@@ -44,7 +46,7 @@ CompletionWidget::CompletionWidget(CodeEditor* editor)
             border: 1px solid #3e3e42;
             border-radius: 4px;
         }
-        QListWidget {
+        QListView {
             background-color: #252526;
             color: #e0e0e0;
             border: none;
@@ -52,16 +54,16 @@ CompletionWidget::CompletionWidget(CodeEditor* editor)
             font-family: "Consolas", "Courier New", monospace;
             font-size: 9pt;
         }
-        QListWidget::item {
+        QListView::item {
             padding: 1px 4px;
             border: none;
             height: 16px;
         }
-        QListWidget::item:selected {
+        QListView::item:selected {
             background-color: #094771;
             color: #ffffff;
         }
-        QListWidget::item:hover:!selected {
+        QListView::item:hover:!selected {
             background-color: #2a2d2e;
         }
         QScrollBar:vertical {
@@ -84,20 +86,25 @@ CompletionWidget::CompletionWidget(CodeEditor* editor)
     m_layout->setContentsMargins(2, 2, 2, 2);
     m_layout->setSpacing(0);
 
-    // Create list widget
-    m_listWidget = new QListWidget(this);
-    m_listWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_listWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    m_listWidget->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
-    m_listWidget->setUniformItemSizes(true);
-    m_listWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    m_listWidget->setFocusPolicy(Qt::NoFocus);
-    m_listWidget->setIconSize(QSize(16, 16));  // Small icons
-    m_layout->addWidget(m_listWidget);
+    // Create list view; uniform item sizes let it lay out only the rows
+    // on screen however many the model has
+    m_model = new CompletionModel(this);
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_listView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_listView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_listView->setFocusPolicy(Qt::NoFocus);
+    m_listView->setIconSize(QSize(16, 16));  // Small icons
+    m_layout->addWidget(m_listView);
 
     // Connect signals
-    connect(m_listWidget, &QListWidget::itemDoubleClicked,
-            this, &CompletionWidget::onItemDoubleClicked);
+    connect(m_listView, &QListView::doubleClicked, this, [this]() {
+        applyCompletion();
+    });
 
     // Install event filter on editor to catch key events
     m_editor->installEventFilter(this);
@@ -110,11 +117,100 @@ CompletionWidget::~CompletionWidget()
 {
 }
 
-void CompletionWidget::showCompletions(const QList<LSPCompletionItem>& items)
+static bool isIdentifierChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_';
+}
+
+void CompletionWidget::beginRequest()
+{
+    int position = m_editor->textCursor().position();
+    m_cache = Cache();
+    m_cache.valid = true;
+    m_cache.wordStart = wordStartAt(position);
+    m_cache.requestEnd = position;
+    m_cache.wordEnd = position;
+}
+
+void CompletionWidget::showCompletions(const QList<LSPCompletionItem>& items, bool isIncomplete)
 {
     logToFile(QString("showCompletions called with %1 items").arg(items.size()));
     qDebug() << "CompletionWidget::showCompletions called with" << items.size() << "items";
 
+    if (!m_cache.valid) {
+        // The user edited elsewhere since the request
+        logToFile("edits left the requested word, dropping items");
+        return;
+    }
+
+    m_cache.received = true;
+    m_cache.isIncomplete = isIncomplete;
+    m_cache.items = items;
+
+    // Keep the list for later if the cursor has moved away in the meantime
+    QTextCursor cursor = m_editor->textCursor();
+    if (cursor.hasSelection() || cursor.position() != m_cache.wordEnd) {
+        return;
+    }
+
+    display(items);
+}
+
+bool CompletionWidget::showCachedCompletions()
+{
+    if (!m_cache.valid || !m_cache.received || m_cache.isIncomplete) {
+        return false;
+    }
+
+    QTextCursor cursor = m_editor->textCursor();
+    if (cursor.hasSelection() || cursor.position() != m_cache.wordEnd
+        || wordStartAt(cursor.position()) != m_cache.wordStart) {
+        return false;
+    }
+
+    // A complete list with nothing matching stays empty as the word grows
+    display(m_cache.items);
+    return true;
+}
+
+void CompletionWidget::documentChanged(int position, int charsRemoved, const QString& added)
+{
+    if (!m_cache.valid) {
+        return;
+    }
+
+    // Only typing after the requested prefix keeps the list valid
+    bool extendsWord = position >= m_cache.requestEnd && position + charsRemoved <= m_cache.wordEnd;
+    bool identifier = std::all_of(added.begin(), added.end(), isIdentifierChar);
+    if (!extendsWord || !identifier) {
+        invalidateCache();
+        return;
+    }
+
+    m_cache.wordEnd += added.size() - charsRemoved;
+    if (m_cache.wordEnd < m_cache.requestEnd) {
+        invalidateCache();
+    }
+}
+
+void CompletionWidget::invalidateCache()
+{
+    m_cache = Cache();
+}
+
+int CompletionWidget::wordStartAt(int position) const
+{
+    QTextBlock block = m_editor->document()->findBlock(position);
+    QString text = block.text();
+    int column = position - block.position();
+    while (column > 0 && isIdentifierChar(text[column - 1])) {
+        --column;
+    }
+    return block.position() + column;
+}
+
+void CompletionWidget::display(const QList<LSPCompletionItem>& items)
+{
     if (items.isEmpty()) {
         logToFile("items empty, hiding");
         qDebug() << "CompletionWidget: items empty, hiding";
@@ -122,45 +218,36 @@ void CompletionWidget::showCompletions(const QList<LSPCompletionItem>& items)
         return;
     }
 
-    m_allItems = items;
-    m_filterPrefix.clear();
-
-    // Store trigger position
+    // Filter by the part of the word typed so far
     QTextCursor cursor = m_editor->textCursor();
-    m_triggerPosition = cursor.position();
-
-    // Get the word prefix at cursor for initial filtering
-    cursor.movePosition(QTextCursor::StartOfWord, QTextCursor::KeepAnchor);
+    m_triggerPosition = wordStartAt(cursor.position());
+    cursor.setPosition(m_triggerPosition, QTextCursor::KeepAnchor);
     m_triggerPrefix = cursor.selectedText();
     m_filterPrefix = m_triggerPrefix;
-
-    // Adjust trigger position to start of word
-    m_triggerPosition = cursor.position();
     logToFile(QString("triggerPrefix='%1', triggerPosition=%2").arg(m_triggerPrefix).arg(m_triggerPosition));
 
-    populateList();
+    m_model->setItems(items, m_filterPrefix);
     updatePosition();
 
-    if (m_filteredItems.isEmpty()) {
+    if (m_model->rowCount() == 0) {
         logToFile("filteredItems empty after filtering, hiding");
         hide();
         return;
     }
 
     logToFile(QString("Showing popup with %1 filtered items at pos (%2, %3), size (%4x%5)")
-              .arg(m_filteredItems.size())
+              .arg(m_model->rowCount())
               .arg(pos().x()).arg(pos().y())
               .arg(width()).arg(height()));
     QFrame::show();
-    m_listWidget->setCurrentRow(0);
+    setCurrentRow(0);
     logToFile(QString("After show() - isVisible: %1").arg(QFrame::isVisible()));
 }
 
 void CompletionWidget::hide()
 {
     QFrame::hide();
-    m_allItems.clear();
-    m_filteredItems.clear();
+    m_model->clear();
     m_filterPrefix.clear();
     emit dismissed();
 }
@@ -177,75 +264,70 @@ void CompletionWidget::setFilterPrefix(const QString& prefix)
     }
 
     m_filterPrefix = prefix;
-    int previousRow = m_listWidget->currentRow();
-    QString previousLabel;
-    if (previousRow >= 0 && previousRow < m_filteredItems.size()) {
-        previousLabel = m_filteredItems[previousRow].label;
-    }
+    QString previousLabel = m_model->item(currentRow()).label;
 
-    populateList();
+    m_model->setFilter(prefix);
+    updatePosition();
 
-    if (m_filteredItems.isEmpty()) {
+    if (m_model->rowCount() == 0) {
         hide();
         return;
     }
 
     // Try to keep the same item selected
-    int newRow = 0;
-    if (!previousLabel.isEmpty()) {
-        for (int i = 0; i < m_filteredItems.size(); ++i) {
-            if (m_filteredItems[i].label == previousLabel) {
-                newRow = i;
-                break;
-            }
-        }
-    }
+    int newRow = previousLabel.isEmpty() ? -1 : m_model->rowForLabel(previousLabel);
+    setCurrentRow(qMax(0, newRow));
+}
+
+int CompletionWidget::currentRow() const
+{
+    QModelIndex index = m_listView->currentIndex();
+    return index.isValid() ? index.row() : -1;
+}
 
-    m_listWidget->setCurrentRow(newRow);
+void CompletionWidget::setCurrentRow(int row)
+{
+    m_listView->setCurrentIndex(m_model->index(row));
 }
 
 void CompletionWidget::selectNext()
 {
-    int currentRow = m_listWidget->currentRow();
-    if (currentRow < m_listWidget->count() - 1) {
-        m_listWidget->setCurrentRow(currentRow + 1);
+    int row = currentRow();
+    if (row < m_model->rowCount() - 1) {
+        setCurrentRow(row + 1);
     }
 }
 
 void CompletionWidget::selectPrevious()
 {
-    int currentRow = m_listWidget->currentRow();
-    if (currentRow > 0) {
-        m_listWidget->setCurrentRow(currentRow - 1);
+    int row = currentRow();
+    if (row > 0) {
+        setCurrentRow(row - 1);
     }
 }
 
 void CompletionWidget::selectFirst()
 {
-    if (m_listWidget->count() > 0) {
-        m_listWidget->setCurrentRow(0);
+    if (m_model->rowCount() > 0) {
+        setCurrentRow(0);
     }
 }
 
 void CompletionWidget::selectLast()
 {
-    if (m_listWidget->count() > 0) {
-        m_listWidget->setCurrentRow(m_listWidget->count() - 1);
+    if (m_model->rowCount() > 0) {
+        setCurrentRow(m_model->rowCount() - 1);
     }
 }
 
 LSPCompletionItem CompletionWidget::selectedItem() const
 {
-    int row = m_listWidget->currentRow();
-    if (row >= 0 && row < m_filteredItems.size()) {
-        return m_filteredItems[row];
-    }
-    return LSPCompletionItem{};
+    return m_model->item(currentRow());
 }
 
 bool CompletionWidget::hasSelection() const
 {
-    return m_listWidget->currentRow() >= 0;
+    return currentRow() >= 0;
 }
 
 void CompletionWidget::applyCompletion()
@@ -273,12 +355,6 @@ void CompletionWidget::applyCompletion()
     hide();
 }
 
-void CompletionWidget::onItemDoubleClicked(QListWidgetItem* item)
-{
-    Q_UNUSED(item)
-    applyCompletion();
-}
-
 bool CompletionWidget::eventFilter(QObject* obj, QEvent* event)
 {
     if (obj == m_editor && isVisible()) {
@@ -367,12 +443,18 @@ bool CompletionWidget::eventFilter(QObject* obj, QEvent* event)
 
                 // If prefix contains space or other non-identifier chars, dismiss
                 for (const QChar& c : newPrefix) {
-                    if (!c.isLetterOrNumber() && c != '_') {
+                    if (!isIdentifierChar(c)) {
                         hide();
                         return;
                     }
                 }
 
+                // An incomplete list has to be recomputed by the server;
+                // keep filtering the old one until the new one arrives
+                if (m_cache.isIncomplete && newPrefix != m_filterPrefix) {
+                    emit refreshRequested();
+                }
+
                 setFilterPrefix(newPrefix);
             });
         }
@@ -398,7 +480,7 @@ void CompletionWidget::updatePosition()
     QPoint globalPos = m_editor->mapToGlobal(cursorRect.bottomLeft());
 
     // Calculate widget size
-    int visibleItems = qMin(m_filteredItems.size(), MAX_VISIBLE_ITEMS);
+    int visibleItems = qMin(m_model->rowCount(), MAX_VISIBLE_ITEMS);
     int height = visibleItems * ITEM_HEIGHT + 6;  // 6 for border/padding
     int width = 280;
 
@@ -425,90 +507,4 @@ void CompletionWidget::updatePosition()
     move(globalPos);
 }
 
-void CompletionWidget::populateList()
-{
-    m_listWidget->clear();
-    m_filteredItems.clear();
-
-    // Filter items by prefix
-    QString lowerPrefix = m_filterPrefix.toLower();
-    for (const LSPCompletionItem& item : m_allItems) {
-        if (lowerPrefix.isEmpty() || item.label.toLower().startsWith(lowerPrefix)) {
-            m_filteredItems.append(item);
-        }
-    }
-
-    // Sort: exact prefix matches first, then alphabetically
-    std::sort(m_filteredItems.begin(), m_filteredItems.end(),
-        [&lowerPrefix](const LSPCompletionItem& a, const LSPCompletionItem& b) {
-            bool aExact = a.label.toLower().startsWith(lowerPrefix);
-            bool bExact = b.label.toLower().startsWith(lowerPrefix);
-            if (aExact != bExact) return aExact;
-            return a.label.toLower() < b.label.toLower();
-        });
-
-    // Populate list widget
-    for (const LSPCompletionItem& item : m_filteredItems) {
-        QListWidgetItem* listItem = new QListWidgetItem(m_listWidget);
-        listItem->setText(item.label);
-        listItem->setIcon(iconForKind(item.kind));
-        if (!item.detail.isEmpty()) {
-            listItem->setToolTip(item.detail);
-        }
-    }
-
-    // Update size
-    updatePosition();
-}
-
-QIcon CompletionWidget::iconForKind(CompletionItemKind kind) const
-{
-    // Return simple colored icons based on kind
-    // In a full implementation, these would be actual icon files
-    QString iconPath;
-    switch (kind) {
-        case CompletionItemKind::Method:
-        case CompletionItemKind::Function:
-            iconPath = ":/icons/Method.svg";
-            break;
-        case CompletionItemKind::Constructor:
-            iconPath = ":/icons/Constructor.svg";
-            break;
-        case CompletionItemKind::Field:
-        case CompletionItemKind::Property:
-            iconPath = ":/icons/Field.svg";
-            break;
-        case CompletionItemKind::Variable:
-            iconPath = ":/icons/Variable.svg";
-            break;
-        case CompletionItemKind::Class:
-        case CompletionItemKind::Interface:
-        case CompletionItemKind::Struct:
-            iconPath = ":/icons/Class.svg";
-            break;
-        case CompletionItemKind::Module:
-            iconPath = ":/icons/Namespace.svg";
-            break;
-        case CompletionItemKind::Enum:
-            iconPath = ":/icons/Enum.svg";
-            break;
-        case CompletionItemKind::Keyword:
-            iconPath = ":/icons/Keyword.svg";
-            break;
-        case CompletionItemKind::Snippet:
-            iconPath = ":/icons/Snippet.svg";
-            break;
-        default:
-            iconPath = ":/icons/Property.svg";
-            break;
-    }
-
-    if (QFile::exists(iconPath)) {
-        return QIcon(iconPath);
-    }
-
-    // Return empty icon if file doesn't exist
-    return QIcon();
-}
-
 } // namespace XXMLStudio
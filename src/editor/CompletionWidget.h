@@ -1,10 +1,11 @@
 #ifndef COMPLETIONWIDGET_H
 #define COMPLETIONWIDGET_H
 
-#include <QListWidget>
+#include <QListView>
 #include <QFrame>
 #include <QVBoxLayout>
 #include <QTimer>
+#include "CompletionModel.h"
 #include "../lsp/LSPProtocol.h"
 
 namespace XXMLStudio {
@@ -13,7 +14,14 @@ class CodeEditor;
 
 /**
  * Popup widget for displaying autocomplete suggestions.
- * Shows completion items from the LSP server in a filterable list.
+ * Shows completion items from the LSP server in a filterable list,
+ * fuzzy matched against the typed word by CompletionModel.
+ *
+ * The last list received is cached together with the word it was
+ * requested for. While edits only extend that word the cached list is
+ * filtered locally instead of asking the server again, unless the server
+ * marked it incomplete. A complete list only covers further typing, so
+ * deleting into the requested prefix drops it.
  */
 class CompletionWidget : public QFrame
 {
@@ -23,12 +31,25 @@ public:
     explicit CompletionWidget(CodeEditor* editor);
     ~CompletionWidget();
 
-    // Show completions at current cursor position
-    void showCompletions(const QList<LSPCompletionItem>& items);
+    // Completions for the last request; shown if the cursor is still at
+    // the end of the word they were requested for
+    void showCompletions(const QList<LSPCompletionItem>& items, bool isIncomplete = false);
     void hide();
+
+    // Start tracking the word at the cursor for a new completion request
+    void beginRequest();
+
+    // Show the cached list for the word at the cursor. Returns false if
+    // there is no usable cache and the server has to be asked.
+    bool showCachedCompletions();
+
+    // Called for every document edit; keeps the cache only while the
+    // edits stay inside the tracked word
+    void documentChanged(int position, int charsRemoved, const QString& added);
+    void invalidateCache();
     bool isVisible() const;
 
-    // Filter completions by prefix
+    // Filter completions by the typed word
     void setFilterPrefix(const QString& prefix);
 
     // Navigation
@@ -48,30 +69,43 @@ signals:
     void completionApplied(const QString& text);
     void dismissed();
 
+    // The visible list is incomplete and the typed prefix changed
+    void refreshRequested();
+
 protected:
     bool eventFilter(QObject* obj, QEvent* event) override;
     void focusOutEvent(QFocusEvent* event) override;
 
-private slots:
-    void onItemDoubleClicked(QListWidgetItem* item);
-
 private:
+    void display(const QList<LSPCompletionItem>& items);
+    int wordStartAt(int position) const;
     void updatePosition();
-    void populateList();
-    QIcon iconForKind(CompletionItemKind kind) const;
+    int currentRow() const;
+    void setCurrentRow(int row);
 
     CodeEditor* m_editor;
-    QListWidget* m_listWidget;
+    QListView* m_listView;
+    CompletionModel* m_model;
     QVBoxLayout* m_layout;
 
-    QList<LSPCompletionItem> m_allItems;
-    QList<LSPCompletionItem> m_filteredItems;
     QString m_filterPrefix;
 
     // Position where completion was triggered
     int m_triggerPosition = 0;
     QString m_triggerPrefix;
 
+    // Last requested word and the list the server returned for it
+    struct Cache {
+        bool valid = false;         // Edits since the request stayed inside the word
+        bool received = false;
+        bool isIncomplete = false;
+        int wordStart = 0;
+        int requestEnd = 0;         // Cursor position the list was requested at
+        int wordEnd = 0;            // Tracks the word as it is typed
+        QList<LSPCompletionItem> items;
+    };
+    Cache m_cache;
+
     static constexpr int MAX_VISIBLE_ITEMS = 8;
     static constexpr int ITEM_HEIGHT = 18;
 };
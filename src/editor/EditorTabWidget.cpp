@@ -1,5 +1,7 @@
 #include "EditorTabWidget.h"
 #include "CodeEditor.h"
+#include "FileLoader.h"
+#include "LargeFileViewer.h"
 #include "core/Application.h"
 #include "core/Settings.h"
 
@@ -42,6 +44,21 @@ CodeEditor* EditorTabWidget::openFile(const QString& path)
         setCurrentWidget(editor);
         return editor;
     }
+    if (m_fileViewers.contains(path)) {
+        setCurrentWidget(m_fileViewers[path]);
+        return nullptr;
+    }
+
+    qint64 size = QFileInfo(path).size();
+    Settings* settings = Application::instance()->settings();
+    if (size >= qint64(settings->largeFileThresholdMB()) * 1024 * 1024) {
+        openLargeFile(path);
+        return nullptr;
+    }
+
+    if (size >= ASYNC_LOAD_MIN_BYTES) {
+        return openFileAsync(path);
+    }
 
     // Read file content
     QFile file(path);
@@ -57,11 +74,11 @@ CodeEditor* EditorTabWidget::openFile(const QString& path)
 
     // Create editor
     CodeEditor* editor = new CodeEditor(this);
+    editor->setLongLineGuard(CodeEditor::hasLongLines(content));
     editor->setPlainText(content);
     editor->setFilePath(path);
 
     // Apply current syntax theme from settings
-    Settings* settings = Application::instance()->settings();
     editor->setSyntaxTheme(static_cast<SyntaxTheme>(settings->syntaxTheme()));
 
     // Connect signals
@@ -81,6 +98,109 @@ CodeEditor* EditorTabWidget::openFile(const QString& path)
     return editor;
 }
 
+CodeEditor* EditorTabWidget::openFileAsync(const QString& path)
+{
+    // Fail up front, like the synchronous path, if the file cannot be read
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, tr("Error"),
+            tr("Cannot open file %1:\n%2").arg(path, file.errorString()));
+        return nullptr;
+    }
+    file.close();
+
+    CodeEditor* editor = new CodeEditor(this);
+    editor->setFilePath(path);
+    editor->setLoading(true);
+
+    Settings* settings = Application::instance()->settings();
+    editor->setSyntaxTheme(static_cast<SyntaxTheme>(settings->syntaxTheme()));
+
+    connect(editor, &CodeEditor::modificationChanged,
+            this, &EditorTabWidget::onEditorModificationChanged);
+    connect(editor, &CodeEditor::cursorPositionChanged,
+            this, &EditorTabWidget::onEditorCursorPositionChanged);
+
+    FileLoader* loader = new FileLoader(editor->document(), editor);
+    m_loaders[editor] = loader;
+
+    connect(loader, &FileLoader::progressChanged, this, [this, editor]() {
+        updateTabTitle(indexOf(editor));
+    });
+
+    // fileOpened (and with it didOpen) waits until the text is complete
+    connect(loader, &FileLoader::finished, this, [this, editor, loader]() {
+        m_loaders.remove(editor);
+        loader->deleteLater();
+        editor->setLoading(false);
+        updateTabTitle(indexOf(editor));
+        emit fileOpened(editor->filePath());
+
+        // Listeners skipped the editor while it was loading
+        if (editor == currentEditor()) {
+            emit currentEditorChanged(editor);
+        }
+    });
+
+    connect(loader, &FileLoader::failed, this, [this, editor, path](const QString& errorString) {
+        discardEditor(editor);
+        QMessageBox::warning(this, tr("Error"),
+            tr("Cannot open file %1:\n%2").arg(path, errorString));
+    });
+
+    int index = addTab(editor, QFileInfo(path).fileName());
+    setCurrentIndex(index);
+    m_fileEditors[path] = editor;
+    updateTabTitle(index);
+
+    loader->start(path);
+    return editor;
+}
+
+void EditorTabWidget::openLargeFile(const QString& path)
+{
+    LargeFileViewer* viewer = new LargeFileViewer(this);
+    if (!viewer->openFile(path)) {
+        QMessageBox::warning(this, tr("Error"),
+            tr("Cannot open file %1:\n%2").arg(path, viewer->errorString()));
+        delete viewer;
+        return;
+    }
+
+    Settings* settings = Application::instance()->settings();
+    viewer->setFont(settings->editorFont());
+    viewer->setTabWidth(settings->tabWidth());
+
+    connect(viewer, &LargeFileViewer::indexProgressChanged, this, [this, viewer]() {
+        updateTabTitle(indexOf(viewer));
+    });
+    connect(viewer, &LargeFileViewer::cursorPositionChanged, this, [this, viewer](int line, int column) {
+        if (viewer == currentWidget()) {
+            emit cursorPositionChanged(line, column);
+        }
+    });
+
+    int index = addTab(viewer, QFileInfo(path).fileName());
+    setTabToolTip(index, tr("%1 (read-only)").arg(path));
+    setCurrentIndex(index);
+    m_fileViewers[path] = viewer;
+    updateTabTitle(index);
+}
+
+void EditorTabWidget::discardEditor(CodeEditor* editor)
+{
+    if (FileLoader* loader = m_loaders.take(editor)) {
+        loader->cancel();
+    }
+    m_fileEditors.remove(editor->filePath());
+
+    int index = indexOf(editor);
+    if (index >= 0) {
+        removeTab(index);
+    }
+    editor->deleteLater();
+}
+
 CodeEditor* EditorTabWidget::newFile()
 {
     CodeEditor* editor = new CodeEditor(this);
@@ -110,6 +230,9 @@ bool EditorTabWidget::saveFile(int index)
     CodeEditor* editor = editorAt(index);
     if (!editor) return false;
 
+    // Saving now would truncate the file to what has been loaded so far
+    if (editor->isLoading()) return false;
+
     QString path = editor->filePath();
     if (path.isEmpty()) {
         return saveFileAs(index);
@@ -139,7 +262,7 @@ bool EditorTabWidget::saveFileAs(int index)
     if (index < 0) return false;
 
     CodeEditor* editor = editorAt(index);
-    if (!editor) return false;
+    if (!editor || editor->isLoading()) return false;
 
     QString path = QFileDialog::getSaveFileName(this,
         tr("Save File As"),
@@ -165,7 +288,7 @@ bool EditorTabWidget::saveAllFiles()
     bool allSaved = true;
     for (int i = 0; i < count(); ++i) {
         CodeEditor* editor = editorAt(i);
-        if (editor && editor->document()->isModified()) {
+        if (editor && !editor->isLoading() && editor->document()->isModified()) {
             if (!saveFile(i)) {
                 allSaved = false;
             }
@@ -179,9 +302,23 @@ bool EditorTabWidget::closeFile(int index)
     if (index < 0) index = currentIndex();
     if (index < 0) return true;
 
+    if (LargeFileViewer* viewer = viewerAt(index)) {
+        m_fileViewers.remove(viewer->filePath());
+        removeTab(index);
+        viewer->deleteLater();
+        return true;
+    }
+
     CodeEditor* editor = editorAt(index);
     if (!editor) return true;
 
+    // Closing a file that is still loading cancels the load; it was
+    // never announced through fileOpened, so there is nothing to close
+    if (editor->isLoading()) {
+        discardEditor(editor);
+        return true;
+    }
+
     // Check for unsaved changes
     if (editor->document()->isModified()) {
         QMessageBox::StandardButton result = QMessageBox::question(this,
@@ -235,6 +372,19 @@ CodeEditor* EditorTabWidget::editorAt(int index) const
     return qobject_cast<CodeEditor*>(widget(index));
 }
 
+QWidget* EditorTabWidget::goToPosition(const QString& path, int line, int column)
+{
+    if (CodeEditor* editor = editorForFile(path)) {
+        editor->goToPosition(line, column);
+        return editor;
+    }
+    if (LargeFileViewer* viewer = m_fileViewers.value(path)) {
+        viewer->goToLine(line);
+        return viewer;
+    }
+    return nullptr;
+}
+
 CodeEditor* EditorTabWidget::editorForFile(const QString& path) const
 {
     // Try exact match first
@@ -263,11 +413,21 @@ int EditorTabWidget::indexOfFile(const QString& path) const
     return editor ? indexOf(editor) : -1;
 }
 
+LargeFileViewer* EditorTabWidget::currentViewer() const
+{
+    return qobject_cast<LargeFileViewer*>(currentWidget());
+}
+
+LargeFileViewer* EditorTabWidget::viewerAt(int index) const
+{
+    return qobject_cast<LargeFileViewer*>(widget(index));
+}
+
 bool EditorTabWidget::hasUnsavedChanges() const
 {
     for (int i = 0; i < count(); ++i) {
         CodeEditor* editor = editorAt(i);
-        if (editor && editor->document()->isModified()) {
+        if (editor && !editor->isLoading() && editor->document()->isModified()) {
             return true;
         }
     }
@@ -305,6 +465,8 @@ void EditorTabWidget::copy()
 {
     if (CodeEditor* editor = currentEditor()) {
         editor->copy();
+    } else if (LargeFileViewer* viewer = currentViewer()) {
+        viewer->copy();
     }
 }
 
@@ -319,6 +481,8 @@ void EditorTabWidget::selectAll()
 {
     if (CodeEditor* editor = currentEditor()) {
         editor->selectAll();
+    } else if (LargeFileViewer* viewer = currentViewer()) {
+        viewer->selectAll();
     }
 }
 
@@ -335,6 +499,9 @@ void EditorTabWidget::onCurrentChanged(int index)
     if (editor) {
         emit modificationChanged(editor->document()->isModified());
         onEditorCursorPositionChanged();
+    } else if (LargeFileViewer* viewer = viewerAt(index)) {
+        emit modificationChanged(false);
+        emit cursorPositionChanged(viewer->currentLine(), 1);
     }
 }
 
@@ -366,6 +533,17 @@ void EditorTabWidget::onEditorCursorPositionChanged()
 
 void EditorTabWidget::updateTabTitle(int index)
 {
+    if (LargeFileViewer* viewer = viewerAt(index)) {
+        QString title = QFileInfo(viewer->filePath()).fileName();
+        if (viewer->isIndexing()) {
+            title = tr("%1 (indexing %2%)").arg(title).arg(viewer->indexPercent());
+        } else {
+            title = tr("%1 (read-only)").arg(title);
+        }
+        setTabText(index, title);
+        return;
+    }
+
     CodeEditor* editor = editorAt(index);
     if (!editor) return;
 
@@ -382,7 +560,9 @@ void EditorTabWidget::updateTabTitle(int index)
         title = fileInfo.fileName();
     }
 
-    if (editor->document()->isModified()) {
+    if (FileLoader* loader = m_loaders.value(editor)) {
+        title = tr("%1 (loading %2%)").arg(title).arg(loader->percent());
+    } else if (editor->document()->isModified()) {
         title = "*" + title;
     }
 
@@ -2,11 +2,14 @@
 #define EDITORTABWIDGET_H
 
 #include <QTabWidget>
+#include <QHash>
 #include <QMap>
 
 namespace XXMLStudio {
 
 class CodeEditor;
+class FileLoader;
+class LargeFileViewer;
 
 /**
  * Tabbed container for code editors.
@@ -20,7 +23,8 @@ public:
     explicit EditorTabWidget(QWidget* parent = nullptr);
     ~EditorTabWidget();
 
-    // File operations
+    // File operations. Files above the large file threshold open in a
+    // LargeFileViewer, for which openFile returns nullptr.
     CodeEditor* openFile(const QString& path);
     CodeEditor* newFile();
     bool saveFile(int index = -1);
@@ -34,6 +38,13 @@ public:
     CodeEditor* editorAt(int index) const;
     CodeEditor* editorForFile(const QString& path) const;
     int indexOfFile(const QString& path) const;
+    LargeFileViewer* currentViewer() const;
+    LargeFileViewer* viewerAt(int index) const;
+
+    // Moves to a position (1-based) in an open file, once it has loaded
+    // if it is still loading. Returns the editor or viewer showing the
+    // file, or nullptr if it is not open.
+    QWidget* goToPosition(const QString& path, int line, int column = 1);
 
     // State queries
     bool hasUnsavedChanges() const;
@@ -63,11 +74,19 @@ private slots:
 
 private:
     void setupUi();
+    CodeEditor* openFileAsync(const QString& path);
+    void openLargeFile(const QString& path);
+    void discardEditor(CodeEditor* editor);
     void updateTabTitle(int index);
     QString generateUntitledName();
 
     QMap<QString, CodeEditor*> m_fileEditors;  // path -> editor
+    QHash<CodeEditor*, FileLoader*> m_loaders;  // editors still loading
+    QMap<QString, LargeFileViewer*> m_fileViewers;  // path -> viewer
     int m_untitledCounter = 0;
+
+    // Files at least this large are loaded in the background
+    static constexpr qint64 ASYNC_LOAD_MIN_BYTES = 1024 * 1024;
 };
 
 } // namespace XXMLStudio
@@ -0,0 +1,177 @@
+#include "FileLoader.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPromise>
+#include <QStringDecoder>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtConcurrent>
+
+namespace XXMLStudio {
+
+namespace {
+
+// Bytes read per step; small enough that appending one chunk stays
+// well inside a time slice
+constexpr qint64 READ_BYTES = 64 * 1024;
+
+// A line longer than this is handed over in pieces rather than held
+// back until its newline turns up
+constexpr qsizetype MAX_PENDING_CHARS = 4 * 1024 * 1024;
+
+void readFile(QPromise<FileLoader::Chunk>& promise, const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        FileLoader::Chunk chunk;
+        chunk.errorString = file.errorString();
+        promise.addResult(chunk);
+        return;
+    }
+
+    QStringDecoder decoder;
+    QString pending;
+
+    while (!promise.isCanceled()) {
+        QByteArray bytes = file.read(READ_BYTES);
+        if (bytes.isEmpty() && file.error() != QFileDevice::NoError) {
+            FileLoader::Chunk chunk;
+            chunk.errorString = file.errorString();
+            promise.addResult(chunk);
+            return;
+        }
+
+        if (!decoder.isValid()) {
+            // Same BOM detection as QTextStream, UTF-8 otherwise
+            decoder = QStringDecoder(QStringConverter::encodingForData(bytes).value_or(QStringConverter::Utf8));
+        }
+        pending += decoder.decode(bytes);
+
+        bool atEnd = bytes.isEmpty() || file.atEnd();
+        qsizetype cut = atEnd ? pending.size() : pending.lastIndexOf(QLatin1Char('\n')) + 1;
+        if (cut == 0 && pending.size() >= MAX_PENDING_CHARS) {
+            cut = pending.size();
+        }
+
+        if (cut > 0) {
+            FileLoader::Chunk chunk;
+            chunk.text = pending.left(cut);
+            chunk.endOffset = file.pos();
+            promise.addResult(chunk);
+            pending.remove(0, cut);
+        }
+
+        if (atEnd) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+FileLoader::FileLoader(QTextDocument* document, QObject* parent)
+    : QObject(parent)
+    , m_document(document)
+{
+    m_insertTimer = new QTimer(this);
+    m_insertTimer->setSingleShot(true);
+    m_insertTimer->setInterval(0);
+    connect(m_insertTimer, &QTimer::timeout, this, &FileLoader::insertPendingChunks);
+
+    // Chunks are appended on the next pass of the event loop, so the UI
+    // gets to paint between slices
+    connect(&m_watcher, &QFutureWatcher<Chunk>::resultsReadyAt, this, [this]() {
+        if (m_running && !m_insertTimer->isActive()) {
+            m_insertTimer->start();
+        }
+    });
+    connect(&m_watcher, &QFutureWatcher<Chunk>::finished, this, [this]() {
+        if (m_running && !m_insertTimer->isActive()) {
+            m_insertTimer->start();
+        }
+    });
+}
+
+FileLoader::~FileLoader()
+{
+    cancel();
+}
+
+void FileLoader::start(const QString& path)
+{
+    cancel();
+
+    m_totalBytes = QFileInfo(path).size();
+    m_nextChunk = 0;
+    m_percent = 0;
+    m_running = true;
+    m_watcher.setFuture(QtConcurrent::run(readFile, path));
+}
+
+void FileLoader::cancel()
+{
+    if (!m_running) return;
+
+    m_running = false;
+    m_insertTimer->stop();
+    m_watcher.cancel();
+}
+
+void FileLoader::insertPendingChunks()
+{
+    if (!m_running) return;
+
+    if (!m_document) {
+        cancel();
+        return;
+    }
+
+    QFuture<Chunk> future = m_watcher.future();
+    QElapsedTimer slice;
+    slice.start();
+
+    QTextCursor cursor(m_document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    QString errorString;
+    while (m_nextChunk < future.resultCount() && slice.elapsed() < SLICE_MS) {
+        Chunk chunk = future.resultAt(m_nextChunk++);
+        if (!chunk.errorString.isEmpty()) {
+            errorString = chunk.errorString;
+            break;
+        }
+        cursor.insertText(chunk.text);
+        if (m_totalBytes > 0) {
+            m_percent = static_cast<int>(qMin<qint64>(100, chunk.endOffset * 100 / m_totalBytes));
+        }
+    }
+    cursor.endEditBlock();
+
+    if (!errorString.isEmpty()) {
+        cancel();
+        emit failed(errorString);
+        return;
+    }
+
+    emit progressChanged(m_percent);
+
+    if (m_nextChunk < future.resultCount()) {
+        m_insertTimer->start();
+    } else if (m_watcher.isFinished()) {
+        finish();
+    }
+}
+
+void FileLoader::finish()
+{
+    m_running = false;
+    m_percent = 100;
+
+    // Drop the worker's copies of the text
+    m_watcher.setFuture(QFuture<Chunk>());
+    emit finished();
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,66 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+class QTextDocument;
+
+namespace XXMLStudio {
+
+/**
+ * Loads a file into a QTextDocument without blocking the UI.
+ *
+ * The file is read and decoded on a worker thread and handed over in
+ * line-aligned chunks, which are appended to the document in short time
+ * slices on the GUI thread. Deleting the loader or calling cancel()
+ * abandons the load; the worker notices at its next read.
+ */
+class FileLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // One decoded piece of the file, or the reason reading stopped
+    struct Chunk {
+        QString text;
+        qint64 endOffset = 0;   // File position after this chunk
+        QString errorString;
+    };
+
+    explicit FileLoader(QTextDocument* document, QObject* parent = nullptr);
+    ~FileLoader();
+
+    void start(const QString& path);
+    void cancel();
+
+    bool isRunning() const { return m_running; }
+    int percent() const { return m_percent; }
+
+signals:
+    void progressChanged(int percent);
+    void finished();
+    void failed(const QString& errorString);
+
+private:
+    void insertPendingChunks();
+    void finish();
+
+    QPointer<QTextDocument> m_document;
+    QFutureWatcher<Chunk> m_watcher;
+    QTimer* m_insertTimer = nullptr;
+    qint64 m_totalBytes = 0;
+    int m_nextChunk = 0;
+    int m_percent = 0;
+    bool m_running = false;
+
+    // Longest the GUI thread spends appending text per event loop pass
+    static constexpr int SLICE_MS = 8;
+};
+
+} // namespace XXMLStudio
+
+#endif // FILELOADER_H
@@ -0,0 +1,426 @@
+#include "FindInFiles.h"
+#include "../project/ProjectFileWalker.h"
+
+#include <QByteArrayMatcher>
+#include <QDir>
+#include <QFile>
+#include <QPromise>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace XXMLStudio {
+
+namespace {
+
+// Files handed to the pool per task: small at first so the first hits
+// come back quickly, larger later to keep scheduling overhead down
+constexpr int FIRST_BATCH_FILES = 16;
+constexpr int MAX_BATCH_FILES = 512;
+
+// A NUL byte this early marks a binary file
+constexpr qint64 BINARY_CHECK_BYTES = 8000;
+
+// Longest stretch of a line kept for the results list
+constexpr int MAX_PREVIEW_CHARS = 240;
+constexpr int PREVIEW_CONTEXT_CHARS = 40;
+
+inline uchar asciiLower(uchar ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? uchar(ch + ('a' - 'A')) : ch;
+}
+
+// Rejects files that cannot match without decoding them: a byte search
+// for a literal every match has to contain
+class Prefilter
+{
+public:
+    explicit Prefilter(const FindInFiles::Query& query)
+    {
+        QString literal = query.options.useRegex ? FindInFiles::requiredLiteral(query.pattern) : query.pattern;
+        if (literal.isEmpty()) {
+            return;
+        }
+        if (query.options.caseSensitive) {
+            m_needle = literal.toUtf8();
+            m_matcher.setPattern(m_needle);
+        } else if (std::all_of(literal.cbegin(), literal.cend(), [](QChar ch) { return ch.unicode() < 0x80; })) {
+            // Case folding beyond ASCII changes byte lengths; skip those
+            m_needle = literal.toLatin1().toLower();
+            m_caseInsensitive = true;
+        }
+    }
+
+    bool mayMatch(const char* data, qint64 size) const
+    {
+        if (m_needle.isEmpty()) {
+            return true;
+        }
+        if (!m_caseInsensitive) {
+            return m_matcher.indexIn(data, size) >= 0;
+        }
+
+        const qsizetype length = m_needle.size();
+        const uchar* bytes = reinterpret_cast<const uchar*>(data);
+        const uchar* needle = reinterpret_cast<const uchar*>(m_needle.constData());
+        const uchar first = needle[0];
+        const uchar firstUpper = (first >= 'a' && first <= 'z') ? uchar(first - ('a' - 'A')) : first;
+        for (qint64 i = 0; i + length <= size; ++i) {
+            if (bytes[i] != first && bytes[i] != firstUpper) {
+                continue;
+            }
+            qsizetype j = 1;
+            while (j < length && asciiLower(bytes[i + j]) == needle[j]) {
+                ++j;
+            }
+            if (j == length) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    QByteArray m_needle;
+    QByteArrayMatcher m_matcher;
+    bool m_caseInsensitive = false;
+};
+
+QList<FindInFiles::Match> matchesIn(const QString& text, const TextSearch& search, int limit)
+{
+    QList<FindInFiles::Match> matches;
+    QVector<TextSearch::Range> ranges;
+
+    // Matches never span lines, so each line is searched on its own and
+    // the scan stops once the limit is reached
+    int line = 1;
+    for (qsizetype lineStart = 0; lineStart <= text.size() && matches.size() < limit; ++line) {
+        qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd < 0) {
+            lineEnd = text.size();
+        }
+        QStringView lineText = QStringView(text).mid(lineStart, lineEnd - lineStart);
+        if (lineText.endsWith(QLatin1Char('\r'))) {
+            lineText.chop(1);
+        }
+
+        ranges.clear();
+        search.findInLine(lineText, ranges);
+        for (const TextSearch::Range& range : std::as_const(ranges)) {
+            if (matches.size() >= limit) {
+                break;
+            }
+            FindInFiles::Match match;
+            match.line = line;
+            match.column = range.start + 1;
+            match.length = range.length;
+
+            qsizetype previewStart = 0;
+            if (lineText.size() > MAX_PREVIEW_CHARS) {
+                previewStart = qMax(0, range.start - PREVIEW_CONTEXT_CHARS);
+            }
+            match.lineText = lineText.mid(previewStart, MAX_PREVIEW_CHARS).toString();
+            matches.append(match);
+        }
+        lineStart = lineEnd + 1;
+    }
+    return matches;
+}
+
+FindInFiles::FileResult searchFile(const QString& path, const TextSearch& search, const Prefilter& prefilter,
+                                   const QHash<QString, QString>& buffers, int limit)
+{
+    FindInFiles::FileResult result;
+    result.filePath = path;
+
+    auto buffer = buffers.constFind(path);
+    if (buffer != buffers.constEnd()) {
+        result.matches = matchesIn(*buffer, search, limit);
+        return result;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+    qint64 size = file.size();
+    if (size == 0 || size > FindInFiles::MAX_FILE_BYTES) {
+        return result;
+    }
+
+    // Map the file where possible; reading is the fallback for files
+    // that cannot be mapped (pipes, some network filesystems)
+    QByteArray bytes;
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        bytes = file.readAll();
+        data = bytes.constData();
+        size = bytes.size();
+    }
+
+    if (std::memchr(data, 0, static_cast<size_t>(qMin(size, BINARY_CHECK_BYTES)))
+        || !prefilter.mayMatch(data, size)) {
+        return result;
+    }
+
+    QString text = QString::fromUtf8(data, size);
+    if (text.startsWith(QChar(0xFEFF))) {
+        text.remove(0, 1);  // Editors never show the BOM, so columns would be off by one
+    }
+    result.matches = matchesIn(text, search, limit);
+    return result;
+}
+
+void searchProject(QPromise<FindInFiles::FileResult>& promise, const FindInFiles::Query& query,
+                   const QHash<QString, QString>& buffers, QThreadPool* pool)
+{
+    TextSearch search(query.pattern, query.options);
+    if (!search.isValid()) {
+        promise.addResult(FindInFiles::FileResult());
+        return;
+    }
+    Prefilter prefilter(query);
+
+    std::atomic<int> filesSearched{0};
+    std::atomic<int> matchesFound{0};
+    auto stopped = [&]() {
+        return promise.isCanceled() || matchesFound.load() >= FindInFiles::MAX_MATCHES;
+    };
+
+    // Batches run on the pool while the walk goes on; they all finish
+    // before this function returns, so capturing locals is safe
+    QList<QFuture<void>> batches;
+    QStringList batch;
+    int batchSize = FIRST_BATCH_FILES;
+    auto flush = [&]() {
+        batches.append(QtConcurrent::run(pool, [&, files = batch]() {
+            for (const QString& path : files) {
+                if (stopped()) {
+                    return;
+                }
+                int limit = FindInFiles::MAX_MATCHES - matchesFound.load();
+                FindInFiles::FileResult result = searchFile(path, search, prefilter, buffers, limit);
+                promise.setProgressValue(++filesSearched);
+                if (!result.matches.isEmpty()) {
+                    matchesFound += result.matches.size();
+                    promise.addResult(std::move(result));
+                }
+            }
+        }));
+        batch.clear();
+        batchSize = qMin(batchSize * 2, MAX_BATCH_FILES);
+    };
+
+    auto visit = [&](const QString& path) {
+        if (stopped()) {
+            return false;
+        }
+        batch.append(path);
+        if (batch.size() >= batchSize) {
+            flush();
+        }
+        return true;
+    };
+    if (query.useFiles) {
+        bool visiting = true;
+        for (const QString& path : query.files) {
+            if (!(visiting = visit(path))) break;
+        }
+        if (visiting && query.moreFiles) {
+            const QSet<QString> listed(query.files.cbegin(), query.files.cend());
+            const QStringList more = query.moreFiles();
+            for (const QString& path : more) {
+                if (!listed.contains(path) && !visit(path)) break;
+            }
+        }
+    } else {
+        ProjectFileWalker walker(query.rootPath);
+        walker.setExcludedPaths(query.excludedPaths);
+        walker.walk(visit);
+    }
+    if (!batch.isEmpty()) {
+        flush();
+    }
+
+    for (QFuture<void>& future : batches) {
+        future.waitForFinished();
+    }
+
+    FindInFiles::FileResult summary;
+    summary.filesSearched = filesSearched.load();
+    promise.addResult(summary);
+}
+
+} // namespace
+
+FindInFiles::FindInFiles(QObject* parent)
+    : QObject(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<FileResult>::resultsReadyAt, this, [this](int, int end) {
+        if (!m_running) return;
+
+        QList<FileResult> results;
+        for (; m_nextResult < end; ++m_nextResult) {
+            FileResult result = m_watcher.resultAt(m_nextResult);
+            if (result.filePath.isEmpty()) {
+                m_fileCount = result.filesSearched;
+                emit progressChanged(m_fileCount);
+                continue;
+            }
+            m_matchCount += result.matches.size();
+            results.append(result);
+        }
+        if (!results.isEmpty()) {
+            emit resultsFound(results);
+        }
+    });
+    connect(&m_watcher, &QFutureWatcher<FileResult>::progressValueChanged, this, [this](int value) {
+        if (!m_running) return;
+        m_fileCount = value;
+        emit progressChanged(m_fileCount);
+    });
+    connect(&m_watcher, &QFutureWatcher<FileResult>::finished, this, [this]() {
+        if (!m_running) return;
+        m_running = false;
+        m_limitReached = m_matchCount >= MAX_MATCHES;
+        emit finished(false);
+    });
+}
+
+FindInFiles::~FindInFiles()
+{
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+void FindInFiles::start(const Query& query, const QHash<QString, QString>& buffers)
+{
+    // The previous search uses m_pool until it returns; workers stop at
+    // their next file once cancelled
+    cancel();
+    m_watcher.waitForFinished();
+
+    // Keys as the walker will produce them
+    QHash<QString, QString> normalizedBuffers;
+    for (auto it = buffers.constBegin(); it != buffers.constEnd(); ++it) {
+        normalizedBuffers.insert(QDir::cleanPath(it.key()), it.value());
+    }
+
+    // Unsaved text may match where the file on disk does not
+    Query effectiveQuery = query;
+    if (query.useFiles) {
+        QSet<QString> files(query.files.cbegin(), query.files.cend());
+        const QString rootPrefix = QDir::cleanPath(query.rootPath) + QLatin1Char('/');
+        for (auto it = normalizedBuffers.constBegin(); it != normalizedBuffers.constEnd(); ++it) {
+            if (it.key().startsWith(rootPrefix) && !files.contains(it.key())) {
+                effectiveQuery.files.append(it.key());
+            }
+        }
+    }
+
+    m_nextResult = 0;
+    m_fileCount = 0;
+    m_matchCount = 0;
+    m_limitReached = false;
+    m_running = true;
+    m_watcher.setFuture(QtConcurrent::run(searchProject, effectiveQuery, normalizedBuffers, &m_pool));
+}
+
+void FindInFiles::cancel()
+{
+    if (!m_running) return;
+
+    m_running = false;
+    m_watcher.cancel();
+    emit finished(true);
+}
+
+QString FindInFiles::requiredLiteral(const QString& regex)
+{
+    // Alternation or inline options could make any literal optional
+    // or change its case; give up rather than risk skipping a match
+    if (regex.contains(QLatin1Char('|')) || regex.contains(QLatin1String("(?"))) {
+        return QString();
+    }
+
+    QString best;
+    QString run;
+    int depth = 0;
+    bool lastWasLiteral = false;
+    auto endRun = [&]() {
+        if (run.size() > best.size()) {
+            best = run;
+        }
+        run.clear();
+        lastWasLiteral = false;
+    };
+
+    for (qsizetype i = 0; i < regex.size(); ++i) {
+        QChar ch = regex[i];
+        switch (ch.unicode()) {
+        case '\\':
+            if (i + 1 < regex.size() && !regex[i + 1].isLetterOrNumber() && depth == 0) {
+                run += regex[++i];
+                lastWasLiteral = true;
+            } else {
+                ++i;        // \d, \w, \b, \1 and friends
+                endRun();
+            }
+            break;
+        case '[':
+            // Skip the class; a ']' right after '[' or '[^' is literal
+            i += (i + 1 < regex.size() && regex[i + 1] == QLatin1Char('^')) ? 2 : 1;
+            if (i < regex.size() && regex[i] == QLatin1Char(']')) ++i;
+            while (i < regex.size() && regex[i] != QLatin1Char(']')) {
+                if (regex[i] == QLatin1Char('\\')) ++i;
+                ++i;
+            }
+            endRun();
+            break;
+        case '(':
+            ++depth;
+            endRun();
+            break;
+        case ')':
+            depth = qMax(0, depth - 1);
+            endRun();
+            break;
+        case '*':
+        case '?':
+        case '{':
+            // The atom before may not appear at all
+            if (lastWasLiteral && !run.isEmpty()) {
+                run.chop(1);
+            }
+            if (ch == QLatin1Char('{')) {
+                qsizetype close = regex.indexOf(QLatin1Char('}'), i);
+                i = close < 0 ? regex.size() : close;
+            }
+            endRun();
+            break;
+        case '+':
+            // At least once, but what follows need not be adjacent
+            endRun();
+            break;
+        case '.':
+        case '^':
+        case '$':
+            endRun();
+            break;
+        default:
+            if (depth == 0) {
+                run += ch;
+                lastWasLiteral = true;
+            } else {
+                endRun();
+            }
+            break;
+        }
+    }
+    endRun();
+    return best;
+}
+
+} // namespace XXMLStudio
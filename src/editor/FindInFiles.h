@@ -0,0 +1,98 @@
+#ifndef FINDINFILES_H
+#define FINDINFILES_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+#include "TextSearch.h"
+
+namespace XXMLStudio {
+
+/**
+ * Searches every file under a project root without blocking the UI.
+ *
+ * A walker thread enumerates the tree with ProjectFileWalker and hands
+ * files to a thread pool in batches that grow from small (so the first
+ * hits arrive quickly) to large. Each file is memory-mapped and checked
+ * for a literal the pattern requires before it is decoded and searched.
+ * Results are reported per file as they are found. Buffers passed to
+ * start() are searched instead of the files they were opened from.
+ */
+class FindInFiles : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Query {
+        QString pattern;
+        TextSearch::Options options;
+        QString rootPath;
+        QStringList excludedPaths;      // Relative to rootPath
+        // Search just these files instead of walking rootPath, e.g. the
+        // candidates from TrigramIndex
+        QStringList files;
+        bool useFiles = false;
+        // With useFiles, lists more files to search on the search
+        // thread, e.g. those changed since TrigramIndex last saw them
+        std::function<QStringList()> moreFiles;
+    };
+
+    struct Match {
+        int line = 0;                   // 1-based
+        int column = 0;                 // 1-based
+        int length = 0;
+        QString lineText;
+    };
+
+    // Matches in one file. The last result of a search has no file
+    // and carries the final count of files searched.
+    struct FileResult {
+        QString filePath;
+        QList<Match> matches;
+        int filesSearched = 0;
+    };
+
+    explicit FindInFiles(QObject* parent = nullptr);
+    ~FindInFiles();
+
+    // Buffers maps file paths to their unsaved text
+    void start(const Query& query, const QHash<QString, QString>& buffers = {});
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    int fileCount() const { return m_fileCount; }
+    int matchCount() const { return m_matchCount; }
+    bool limitReached() const { return m_limitReached; }
+
+    // A literal every match of the regular expression contains, or an
+    // empty string if none can be found
+    static QString requiredLiteral(const QString& regex);
+
+    // Files larger than this are skipped
+    static constexpr qint64 MAX_FILE_BYTES = 32 * 1024 * 1024;
+    // Stop collecting after this many matches in total
+    static constexpr int MAX_MATCHES = 20000;
+
+signals:
+    void resultsFound(const QList<FindInFiles::FileResult>& results);
+    void progressChanged(int filesSearched);
+    void finished(bool cancelled);
+
+private:
+    QFutureWatcher<FileResult> m_watcher;
+    QThreadPool m_pool;
+    int m_nextResult = 0;
+    int m_fileCount = 0;
+    int m_matchCount = 0;
+    bool m_limitReached = false;
+    bool m_running = false;
+};
+
+} // namespace XXMLStudio
+
+#endif // FINDINFILES_H
@@ -0,0 +1,642 @@
+#include "LargeFileViewer.h"
+
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <QMessageBox>
+#include <QPainter>
+#include <QPromise>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+
+namespace XXMLStudio {
+
+namespace {
+
+// Bytes scanned per step of the line index; each step is one progress update
+constexpr qint64 INDEX_STEP_BYTES = 16 * 1024 * 1024;
+
+// Lines searched between checks for cancellation
+constexpr int SEARCH_CANCEL_CHECK_LINES = 4096;
+
+struct SearchOptions {
+    QString text;
+    QByteArray needle;
+    QRegularExpression regex;
+    bool caseSensitive = false;
+    bool wholeWord = false;
+    bool useRegex = false;
+};
+
+void indexLines(QPromise<LargeFileViewer::IndexBatch>& promise, const uchar* data, qint64 size)
+{
+    qint64 lineStart = 0;
+    qint64 offset = 0;
+    while (offset < size && !promise.isCanceled()) {
+        LargeFileViewer::IndexBatch batch;
+        qint64 stepEnd = qMin(size, offset + INDEX_STEP_BYTES);
+        const uchar* p = data + offset;
+        while (const void* hit = std::memchr(p, '\n', static_cast<size_t>(data + stepEnd - p))) {
+            qint64 next = static_cast<const uchar*>(hit) - data + 1;
+            batch.longestLine = qMax(batch.longestLine, next - 1 - lineStart);
+            batch.lineStarts.append(next);
+            lineStart = next;
+            p = data + next;
+        }
+        offset = stepEnd;
+        batch.longestLine = qMax(batch.longestLine, offset - lineStart);
+        batch.endOffset = offset;
+        promise.addResult(std::move(batch));
+    }
+}
+
+QString decode(const uchar* data, qint64 length)
+{
+    return QString::fromUtf8(reinterpret_cast<const char*>(data), length);
+}
+
+qint64 utf8Length(QStringView text)
+{
+    return text.toUtf8().size();
+}
+
+qint64 lineStartOf(const uchar* data, qint64 offset)
+{
+    while (offset > 0 && data[offset - 1] != '\n') {
+        --offset;
+    }
+    return offset;
+}
+
+bool isWordChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+
+bool isWholeWord(const QString& text, int start, int length)
+{
+    int end = start + length;
+    return (start == 0 || !isWordChar(text[start - 1]))
+        && (end >= text.size() || !isWordChar(text[end]));
+}
+
+// Finds a match in one line starting at or after fromChar, or when
+// searching backward the last one starting before it
+bool matchInLine(const QString& text, int fromChar, bool backward, const SearchOptions& options,
+                 int& start, int& length)
+{
+    if (options.useRegex) {
+        bool found = false;
+        QRegularExpressionMatchIterator it = options.regex.globalMatch(text, backward ? 0 : fromChar);
+        while (it.hasNext()) {
+            QRegularExpressionMatch match = it.next();
+            if (match.capturedLength() == 0) {
+                continue;
+            }
+            if (backward && match.capturedStart() >= fromChar) {
+                break;
+            }
+            start = match.capturedStart();
+            length = match.capturedLength();
+            found = true;
+            if (!backward) {
+                break;
+            }
+        }
+        return found;
+    }
+
+    Qt::CaseSensitivity cs = options.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    length = options.text.size();
+    if (backward) {
+        // lastIndexOf treats -1 as "from the end"
+        for (int from = fromChar - 1; from >= 0; from = start - 1) {
+            start = text.lastIndexOf(options.text, from, cs);
+            if (start < 0) return false;
+            if (!options.wholeWord || isWholeWord(text, start, length)) return true;
+        }
+        return false;
+    }
+    for (int from = fromChar; from <= text.size(); from = start + 1) {
+        start = text.indexOf(options.text, from, cs);
+        if (start < 0) return false;
+        if (!options.wholeWord || isWholeWord(text, start, length)) return true;
+    }
+    return false;
+}
+
+// Searches [from, end) forward, or [end, from) backward, line by line
+LargeFileViewer::Match searchLines(QPromise<LargeFileViewer::Match>& promise, const uchar* data, qint64 size,
+                                   qint64 from, qint64 end, const SearchOptions& options, bool backward)
+{
+    LargeFileViewer::Match result;
+    qint64 lineStart = lineStartOf(data, from);
+    for (int lines = 0; ; ++lines) {
+        if (lines % SEARCH_CANCEL_CHECK_LINES == 0 && promise.isCanceled()) {
+            return result;
+        }
+
+        const void* newline = std::memchr(data + lineStart, '\n', static_cast<size_t>(size - lineStart));
+        qint64 lineEnd = newline ? static_cast<const uchar*>(newline) - data : size;
+        QString text = decode(data + lineStart, lineEnd - lineStart);
+
+        int fromChar;
+        if (from >= lineStart && from <= lineEnd) {
+            fromChar = decode(data + lineStart, from - lineStart).size();
+        } else {
+            fromChar = backward ? text.size() : 0;
+        }
+
+        int start = 0;
+        int length = 0;
+        if (matchInLine(text, fromChar, backward, options, start, length)) {
+            qint64 offset = lineStart + utf8Length(QStringView(text).left(start));
+            if (backward ? offset >= end : offset < end) {
+                result.offset = offset;
+                result.length = utf8Length(QStringView(text).mid(start, length));
+            }
+            return result;
+        }
+
+        if (backward) {
+            if (lineStart <= end || lineStart == 0) return result;
+            lineStart = lineStartOf(data, lineStart - 1);
+        } else {
+            if (lineEnd >= end || lineEnd >= size) return result;
+            lineStart = lineEnd + 1;
+        }
+    }
+}
+
+LargeFileViewer::Match searchRange(QPromise<LargeFileViewer::Match>& promise, const uchar* data, qint64 size,
+                                   qint64 from, qint64 end, const SearchOptions& options, bool backward)
+{
+    // Plain case-sensitive text needs no decoding at all
+    if (!options.useRegex && options.caseSensitive && !options.wholeWord) {
+        LargeFileViewer::Match result;
+        const char* bytes = reinterpret_cast<const char*>(data);
+        qsizetype index = backward
+            ? QByteArrayView(bytes + end, from - end).lastIndexOf(options.needle)
+            : QByteArrayView(bytes + from, end - from).indexOf(options.needle);
+        if (index >= 0) {
+            result.offset = (backward ? end : from) + index;
+            result.length = options.needle.size();
+        }
+        return result;
+    }
+    return searchLines(promise, data, size, from, end, options, backward);
+}
+
+void findText(QPromise<LargeFileViewer::Match>& promise, const uchar* data, qint64 size,
+              qint64 from, const SearchOptions& options, bool backward)
+{
+    LargeFileViewer::Match result = backward
+        ? searchRange(promise, data, size, from, 0, options, true)
+        : searchRange(promise, data, size, from, size, options, false);
+
+    // Wrap around
+    if (result.offset < 0 && !promise.isCanceled()) {
+        result = backward
+            ? searchRange(promise, data, size, size, from, options, true)
+            : searchRange(promise, data, size, 0, from, options, false);
+    }
+    promise.addResult(result);
+}
+
+} // namespace
+
+LargeFileViewer::LargeFileViewer(QWidget* parent)
+    : QAbstractScrollArea(parent)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    updateMetrics();
+
+    connect(&m_indexWatcher, &QFutureWatcher<IndexBatch>::resultsReadyAt,
+            this, &LargeFileViewer::appendIndexBatches);
+    connect(&m_indexWatcher, &QFutureWatcher<IndexBatch>::finished, this, [this]() {
+        if (!m_indexing) return;
+        m_indexing = false;
+        m_indexPercent = 100;
+        m_indexWatcher.setFuture(QFuture<IndexBatch>());
+        updateScrollBars();
+        viewport()->update();
+        emit indexProgressChanged(m_indexPercent);
+    });
+
+    connect(&m_findWatcher, &QFutureWatcher<Match>::finished, this, [this]() {
+        QFuture<Match> future = m_findWatcher.future();
+        if (future.isCanceled() || future.resultCount() == 0) {
+            return;
+        }
+        Match match = future.result();
+        if (match.offset >= 0) {
+            setSelection(match.offset, match.offset + match.length);
+            ensureVisible(match.offset);
+        }
+        emit findFinished(match.offset >= 0);
+    });
+}
+
+LargeFileViewer::~LargeFileViewer()
+{
+    // Both workers read the mapping, which goes away with m_file
+    m_indexWatcher.cancel();
+    m_findWatcher.cancel();
+    m_indexWatcher.waitForFinished();
+    m_findWatcher.waitForFinished();
+}
+
+bool LargeFileViewer::openFile(const QString& path)
+{
+    m_filePath = path;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size > 0) {
+        m_data = m_file.map(0, m_size);
+        if (!m_data) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_lineStarts = {0};
+    m_longestLine = 0;
+    m_indexPercent = 0;
+    m_indexing = m_size > 0;
+    if (m_indexing) {
+        m_indexWatcher.setFuture(QtConcurrent::run(indexLines, m_data, m_size));
+    }
+    updateScrollBars();
+    return true;
+}
+
+void LargeFileViewer::setTabWidth(int spaces)
+{
+    m_tabWidth = qMax(1, spaces);
+    updateScrollBars();
+    viewport()->update();
+}
+
+int LargeFileViewer::lineCount() const
+{
+    // The last start found so far has no known end until indexing is done
+    return m_indexing ? m_lineStarts.size() - 1 : m_lineStarts.size();
+}
+
+void LargeFileViewer::goToLine(int line)
+{
+    if (lineCount() == 0) return;
+
+    line = qBound(1, line, lineCount());
+    qint64 offset = m_lineStarts[line - 1];
+    setSelection(offset, offset);
+    verticalScrollBar()->setValue(line - 1 - visibleLineCount() / 2);
+    horizontalScrollBar()->setValue(0);
+}
+
+int LargeFileViewer::currentLine() const
+{
+    return lineAt(m_position) + 1;
+}
+
+void LargeFileViewer::find(const QString& text, bool caseSensitive, bool wholeWord, bool useRegex, bool backward)
+{
+    if (m_findWatcher.isRunning()) {
+        m_findWatcher.cancel();
+        m_findWatcher.waitForFinished();
+    }
+
+    SearchOptions options;
+    options.text = text;
+    options.needle = text.toUtf8();
+    options.caseSensitive = caseSensitive;
+    options.wholeWord = wholeWord;
+    options.useRegex = useRegex;
+    if (useRegex) {
+        options.regex = QRegularExpression(text, caseSensitive ? QRegularExpression::NoPatternOption
+                                                               : QRegularExpression::CaseInsensitiveOption);
+    }
+
+    if (text.isEmpty() || !m_data || (useRegex && !options.regex.isValid())) {
+        emit findFinished(false);
+        return;
+    }
+
+    // Only the indexed part can be shown, so only that part is searched
+    qint64 size = m_indexing ? m_lineStarts.last() : m_size;
+    qint64 from = backward ? qMin(m_anchor, m_position) : qMax(m_anchor, m_position);
+    from = qMin(from, size);
+
+    m_findWatcher.setFuture(QtConcurrent::run(findText, m_data, size, from, options, backward));
+}
+
+QString LargeFileViewer::selectedText() const
+{
+    qint64 start = qMin(m_anchor, m_position);
+    qint64 end = qMax(m_anchor, m_position);
+    return m_data ? decode(m_data + start, end - start) : QString();
+}
+
+void LargeFileViewer::copy()
+{
+    if (!hasSelection()) return;
+
+    qint64 length = qAbs(m_position - m_anchor);
+    if (length > MAX_COPY_BYTES) {
+        QMessageBox::warning(this, tr("Copy"),
+            tr("The selection is too large to copy (%1 MB, the limit is %2 MB).")
+                .arg(length / (1024 * 1024))
+                .arg(MAX_COPY_BYTES / (1024 * 1024)));
+        return;
+    }
+    QGuiApplication::clipboard()->setText(selectedText());
+}
+
+void LargeFileViewer::selectAll()
+{
+    setSelection(0, m_indexing ? m_lineStarts.last() : m_size);
+}
+
+void LargeFileViewer::appendIndexBatches(int begin, int end)
+{
+    QFuture<IndexBatch> future = m_indexWatcher.future();
+    for (int i = begin; i < end; ++i) {
+        IndexBatch batch = future.resultAt(i);
+        m_lineStarts += batch.lineStarts;
+        m_longestLine = qMax(m_longestLine, batch.longestLine);
+        m_indexPercent = static_cast<int>(batch.endOffset * 100 / m_size);
+    }
+
+    updateScrollBars();
+    viewport()->update();
+    emit indexProgressChanged(m_indexPercent);
+}
+
+void LargeFileViewer::updateMetrics()
+{
+    QFontMetrics metrics(font());
+    m_lineHeight = qMax(1, metrics.height());
+    m_charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char(' ')));
+}
+
+void LargeFileViewer::updateScrollBars()
+{
+    int rows = visibleLineCount();
+    verticalScrollBar()->setRange(0, qMax(0, lineCount() - rows));
+    verticalScrollBar()->setPageStep(rows);
+    verticalScrollBar()->setSingleStep(1);
+
+    // Tabs make this an estimate, which is good enough for a scroll range
+    int textWidth = viewport()->width() - gutterWidth();
+    qint64 contentWidth = qMin(m_longestLine, MAX_DISPLAY_LINE_BYTES) * m_charWidth + 2 * TEXT_PADDING;
+    horizontalScrollBar()->setRange(0, static_cast<int>(qMax<qint64>(0, contentWidth - textWidth)));
+    horizontalScrollBar()->setPageStep(qMax(1, textWidth));
+    horizontalScrollBar()->setSingleStep(m_charWidth);
+}
+
+void LargeFileViewer::setSelection(qint64 anchor, qint64 position)
+{
+    m_anchor = anchor;
+    m_position = position;
+    viewport()->update();
+
+    int line = lineAt(position);
+    if (line < m_lineStarts.size()) {
+        qint64 lineStart = m_lineStarts[line];
+        qint64 bytes = qMin(position - lineStart, MAX_DISPLAY_LINE_BYTES);
+        QString text = decode(m_data + lineStart, bytes);
+        emit cursorPositionChanged(line + 1, columnAt(text, text.size()) + 1);
+    }
+}
+
+void LargeFileViewer::ensureVisible(qint64 offset)
+{
+    int line = lineAt(offset);
+    int first = verticalScrollBar()->value();
+    int rows = visibleLineCount();
+    if (line < first || line >= first + rows) {
+        verticalScrollBar()->setValue(line - rows / 2);
+    }
+
+    qint64 bytes = qMin(offset - m_lineStarts[line], MAX_DISPLAY_LINE_BYTES);
+    QString text = decode(m_data + m_lineStarts[line], bytes);
+    int x = columnAt(text, text.size()) * m_charWidth;
+    int textWidth = viewport()->width() - gutterWidth() - TEXT_PADDING;
+    int scrollX = horizontalScrollBar()->value();
+    if (x < scrollX || x >= scrollX + textWidth) {
+        horizontalScrollBar()->setValue(x - textWidth / 2);
+    }
+}
+
+int LargeFileViewer::lineAt(qint64 offset) const
+{
+    auto it = std::upper_bound(m_lineStarts.constBegin(), m_lineStarts.constEnd(), offset);
+    int line = static_cast<int>(it - m_lineStarts.constBegin()) - 1;
+    return qBound(0, line, qMax(0, lineCount() - 1));
+}
+
+qint64 LargeFileViewer::lineEnd(int line) const
+{
+    qint64 end = line + 1 < m_lineStarts.size() ? m_lineStarts[line + 1] - 1 : m_size;
+    if (end > m_lineStarts[line] && m_data[end - 1] == '\r') {
+        --end;
+    }
+    return end;
+}
+
+QString LargeFileViewer::lineText(int line) const
+{
+    qint64 start = m_lineStarts[line];
+    qint64 length = qMin(lineEnd(line) - start, MAX_DISPLAY_LINE_BYTES);
+    return decode(m_data + start, length);
+}
+
+int LargeFileViewer::gutterWidth() const
+{
+    int digits = QString::number(qMax(1, lineCount())).size();
+    return digits * m_charWidth + 2 * TEXT_PADDING;
+}
+
+int LargeFileViewer::visibleLineCount() const
+{
+    return qMax(1, viewport()->height() / m_lineHeight);
+}
+
+int LargeFileViewer::columnAt(const QString& text, int charIndex) const
+{
+    int column = 0;
+    for (int i = 0; i < charIndex && i < text.size(); ++i) {
+        column = text[i] == QLatin1Char('\t') ? (column / m_tabWidth + 1) * m_tabWidth : column + 1;
+    }
+    return column;
+}
+
+int LargeFileViewer::charIndexAt(const QString& text, int column) const
+{
+    int current = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        int next = text[i] == QLatin1Char('\t') ? (current / m_tabWidth + 1) * m_tabWidth : current + 1;
+        if (column < (current + next + 1) / 2) {
+            return i;
+        }
+        current = next;
+    }
+    return text.size();
+}
+
+qint64 LargeFileViewer::offsetAt(const QPoint& pos) const
+{
+    if (lineCount() == 0) return 0;
+
+    int row = pos.y() < 0 ? -1 : pos.y() / m_lineHeight;
+    int line = qBound(0, verticalScrollBar()->value() + row, lineCount() - 1);
+    QString text = lineText(line);
+
+    int x = pos.x() - gutterWidth() - TEXT_PADDING + horizontalScrollBar()->value();
+    int column = qMax(0, x) / m_charWidth;
+    int charIndex = charIndexAt(text, column);
+    return m_lineStarts[line] + utf8Length(QStringView(text).left(charIndex));
+}
+
+void LargeFileViewer::changeEvent(QEvent* event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateMetrics();
+        updateScrollBars();
+    }
+}
+
+void LargeFileViewer::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().base());
+
+    int gutter = gutterWidth();
+    int width = viewport()->width();
+    painter.fillRect(0, 0, gutter, viewport()->height(), QColor(37, 37, 38));  // Same gutter as CodeEditor
+    painter.setPen(QColor(62, 62, 64));
+    painter.drawLine(gutter - 1, 0, gutter - 1, viewport()->height());
+
+    if (!m_data) return;
+
+    QFontMetrics metrics(font());
+    int scrollX = horizontalScrollBar()->value();
+    int firstColumn = scrollX / m_charWidth;
+    int columns = width / m_charWidth + 2;
+    int textLeft = gutter + TEXT_PADDING - scrollX;
+    qint64 selectionStart = qMin(m_anchor, m_position);
+    qint64 selectionEnd = qMax(m_anchor, m_position);
+    int currentLineIndex = lineAt(m_position);
+
+    int first = verticalScrollBar()->value();
+    int last = qMin(lineCount() - 1, first + visibleLineCount());
+    for (int line = first; line <= last; ++line) {
+        int top = (line - first) * m_lineHeight;
+        qint64 start = m_lineStarts[line];
+        qint64 end = lineEnd(line);
+        QString text = lineText(line);
+
+        painter.setClipping(false);
+        painter.setPen(line == currentLineIndex ? QColor(241, 241, 241) : QColor(133, 133, 133));
+        painter.drawText(0, top, gutter - TEXT_PADDING, m_lineHeight, Qt::AlignRight, QString::number(line + 1));
+
+        painter.setClipRect(gutter, 0, width - gutter, viewport()->height());
+
+        // Selection, extended by a character where it spans the line break
+        if (selectionStart < selectionEnd && selectionStart <= end && selectionEnd > start) {
+            qint64 displayedEnd = start + qMin(end - start, MAX_DISPLAY_LINE_BYTES);
+            int fromChar = selectionStart <= start ? 0
+                : decode(m_data + start, qMin(selectionStart, displayedEnd) - start).size();
+            int toChar = selectionEnd >= displayedEnd ? text.size()
+                : decode(m_data + start, selectionEnd - start).size();
+            int x0 = textLeft + columnAt(text, fromChar) * m_charWidth;
+            int x1 = textLeft + columnAt(text, toChar) * m_charWidth + (selectionEnd > end ? m_charWidth : 0);
+            painter.fillRect(x0, top, x1 - x0, m_lineHeight, palette().highlight());
+        }
+
+        // Expand tabs and draw only the columns on screen
+        QString shown;
+        int shownColumn = -1;
+        int column = 0;
+        for (QChar ch : text) {
+            if (column >= firstColumn + columns) break;
+            int next = ch == QLatin1Char('\t') ? (column / m_tabWidth + 1) * m_tabWidth : column + 1;
+            if (next > firstColumn) {
+                if (shownColumn < 0) {
+                    shownColumn = column;
+                }
+                if (ch == QLatin1Char('\t')) {
+                    shown.append(QString(next - column, QLatin1Char(' ')));
+                } else {
+                    shown.append(ch);
+                }
+            }
+            column = next;
+        }
+        if (!shown.isEmpty()) {
+            painter.setPen(palette().text().color());
+            painter.drawText(textLeft + shownColumn * m_charWidth, top + metrics.ascent(), shown);
+        }
+    }
+}
+
+void LargeFileViewer::resizeEvent(QResizeEvent* event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LargeFileViewer::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copy();
+    } else if (event->matches(QKeySequence::SelectAll)) {
+        selectAll();
+    } else if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->setValue(0);
+    } else if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    } else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void LargeFileViewer::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    qint64 offset = offsetAt(event->position().toPoint());
+    setSelection(event->modifiers() & Qt::ShiftModifier ? m_anchor : offset, offset);
+}
+
+void LargeFileViewer::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!(event->buttons() & Qt::LeftButton)) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+
+    // Dragging past the edges scrolls
+    QPoint pos = event->position().toPoint();
+    if (pos.y() < 0) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    } else if (pos.y() > viewport()->height()) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    }
+    setSelection(m_anchor, offsetAt(pos));
+}
+
+} // namespace XXMLStudio
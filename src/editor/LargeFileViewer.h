@@ -0,0 +1,125 @@
+#ifndef LARGEFILEVIEWER_H
+#define LARGEFILEVIEWER_H
+
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QVector>
+
+namespace XXMLStudio {
+
+/**
+ * Read-only viewer for files too large for CodeEditor.
+ *
+ * The file is memory-mapped rather than loaded into a QTextDocument.
+ * A background pass records where each line starts, and only the lines
+ * on screen are decoded and painted. Positions (cursor, selection and
+ * search results) are byte offsets into the mapping, so the memory cost
+ * is the line index alone: 8 bytes per line.
+ */
+class LargeFileViewer : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    // Line starts found by one step of the background index
+    struct IndexBatch {
+        QVector<qint64> lineStarts;
+        qint64 longestLine = 0;     // In bytes
+        qint64 endOffset = 0;       // Bytes scanned so far
+    };
+
+    // A search hit as a byte range, or offset -1
+    struct Match {
+        qint64 offset = -1;
+        qint64 length = 0;
+    };
+
+    explicit LargeFileViewer(QWidget* parent = nullptr);
+    ~LargeFileViewer();
+
+    bool openFile(const QString& path);
+    QString filePath() const { return m_filePath; }
+    QString errorString() const { return m_file.errorString(); }
+
+    void setTabWidth(int spaces);
+
+    // Lines are available as soon as the index has reached them
+    int lineCount() const;
+    bool isIndexing() const { return m_indexing; }
+    int indexPercent() const { return m_indexPercent; }
+
+    // Navigation (1-based)
+    void goToLine(int line);
+    int currentLine() const;
+
+    // Searches from the selection and wraps around; the result arrives
+    // through findFinished
+    void find(const QString& text, bool caseSensitive, bool wholeWord, bool useRegex, bool backward);
+    bool isSearching() const { return m_findWatcher.isRunning(); }
+
+    // Selection
+    bool hasSelection() const { return m_anchor != m_position; }
+    QString selectedText() const;
+    void copy();
+    void selectAll();
+
+signals:
+    void indexProgressChanged(int percent);
+    void findFinished(bool found);
+    void cursorPositionChanged(int line, int column);
+
+protected:
+    void changeEvent(QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    void appendIndexBatches(int begin, int end);
+    void updateMetrics();
+    void updateScrollBars();
+    void setSelection(qint64 anchor, qint64 position);
+    void ensureVisible(qint64 offset);
+
+    int lineAt(qint64 offset) const;
+    qint64 lineEnd(int line) const;
+    QString lineText(int line) const;
+    int gutterWidth() const;
+    int visibleLineCount() const;
+    int columnAt(const QString& text, int charIndex) const;
+    int charIndexAt(const QString& text, int column) const;
+    qint64 offsetAt(const QPoint& pos) const;
+
+    QString m_filePath;
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+
+    QVector<qint64> m_lineStarts;
+    qint64 m_longestLine = 0;
+    int m_indexPercent = 0;
+    bool m_indexing = false;
+    QFutureWatcher<IndexBatch> m_indexWatcher;
+    QFutureWatcher<Match> m_findWatcher;
+
+    // Selection as byte offsets; equal when there is none
+    qint64 m_anchor = 0;
+    qint64 m_position = 0;
+
+    int m_lineHeight = 1;
+    int m_charWidth = 1;
+    int m_tabWidth = 4;
+
+    // Longer lines are cut off on screen, though copy and search see them whole
+    static constexpr qint64 MAX_DISPLAY_LINE_BYTES = 64 * 1024;
+    // Copying more than this would stall the UI and the clipboard
+    static constexpr qint64 MAX_COPY_BYTES = 64 * 1024 * 1024;
+    static constexpr int TEXT_PADDING = 6;
+};
+
+} // namespace XXMLStudio
+
+#endif // LARGEFILEVIEWER_H
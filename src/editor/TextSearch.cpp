@@ -0,0 +1,118 @@
+#include "TextSearch.h"
+
+namespace XXMLStudio {
+
+namespace {
+
+bool isWordChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+
+bool isWholeWord(QStringView text, qsizetype start, qsizetype length)
+{
+    qsizetype end = start + length;
+    return (start == 0 || !isWordChar(text[start - 1]))
+        && (end >= text.size() || !isWordChar(text[end]));
+}
+
+} // namespace
+
+TextSearch::TextSearch(const QString& pattern, const Options& options)
+    : m_pattern(pattern)
+    , m_options(options)
+{
+    Qt::CaseSensitivity cs = options.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    if (options.useRegex) {
+        // Subjects are single lines; multiline mode only matters if a
+        // caller passes more
+        QRegularExpression::PatternOptions patternOptions = QRegularExpression::MultilineOption;
+        if (!options.caseSensitive) {
+            patternOptions |= QRegularExpression::CaseInsensitiveOption;
+        }
+        m_regex = QRegularExpression(pattern, patternOptions);
+    } else {
+        m_matcher = QStringMatcher(pattern, cs);
+    }
+}
+
+bool TextSearch::isValid() const
+{
+    return !m_pattern.isEmpty() && (!m_options.useRegex || m_regex.isValid());
+}
+
+QString TextSearch::errorString() const
+{
+    return m_options.useRegex ? m_regex.errorString() : QString();
+}
+
+QVector<TextSearch::Range> TextSearch::findAll(const QString& text) const
+{
+    QVector<Range> ranges;
+    if (!isValid()) {
+        return ranges;
+    }
+
+    if (m_options.useRegex) {
+        for (qsizetype lineStart = 0; lineStart <= text.size(); ) {
+            qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+            if (lineEnd < 0) {
+                lineEnd = text.size();
+            }
+            findInLine(QStringView(text).mid(lineStart, lineEnd - lineStart), ranges, static_cast<int>(lineStart));
+            lineStart = lineEnd + 1;
+        }
+        return ranges;
+    }
+
+    // A literal pattern holds no line break, so scanning the whole text
+    // at once finds the same matches
+    findLiteral(text, ranges, 0);
+    return ranges;
+}
+
+void TextSearch::findInLine(QStringView line, QVector<Range>& ranges, int offset) const
+{
+    if (!isValid()) {
+        return;
+    }
+    if (line.endsWith(QLatin1Char('\r'))) {
+        line.chop(1);
+    }
+
+    if (!m_options.useRegex) {
+        findLiteral(line, ranges, offset);
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    QRegularExpressionMatchIterator it = m_regex.globalMatchView(line);
+#else
+    QRegularExpressionMatchIterator it = m_regex.globalMatch(line);
+#endif
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        if (match.capturedLength() > 0) {
+            ranges.append({offset + static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength())});
+        }
+    }
+}
+
+void TextSearch::findLiteral(QStringView text, QVector<Range>& ranges, int offset) const
+{
+    const qsizetype length = m_pattern.size();
+    for (qsizetype from = 0; ; ) {
+        qsizetype start = m_matcher.indexIn(text, from);
+        if (start < 0) {
+            break;
+        }
+        if (m_options.wholeWord && !isWholeWord(text, start, length)) {
+            from = start + 1;
+            continue;
+        }
+        ranges.append({offset + static_cast<int>(start), static_cast<int>(length)});
+        from = start + length;
+    }
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,62 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringMatcher>
+#include <QVector>
+
+namespace XXMLStudio {
+
+/**
+ * Finds every occurrence of a search pattern in a text snapshot.
+ *
+ * Takes the same options as the find dialog. The pattern is compiled
+ * once on construction, so one TextSearch can scan any number of texts.
+ * Matches never overlap and empty regular expression matches are
+ * skipped, as with repeated QPlainTextEdit::find().
+ *
+ * Like QPlainTextEdit::find(), a match never spans lines: regular
+ * expressions run on one line at a time, so ^ and $ anchor at line
+ * boundaries and \s or [^x] cannot reach into the next line. A '\r'
+ * ending a line is not part of it.
+ */
+class TextSearch
+{
+public:
+    struct Options {
+        bool caseSensitive = false;
+        bool wholeWord = false;     // Ignored for regular expressions
+        bool useRegex = false;
+    };
+
+    struct Range {
+        int start = 0;
+        int length = 0;
+    };
+
+    TextSearch(const QString& pattern, const Options& options);
+
+    // False for an empty pattern or an invalid regular expression
+    bool isValid() const;
+    QString errorString() const;
+
+    // All matches in text, in order
+    QVector<Range> findAll(const QString& text) const;
+
+    // Matches in a single line without its terminator, appended to
+    // ranges with offset added to their start
+    void findInLine(QStringView line, QVector<Range>& ranges, int offset = 0) const;
+
+private:
+    void findLiteral(QStringView text, QVector<Range>& ranges, int offset) const;
+
+    QString m_pattern;
+    Options m_options;
+    QRegularExpression m_regex;
+    QStringMatcher m_matcher;
+};
+
+} // namespace XXMLStudio
+
+#endif // TEXTSEARCH_H
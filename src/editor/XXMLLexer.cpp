@@ -0,0 +1,759 @@
+#include "XXMLLexer.h"
+
+#include <QLatin1String>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <iterator>
+
+namespace XXMLStudio {
+
+namespace {
+
+// The rules of the former regex cascade, in the order they were applied.
+// Where matches overlap, the rule listed later wins. Consecutive rules
+// with the same format are folded into one entry.
+enum Rule : quint8 {
+    NoRule,
+    LowercaseIdentifier,    // \b[a-z]\w*\b
+    Keyword,                // \bNamespace\b, \bClass\b, ...
+    ConstructorKeyword,     // Constructor/Destructor after "[ " or an access modifier
+    BooleanLiteral,         // \b(true|false)\b
+    ThisKeyword,            // \bthis\b
+    FunctionType,           // \bF\s*\([^)]*\)\s*\([^)]*\)
+    TemplateInstantiation,  // \b[A-Z]\w*(?:@[A-Z]\w*)+
+    TemplateType,           // \b[A-Z]\w*<[^>]+>
+    OwnedType,              // \b[A-Z]\w*(?=[\^&%])
+    DeclaredType,           // (?<=(Types|Returns|Extends)\s{1,20})[A-Z]\w*
+    ScopeType,              // \b[A-Z]\w*(?=::)
+    ScopeMember,            // (?<=::)[A-Za-z]\w*
+    CallName,               // \b[a-z]\w*(?=\s*\()
+    RunVariable,            // (?<=Run\s)[a-z]\w*
+    RunType,                // (?<=Run\s)[A-Z]\w*
+    DoCall,                 // (?<=Do\s)[a-zA-Z_]\w*
+    Member,                 // (?<=\.)[a-zA-Z_]\w*
+    MemberCall,             // (?<=\.)[a-zA-Z_]\w*(?=\s*\()
+    ThisMember,             // (?<=this\.)[a-zA-Z_]\w*
+    ThisMemberCall,         // (?<=this\.)[a-zA-Z_]\w*(?=\s*\()
+    BoundVariable,          // (?<=(For|Let|Set)\s)[a-z]\w*
+    AsType,                 // (?<=As\s)[A-Z]\w*
+    InstantiateType,        // (?<=Instantiate\s)[A-Z]\w*
+    ConditionVariable,      // (?<=(If|While)\s)[a-z]\w*
+    Ownership,              // [\^&%]
+    SquareBracket,          // [\[\]]
+    Arrow,                  // ->
+    RangeOperator,          // \.\.
+    ScopeOperator,          // ::
+    DecimalNumber,          // \b[0-9]+\.?[0-9]*([eE][+-]?[0-9]+)?[fFdDlLuU]*\b
+    HexNumber,              // \b0[xX][0-9a-fA-F]+[uUlL]*\b
+    BinaryNumber,           // \b0[bB][01]+[uUlL]*\b
+    StringLiteral,          // "(?:[^"\\]|\\.)*"
+    CharLiteral,            // '(?:[^'\\]|\\.)'
+    ImportPath,             // (?<=#import\s)[A-Za-z_]\w*(?:::[A-Za-z_]\w*)*
+    ImportDirective,        // #import\b
+    LineComment,            // //[^\n]*
+    AngleBracket,           // [<>]
+    AngleVariable,          // (?<=<)[a-z]\w*(?=>)
+    AngleType,              // (?<=<)[A-Z]\w*(?:::[a-zA-Z_]\w*)*(?=>)
+    MethodName,             // (?<=Method\s<)[a-zA-Z_]\w*(?=>)
+    RuleCount
+};
+
+FormatType ruleFormat(Rule rule)
+{
+    switch (rule) {
+    case Keyword:
+    case ConstructorKeyword:
+    case BooleanLiteral:
+        return FormatType::Keyword;
+    case ThisKeyword:
+        return FormatType::This;
+    case FunctionType:
+    case TemplateType:
+    case OwnedType:
+    case DeclaredType:
+    case ScopeType:
+    case RunType:
+    case AsType:
+    case InstantiateType:
+    case AngleType:
+        return FormatType::Type;
+    case TemplateInstantiation:
+        return FormatType::TemplateInst;
+    case ScopeMember:
+    case CallName:
+    case DoCall:
+    case MemberCall:
+    case ThisMemberCall:
+    case MethodName:
+        return FormatType::MethodCall;
+    case Member:
+        return FormatType::Identifier;
+    case LowercaseIdentifier:
+    case RunVariable:
+    case ThisMember:
+    case BoundVariable:
+    case ConditionVariable:
+    case AngleVariable:
+        return FormatType::Variable;
+    case Ownership:
+        return FormatType::Ownership;
+    case SquareBracket:
+        return FormatType::Bracket;
+    case Arrow:
+    case RangeOperator:
+    case ScopeOperator:
+    case AngleBracket:
+        return FormatType::Operator;
+    case DecimalNumber:
+    case HexNumber:
+    case BinaryNumber:
+        return FormatType::Number;
+    case StringLiteral:
+    case CharLiteral:
+        return FormatType::String;
+    case ImportPath:
+        return FormatType::ImportPath;
+    case ImportDirective:
+        return FormatType::Import;
+    case LineComment:
+        return FormatType::Comment;
+    default:
+        return FormatType::Keyword;
+    }
+}
+
+// Note: Constructor and Destructor are NOT included here - they are only
+// keywords in declaration contexts (see ConstructorKeyword)
+const QLatin1String KEYWORDS[] = {
+    // Namespace and class declarations
+    QLatin1String("Namespace"), QLatin1String("Class"), QLatin1String("Structure"),
+    QLatin1String("Final"), QLatin1String("Extends"), QLatin1String("None"),
+    // Access modifiers
+    QLatin1String("Public"), QLatin1String("Private"), QLatin1String("Protected"), QLatin1String("Static"),
+    // Properties and types
+    QLatin1String("Property"), QLatin1String("Types"), QLatin1String("NativeType"), QLatin1String("NativeStructure"),
+    // Method declarations
+    QLatin1String("default"),
+    QLatin1String("Method"), QLatin1String("Returns"), QLatin1String("Parameters"), QLatin1String("Parameter"),
+    // Entry point and execution
+    QLatin1String("Entrypoint"), QLatin1String("Instantiate"), QLatin1String("Let"), QLatin1String("As"), QLatin1String("Run"),
+    // Control flow
+    QLatin1String("For"), QLatin1String("While"), QLatin1String("If"), QLatin1String("Else"),
+    QLatin1String("Exit"), QLatin1String("Return"), QLatin1String("Break"), QLatin1String("Continue"),
+    // Constraints and templates
+    QLatin1String("Constrains"), QLatin1String("Constraint"), QLatin1String("Require"),
+    QLatin1String("Truth"), QLatin1String("TypeOf"), QLatin1String("On"),
+    QLatin1String("Templates"), QLatin1String("Compiletime"),
+    QLatin1String("Do"), QLatin1String("Set"),
+    QLatin1String("Lambda"),
+    // Annotations
+    QLatin1String("Annotation"), QLatin1String("Annotate"), QLatin1String("Allows"),
+    QLatin1String("Processor"), QLatin1String("Retain"), QLatin1String("AnnotationAllow"),
+    // Memory alignment and callbacks
+    QLatin1String("Aligns"), QLatin1String("CallbackType"), QLatin1String("Convention"),
+    // Enumerations
+    QLatin1String("Enumeration"), QLatin1String("Value")
+};
+
+// Character classes match QRegularExpression's defaults (ASCII \w and \s)
+inline bool isWordChar(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '_';
+}
+
+inline bool isLower(QChar c) { return c.unicode() >= 'a' && c.unicode() <= 'z'; }
+inline bool isUpper(QChar c) { return c.unicode() >= 'A' && c.unicode() <= 'Z'; }
+inline bool isDigit(QChar c) { return c.unicode() >= '0' && c.unicode() <= '9'; }
+inline bool isIdentifierStart(QChar c) { return isLower(c) || isUpper(c) || c == QLatin1Char('_'); }
+
+inline bool isSpace(QChar c)
+{
+    ushort u = c.unicode();
+    return u == ' ' || (u >= '\t' && u <= '\r');
+}
+
+inline bool isHexDigit(QChar c)
+{
+    ushort u = c.unicode();
+    return isDigit(c) || (u >= 'a' && u <= 'f') || (u >= 'A' && u <= 'F');
+}
+
+inline bool isIntegerSuffix(QChar c)
+{
+    ushort u = c.unicode();
+    return u == 'u' || u == 'U' || u == 'l' || u == 'L';
+}
+
+inline bool isNumberSuffix(QChar c)
+{
+    ushort u = c.unicode();
+    return isIntegerSuffix(c) || u == 'f' || u == 'F' || u == 'd' || u == 'D';
+}
+
+bool isKeyword(QStringView word)
+{
+    // All keywords but "default" are capitalized
+    if (!isUpper(word.front()) && word != QLatin1String("default")) {
+        return false;
+    }
+    for (const QLatin1String& keyword : KEYWORDS) {
+        if (word == keyword) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * One line's worth of lexing state. Each rule records the end of its
+ * last match so that, like globalMatch, a rule never matches inside its
+ * own previous match; overlaps between rules resolve by rule order.
+ */
+class LineLexer
+{
+public:
+    LineLexer(QStringView text, bool skipSemanticRules)
+        : m_text(text)
+        , m_length(static_cast<int>(text.size()))
+        , m_ranks(m_length)
+        , m_skipSemanticRules(skipSemanticRules)
+    {
+        std::fill(m_ranks.begin(), m_ranks.end(), static_cast<quint8>(NoRule));
+        std::fill(std::begin(m_lastEnd), std::end(m_lastEnd), 0);
+    }
+
+    void run()
+    {
+        int i = 0;
+        while (i < m_length) {
+            if (isWordChar(m_text[i])) {
+                int end = wordEnd(i);
+                lexWord(i, end);
+                i = end;
+            } else {
+                lexSymbol(i);
+                ++i;
+            }
+        }
+    }
+
+    void appendSpans(QVector<XXMLLexer::Span>& spans) const
+    {
+        int i = 0;
+        while (i < m_length) {
+            if (m_ranks[i] == NoRule) {
+                ++i;
+                continue;
+            }
+
+            FormatType type = ruleFormat(static_cast<Rule>(m_ranks[i]));
+            int start = i;
+            while (i < m_length && m_ranks[i] != NoRule
+                   && ruleFormat(static_cast<Rule>(m_ranks[i])) == type) {
+                ++i;
+            }
+            spans.append({start, i - start, type});
+        }
+    }
+
+private:
+    QChar at(int i) const { return i >= 0 && i < m_length ? m_text[i] : QChar(); }
+
+    void mark(Rule rule, int start, int end)
+    {
+        if (start < m_lastEnd[rule]) {
+            return;
+        }
+        m_lastEnd[rule] = end;
+
+        if (m_skipSemanticRules && XXMLLexer::isSemanticFormat(ruleFormat(rule))) {
+            return;
+        }
+        for (int i = start; i < end; ++i) {
+            if (rule > m_ranks[i]) {
+                m_ranks[i] = rule;
+            }
+        }
+    }
+
+    // Every identifier rule starts at the beginning of a word: the ones
+    // without \b are anchored by a lookbehind ending in a non-word character
+    void lexWord(int start, int end)
+    {
+        QStringView word = m_text.mid(start, end - start);
+        QChar first = word.front();
+        QChar before = at(start - 1);
+        QChar after = at(end);
+        bool lower = isLower(first);
+        bool upper = isUpper(first);
+        bool identifierStart = isIdentifierStart(first);
+
+        if (lower) {
+            mark(LowercaseIdentifier, start, end);
+        }
+        if (isKeyword(word)) {
+            mark(Keyword, start, end);
+        }
+        if ((word == QLatin1String("Constructor") || word == QLatin1String("Destructor")) && isSpace(before)
+            && (at(start - 2) == QLatin1Char('[') || precededBy(start - 1, QLatin1String("Public"))
+                || precededBy(start - 1, QLatin1String("Private"))
+                || precededBy(start - 1, QLatin1String("Protected")))) {
+            mark(ConstructorKeyword, start, end);
+        }
+        if (word == QLatin1String("true") || word == QLatin1String("false")) {
+            mark(BooleanLiteral, start, end);
+        }
+        if (word == QLatin1String("this")) {
+            mark(ThisKeyword, start, end);
+        }
+        if (word == QLatin1String("F")) {
+            int typeEnd = functionTypeEnd(end);
+            if (typeEnd >= 0) {
+                mark(FunctionType, start, typeEnd);
+            }
+        }
+
+        if (upper) {
+            int p = end;
+            while (at(p) == QLatin1Char('@') && isUpper(at(p + 1))) {
+                p = wordEnd(p + 1);
+            }
+            if (p > end) {
+                mark(TemplateInstantiation, start, p);
+            }
+
+            if (after == QLatin1Char('<')) {
+                int close = static_cast<int>(m_text.indexOf(QLatin1Char('>'), end + 1));
+                if (close > end + 1) {
+                    mark(TemplateType, start, close + 1);
+                }
+            }
+
+            if (after == QLatin1Char('^') || after == QLatin1Char('&') || after == QLatin1Char('%')) {
+                mark(OwnedType, start, end);
+            }
+
+            int spaces = whitespaceBefore(start);
+            if (spaces >= 1 && spaces <= 20
+                && (precededBy(start - spaces, QLatin1String("Types"))
+                    || precededBy(start - spaces, QLatin1String("Returns"))
+                    || precededBy(start - spaces, QLatin1String("Extends")))) {
+                mark(DeclaredType, start, end);
+            }
+
+            if (after == QLatin1Char(':') && at(end + 1) == QLatin1Char(':')) {
+                mark(ScopeType, start, end);
+            }
+        }
+
+        if ((lower || upper) && before == QLatin1Char(':') && at(start - 2) == QLatin1Char(':')) {
+            mark(ScopeMember, start, end);
+        }
+
+        if (lower && followedByCall(end)) {
+            mark(CallName, start, end);
+        }
+
+        if (isSpace(before)) {
+            if (precededBy(start - 1, QLatin1String("Run"))) {
+                if (lower) {
+                    mark(RunVariable, start, end);
+                } else if (upper) {
+                    mark(RunType, start, end);
+                }
+            }
+            if (identifierStart && precededBy(start - 1, QLatin1String("Do"))) {
+                mark(DoCall, start, end);
+            }
+            if (lower && (precededBy(start - 1, QLatin1String("For"))
+                          || precededBy(start - 1, QLatin1String("Let"))
+                          || precededBy(start - 1, QLatin1String("Set")))) {
+                mark(BoundVariable, start, end);
+            }
+            if (upper && precededBy(start - 1, QLatin1String("As"))) {
+                mark(AsType, start, end);
+            }
+            if (upper && precededBy(start - 1, QLatin1String("Instantiate"))) {
+                mark(InstantiateType, start, end);
+            }
+            if (lower && (precededBy(start - 1, QLatin1String("If"))
+                          || precededBy(start - 1, QLatin1String("While")))) {
+                mark(ConditionVariable, start, end);
+            }
+            if (identifierStart && precededBy(start - 1, QLatin1String("#import"))) {
+                mark(ImportPath, start, scopedNameEnd(end));
+            }
+        }
+
+        if (identifierStart && before == QLatin1Char('.')) {
+            bool call = followedByCall(end);
+            mark(Member, start, end);
+            if (call) {
+                mark(MemberCall, start, end);
+            }
+            if (precededBy(start, QLatin1String("this."))) {
+                mark(ThisMember, start, end);
+                if (call) {
+                    mark(ThisMemberCall, start, end);
+                }
+            }
+        }
+
+        if (before == QLatin1Char('<')) {
+            if (lower && after == QLatin1Char('>')) {
+                mark(AngleVariable, start, end);
+            }
+            if (upper) {
+                int nameEnd = scopedNameEnd(end);
+                if (at(nameEnd) == QLatin1Char('>')) {
+                    mark(AngleType, start, nameEnd);
+                }
+            }
+            if (identifierStart && after == QLatin1Char('>') && isSpace(at(start - 2))
+                && precededBy(start - 2, QLatin1String("Method"))) {
+                mark(MethodName, start, end);
+            }
+        }
+
+        if (isDigit(first)) {
+            int numberEnd = decimalNumberEnd(start);
+            if (numberEnd >= 0) {
+                mark(DecimalNumber, start, numberEnd);
+            }
+
+            // Hex and binary literals must span the whole word to satisfy the trailing \b
+            if (first == QLatin1Char('0') && word.size() > 2) {
+                QChar radix = word[1];
+                bool hex = radix == QLatin1Char('x') || radix == QLatin1Char('X');
+                bool binary = radix == QLatin1Char('b') || radix == QLatin1Char('B');
+                if (hex || binary) {
+                    qsizetype i = 2;
+                    while (i < word.size() && (hex ? isHexDigit(word[i])
+                                                   : word[i] == QLatin1Char('0') || word[i] == QLatin1Char('1'))) {
+                        ++i;
+                    }
+                    bool hasDigits = i > 2;
+                    while (i < word.size() && isIntegerSuffix(word[i])) {
+                        ++i;
+                    }
+                    if (hasDigits && i == word.size()) {
+                        mark(hex ? HexNumber : BinaryNumber, start, end);
+                    }
+                }
+            }
+        }
+    }
+
+    void lexSymbol(int i)
+    {
+        switch (m_text[i].unicode()) {
+        case '^':
+        case '&':
+        case '%':
+            mark(Ownership, i, i + 1);
+            break;
+        case '[':
+        case ']':
+            mark(SquareBracket, i, i + 1);
+            break;
+        case '-':
+            if (at(i + 1) == QLatin1Char('>')) {
+                mark(Arrow, i, i + 2);
+            }
+            break;
+        case '.':
+            if (at(i + 1) == QLatin1Char('.')) {
+                mark(RangeOperator, i, i + 2);
+            }
+            break;
+        case ':':
+            if (at(i + 1) == QLatin1Char(':')) {
+                mark(ScopeOperator, i, i + 2);
+            }
+            break;
+        case '"':
+            if (i >= m_lastEnd[StringLiteral]) {
+                int end = stringLiteralEnd(i);
+                if (end >= 0) {
+                    mark(StringLiteral, i, end);
+                }
+            }
+            break;
+        case '\'': {
+            int end = charLiteralEnd(i);
+            if (end >= 0) {
+                mark(CharLiteral, i, end);
+            }
+            break;
+        }
+        case '#':
+            if (m_text.mid(i + 1).startsWith(QLatin1String("import")) && !isWordChar(at(i + 7))) {
+                mark(ImportDirective, i, i + 7);
+            }
+            break;
+        case '/':
+            if (at(i + 1) == QLatin1Char('/')) {
+                mark(LineComment, i, m_length);
+            }
+            break;
+        case '<':
+        case '>':
+            mark(AngleBracket, i, i + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    int wordEnd(int i) const
+    {
+        while (i < m_length && isWordChar(m_text[i])) {
+            ++i;
+        }
+        return i;
+    }
+
+    int skipSpaces(int i) const
+    {
+        while (i < m_length && isSpace(m_text[i])) {
+            ++i;
+        }
+        return i;
+    }
+
+    int whitespaceBefore(int pos) const
+    {
+        int count = 0;
+        while (isSpace(at(pos - 1 - count))) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Whether the text ending at pos is exactly word (no \b on its left)
+    bool precededBy(int pos, QLatin1String word) const
+    {
+        int start = pos - static_cast<int>(word.size());
+        return start >= 0 && m_text.mid(start, word.size()) == word;
+    }
+
+    bool isBoundary(int pos) const
+    {
+        return isWordChar(at(pos - 1)) != isWordChar(at(pos));
+    }
+
+    bool followedByCall(int pos) const
+    {
+        return at(skipSpaces(pos)) == QLatin1Char('(');
+    }
+
+    // Extends a name over any (::[A-Za-z_]\w*)* continuation
+    int scopedNameEnd(int pos) const
+    {
+        while (at(pos) == QLatin1Char(':') && at(pos + 1) == QLatin1Char(':') && isIdentifierStart(at(pos + 2))) {
+            pos = wordEnd(pos + 2);
+        }
+        return pos;
+    }
+
+    // F(params)(returns) after the "F" at wordEnd
+    int functionTypeEnd(int pos) const
+    {
+        pos = skipSpaces(pos);
+        if (at(pos) != QLatin1Char('(')) {
+            return -1;
+        }
+        int close = static_cast<int>(m_text.indexOf(QLatin1Char(')'), pos + 1));
+        if (close < 0) {
+            return -1;
+        }
+        pos = skipSpaces(close + 1);
+        if (at(pos) != QLatin1Char('(')) {
+            return -1;
+        }
+        close = static_cast<int>(m_text.indexOf(QLatin1Char(')'), pos + 1));
+        return close < 0 ? -1 : close + 1;
+    }
+
+    int stringLiteralEnd(int start) const
+    {
+        for (int i = start + 1; i < m_length; ++i) {
+            QChar c = m_text[i];
+            if (c == QLatin1Char('"')) {
+                return i + 1;
+            }
+            if (c == QLatin1Char('\\')) {
+                if (i + 1 >= m_length) {
+                    return -1;
+                }
+                ++i;
+            }
+        }
+        return -1;
+    }
+
+    int charLiteralEnd(int start) const
+    {
+        QChar c = at(start + 1);
+        if (c == QLatin1Char('\\')) {
+            return start + 2 < m_length && at(start + 3) == QLatin1Char('\'') ? start + 4 : -1;
+        }
+        if (start + 1 < m_length && c != QLatin1Char('\'') && at(start + 2) == QLatin1Char('\'')) {
+            return start + 3;
+        }
+        return -1;
+    }
+
+    // The decimal rule needs a \b after an optional '.', exponent and
+    // suffix, so candidate ends are tried in the regex's backtracking order
+    int decimalNumberEnd(int start) const
+    {
+        int digitsEnd = start;
+        while (isDigit(at(digitsEnd))) {
+            ++digitsEnd;
+        }
+
+        if (at(digitsEnd) == QLatin1Char('.')) {
+            int fractionEnd = digitsEnd + 1;
+            while (isDigit(at(fractionEnd))) {
+                ++fractionEnd;
+            }
+            for (int p = fractionEnd; p > digitsEnd; --p) {
+                int end = numberTailEnd(p);
+                if (end >= 0) {
+                    return end;
+                }
+            }
+        }
+
+        for (int p = digitsEnd; p > start; --p) {
+            int end = numberTailEnd(p);
+            if (end >= 0) {
+                return end;
+            }
+        }
+        return -1;
+    }
+
+    // ([eE][+-]?[0-9]+)?[fFdDlLuU]*\b from pos
+    int numberTailEnd(int pos) const
+    {
+        if (at(pos) == QLatin1Char('e') || at(pos) == QLatin1Char('E')) {
+            int digitsStart = pos + 1;
+            if (at(digitsStart) == QLatin1Char('+') || at(digitsStart) == QLatin1Char('-')) {
+                ++digitsStart;
+            }
+            int exponentEnd = digitsStart;
+            while (isDigit(at(exponentEnd))) {
+                ++exponentEnd;
+            }
+            for (int p = exponentEnd; p > digitsStart; --p) {
+                int end = suffixEnd(p);
+                if (end >= 0) {
+                    return end;
+                }
+            }
+        }
+        return suffixEnd(pos);
+    }
+
+    int suffixEnd(int pos) const
+    {
+        int end = pos;
+        while (isNumberSuffix(at(end))) {
+            ++end;
+        }
+        for (; end >= pos; --end) {
+            if (isBoundary(end)) {
+                return end;
+            }
+        }
+        return -1;
+    }
+
+    QStringView m_text;
+    int m_length;
+    QVarLengthArray<quint8, 512> m_ranks;
+    int m_lastEnd[RuleCount];
+    bool m_skipSemanticRules;
+};
+
+} // namespace
+
+void XXMLLexer::lexLine(QStringView text, bool skipSemanticRules, QVector<Span>& spans)
+{
+    LineLexer lexer(text, skipSemanticRules);
+    lexer.run();
+    lexer.appendSpans(spans);
+}
+
+int XXMLLexer::lexBlockComments(QStringView text, int previousState, QVector<Span>& spans)
+{
+    int state = Normal;
+    int length = static_cast<int>(text.size());
+
+    int start = previousState == InBlockComment
+        ? 0 : static_cast<int>(text.indexOf(QLatin1String("/*")));
+
+    while (start >= 0) {
+        // Searched from the opener itself, so "/*/" closes immediately
+        int end = static_cast<int>(text.indexOf(QLatin1String("*/"), start));
+        int commentLength;
+        if (end < 0) {
+            state = InBlockComment;
+            commentLength = length - start;
+        } else {
+            commentLength = end - start + 2;
+        }
+
+        spans.append({start, commentLength, FormatType::Comment});
+        start = static_cast<int>(text.indexOf(QLatin1String("/*"), start + commentLength));
+    }
+
+    return state;
+}
+
+void XXMLLexer::collectBrackets(QStringView text, const QVector<Span>& spans, QVector<Bracket>& brackets)
+{
+    int length = static_cast<int>(text.size());
+    QVarLengthArray<bool, 256> literal(length);
+    std::fill(literal.begin(), literal.end(), false);
+    for (const Span& span : spans) {
+        if (span.formatType == FormatType::String || span.formatType == FormatType::Comment) {
+            // Spans may run past a capped view of the line
+            int start = qBound(0, span.start, length);
+            int end = qBound(start, span.start + span.length, length);
+            std::fill(literal.begin() + start, literal.begin() + end, true);
+        }
+    }
+
+    for (int i = 0; i < length; ++i) {
+        char16_t ch = text[i].unicode();
+        switch (ch) {
+        case u'(': case u')': case u'[': case u']': case u'{': case u'}':
+            if (!literal[i]) {
+                brackets.append({i, ch});
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool XXMLLexer::isSemanticFormat(FormatType type)
+{
+    switch (type) {
+    case FormatType::Type:
+    case FormatType::TemplateInst:
+    case FormatType::MethodCall:
+    case FormatType::Identifier:
+    case FormatType::Variable:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,78 @@
+#ifndef XXMLLEXER_H
+#define XXMLLEXER_H
+
+#include <QStringView>
+#include <QVector>
+
+namespace XXMLStudio {
+
+/**
+ * Format types for syntax highlighting rules.
+ */
+enum class FormatType {
+    Keyword,
+    Type,
+    AngleBracketId,
+    String,
+    Comment,
+    Number,
+    Operator,
+    Bracket,
+    Ownership,
+    Import,
+    TemplateInst,
+    MethodCall,
+    Identifier,
+    Variable,
+    ImportPath,
+    This
+};
+
+/**
+ * Single-pass lexer behind XXMLSyntaxHighlighter.
+ *
+ * Classifies a line exactly like the cascade of regular expressions it
+ * replaces, where a later rule overrides the formats of earlier ones,
+ * but walks the text once instead of running a globalMatch per rule.
+ * Needs only QtCore so it can be benchmarked and verified headless.
+ */
+class XXMLLexer
+{
+public:
+    struct Span {
+        int start = 0;
+        int length = 0;
+        FormatType formatType = FormatType::Keyword;
+    };
+
+    // A bracket character in code, by position in its line
+    struct Bracket {
+        int position = 0;
+        char16_t ch = 0;
+    };
+
+    // Block states carried between lines
+    enum BlockState {
+        Normal = 0,
+        InBlockComment = 1
+    };
+
+    // Classifies one line, excluding /* */ comments, into non-overlapping
+    // spans. With skipSemanticRules the heuristics that guess an
+    // identifier's role are left out, for lines covered by semantic tokens.
+    static void lexLine(QStringView text, bool skipSemanticRules, QVector<Span>& spans);
+
+    // Appends the /* */ comment spans of a line and returns its end state
+    static int lexBlockComments(QStringView text, int previousState, QVector<Span>& spans);
+
+    // Appends the ()[]{} of a line that lie outside every String and
+    // Comment span, in order. The spans may overlap and come in any order.
+    static void collectBrackets(QStringView text, const QVector<Span>& spans, QVector<Bracket>& brackets);
+
+    // Whether a format comes from the identifier-role heuristics
+    static bool isSemanticFormat(FormatType type);
+};
+
+} // namespace XXMLStudio
+
+#endif // XXMLLEXER_H
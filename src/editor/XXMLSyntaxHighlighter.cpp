@@ -1,4 +1,11 @@
 #include "XXMLSyntaxHighlighter.h"
+#include "lsp/LSPProtocol.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <limits>
 
 namespace XXMLStudio {
 
@@ -6,7 +13,11 @@ XXMLSyntaxHighlighter::XXMLSyntaxHighlighter(QTextDocument* parent)
     : QSyntaxHighlighter(parent)
 {
     applyTheme();
-    setupRules();
+
+    m_pendingTimer = new QTimer(this);
+    m_pendingTimer->setSingleShot(true);
+    m_pendingTimer->setInterval(0);
+    connect(m_pendingTimer, &QTimer::timeout, this, &XXMLSyntaxHighlighter::processPendingBlocks);
 }
 
 void XXMLSyntaxHighlighter::setTheme(SyntaxTheme theme)
@@ -14,10 +25,99 @@ void XXMLSyntaxHighlighter::setTheme(SyntaxTheme theme)
     if (m_theme != theme) {
         m_theme = theme;
         applyTheme();
+        invalidateAllBlocks();
+    }
+}
+
+void XXMLSyntaxHighlighter::setMaxHighlightLength(int maxLength)
+{
+    if (m_maxHighlightLength != maxLength) {
+        m_maxHighlightLength = maxLength;
+        invalidateAllBlocks();
+    }
+}
+
+void XXMLSyntaxHighlighter::invalidateAllBlocks()
+{
+    if (defersOffscreenBlocks()) {
+        // Invalidate every block at once instead of relexing them all now
+        ++m_generation;
+        m_pendingFrom = 0;
+        highlightVisibleBlocks();
+        m_pendingTimer->start();
+    } else {
         rehighlight();
     }
 }
 
+void XXMLSyntaxHighlighter::setVisibleRange(int firstLine, int lastLine)
+{
+    m_visibleFirst = firstLine;
+    m_visibleLast = lastLine;
+    if (defersOffscreenBlocks()) {
+        highlightVisibleBlocks();
+    }
+}
+
+bool XXMLSyntaxHighlighter::defersOffscreenBlocks() const
+{
+    return document() && document()->blockCount() > DEFERRED_MIN_BLOCKS;
+}
+
+bool XXMLSyntaxHighlighter::isPending(const QTextBlock& block) const
+{
+    auto* data = static_cast<XXMLBlockData*>(block.userData());
+    return !data || data->generation != m_generation;
+}
+
+void XXMLSyntaxHighlighter::highlightVisibleBlocks()
+{
+    QTextDocument* doc = document();
+    if (!doc) return;
+
+    m_forceHighlight = true;
+    QTextBlock block = doc->findBlockByNumber(m_visibleFirst);
+    for (int line = m_visibleFirst; block.isValid() && line <= m_visibleLast; ++line) {
+        if (isPending(block)) {
+            rehighlightBlock(block);
+        }
+        block = block.next();
+    }
+    m_forceHighlight = false;
+}
+
+void XXMLSyntaxHighlighter::processPendingBlocks()
+{
+    QTextDocument* doc = document();
+    if (!doc) return;
+
+    QElapsedTimer slice;
+    slice.start();
+
+    m_forceHighlight = true;
+    QTextBlock block = doc->findBlockByNumber(m_pendingFrom);
+    int visited = 0;
+    while (block.isValid()) {
+        if (isPending(block)) {
+            rehighlightBlock(block);
+        }
+        block = block.next();
+
+        // Yield to the event loop regularly so typing and scrolling stay smooth
+        if (++visited % 32 == 0 && slice.elapsed() >= SLICE_MS) {
+            break;
+        }
+    }
+    m_forceHighlight = false;
+
+    if (block.isValid()) {
+        m_pendingFrom = block.blockNumber();
+        m_pendingTimer->start();
+    } else {
+        m_pendingFrom = std::numeric_limits<int>::max();
+    }
+}
+
 const QTextCharFormat& XXMLSyntaxHighlighter::formatFor(FormatType type) const
 {
     switch (type) {
@@ -203,327 +303,235 @@ void XXMLSyntaxHighlighter::applyTheme()
     }
 }
 
-void XXMLSyntaxHighlighter::setupRules()
+bool XXMLSyntaxHighlighter::semanticFormatFor(const QString& tokenType, FormatType& formatType)
 {
-    HighlightingRule rule;
-
-    // Variables: lowercase identifiers (general local variables)
-    // This is applied FIRST so that more specific rules (keywords, method calls) override it
-    rule.pattern = QRegularExpression("\\b[a-z][a-zA-Z0-9_]*\\b");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // XXML Keywords (from TokenType.h)
-    // Note: Constructor and Destructor are NOT included here - they are context-dependent
-    // They are keywords only in declaration contexts like [ Constructor default ]
-    // In expressions like String::Constructor, Constructor is a method name
-    QStringList keywordPatterns;
-    keywordPatterns
-        // Namespace and class declarations
-        << "\\bNamespace\\b" << "\\bClass\\b" << "\\bStructure\\b"
-        << "\\bFinal\\b" << "\\bExtends\\b" << "\\bNone\\b"
-        // Access modifiers
-        << "\\bPublic\\b" << "\\bPrivate\\b" << "\\bProtected\\b" << "\\bStatic\\b"
-        // Properties and types
-        << "\\bProperty\\b" << "\\bTypes\\b" << "\\bNativeType\\b" << "\\bNativeStructure\\b"
-        // Method declarations (not Constructor/Destructor - they're context-dependent)
-        << "\\bdefault\\b"
-        << "\\bMethod\\b" << "\\bReturns\\b" << "\\bParameters\\b" << "\\bParameter\\b"
-        // Entry point and execution
-        << "\\bEntrypoint\\b" << "\\bInstantiate\\b" << "\\bLet\\b" << "\\bAs\\b" << "\\bRun\\b"
-        // Control flow
-        << "\\bFor\\b" << "\\bWhile\\b" << "\\bIf\\b" << "\\bElse\\b"
-        << "\\bExit\\b" << "\\bReturn\\b" << "\\bBreak\\b" << "\\bContinue\\b"
-        // Constraints and templates
-        << "\\bConstrains\\b" << "\\bConstraint\\b" << "\\bRequire\\b"
-        << "\\bTruth\\b" << "\\bTypeOf\\b" << "\\bOn\\b"
-        << "\\bTemplates\\b" << "\\bCompiletime\\b"
-        // Do, Set (this is handled separately with unique color)
-        << "\\bDo\\b" << "\\bSet\\b"
-        // Lambda
-        << "\\bLambda\\b"
-        // Annotations
-        << "\\bAnnotation\\b" << "\\bAnnotate\\b" << "\\bAllows\\b"
-        << "\\bProcessor\\b" << "\\bRetain\\b" << "\\bAnnotationAllow\\b"
-        // Memory alignment and callbacks
-        << "\\bAligns\\b" << "\\bCallbackType\\b" << "\\bConvention\\b"
-        // Enumerations
-        << "\\bEnumeration\\b" << "\\bValue\\b";
-
-    for (const QString& pattern : keywordPatterns) {
-        rule.pattern = QRegularExpression(pattern);
-        rule.formatType = FormatType::Keyword;
-        m_rules.append(rule);
+    static const QHash<QString, FormatType> formats = {
+        {"namespace", FormatType::Type},
+        {"type", FormatType::Type},
+        {"class", FormatType::Type},
+        {"enum", FormatType::Type},
+        {"interface", FormatType::Type},
+        {"struct", FormatType::Type},
+        {"typeParameter", FormatType::Type},
+        {"parameter", FormatType::Variable},
+        {"variable", FormatType::Variable},
+        {"property", FormatType::Identifier},
+        {"enumMember", FormatType::Identifier},
+        {"function", FormatType::MethodCall},
+        {"method", FormatType::MethodCall},
+        {"keyword", FormatType::Keyword},
+        {"modifier", FormatType::Keyword},
+        {"comment", FormatType::Comment},
+        {"string", FormatType::String},
+        {"number", FormatType::Number},
+        {"operator", FormatType::Operator},
+        {"macro", FormatType::Import}
+    };
+
+    auto it = formats.constFind(tokenType);
+    if (it == formats.constEnd()) {
+        return false;
     }
+    formatType = *it;
+    return true;
+}
 
-    // Constructor and Destructor as keywords ONLY in declaration context
-    // Match after [ with optional whitespace (simple lookbehind)
-    rule.pattern = QRegularExpression("(?<=\\[\\s)(Constructor|Destructor)\\b");
-    rule.formatType = FormatType::Keyword;
-    m_rules.append(rule);
-
-    // Also match after access modifiers in declaration context
-    rule.pattern = QRegularExpression("(?<=(Public|Private|Protected)\\s)(Constructor|Destructor)\\b");
-    rule.formatType = FormatType::Keyword;
-    m_rules.append(rule);
-
-    // Boolean literals
-    rule.pattern = QRegularExpression("\\b(true|false)\\b");
-    rule.formatType = FormatType::Keyword;
-    m_rules.append(rule);
-
-    // 'this' keyword - unique blue color
-    rule.pattern = QRegularExpression("\\bthis\\b");
-    rule.formatType = FormatType::This;
-    m_rules.append(rule);
-
-    // Function type pattern: F(ReturnType)(ParamTypes)
-    rule.pattern = QRegularExpression("\\bF\\s*\\([^)]*\\)\\s*\\([^)]*\\)");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Template instantiation with @: Type@T or Type@T1@T2
-    rule.pattern = QRegularExpression("\\b[A-Z][a-zA-Z0-9_]*(?:@[A-Z][a-zA-Z0-9_]*)+");
-    rule.formatType = FormatType::TemplateInst;
-    m_rules.append(rule);
-
-    // Type names with template parameters: Type<T>
-    rule.pattern = QRegularExpression("\\b[A-Z][a-zA-Z0-9_]*<[^>]+>");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Standalone type names (capitalized identifiers) - only when followed by ownership or in type contexts
-    // This helps distinguish types from general identifiers
-    rule.pattern = QRegularExpression("\\b[A-Z][a-zA-Z0-9_]*(?=[\\^&%])");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Type after Types keyword
-    rule.pattern = QRegularExpression("(?<=Types\\s{1,20})[A-Z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Type after Returns keyword
-    rule.pattern = QRegularExpression("(?<=Returns\\s{1,20})[A-Z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Type after Extends keyword (but not None which is a keyword)
-    rule.pattern = QRegularExpression("(?<=Extends\\s{1,20})[A-Z][a-zA-Z0-9_]*(?!one)");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Qualified namespace/type access: Namespace::Type or Type::StaticMember
-    // The left part (before ::) should be highlighted as Type
-    rule.pattern = QRegularExpression("\\b[A-Z][a-zA-Z0-9_]*(?=::)");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Static method/member after :: (including Constructor/Destructor as method names)
-    // This captures the method name part after ::
-    rule.pattern = QRegularExpression("(?<=::)[A-Z][a-zA-Z0-9_]*|(?<=::)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // Instance method calls: identifier followed by ( - but only lowercase starting identifiers
-    rule.pattern = QRegularExpression("\\b[a-z][a-zA-Z0-9_]*(?=\\s*\\()");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // After Run keyword: if lowercase, it's a variable; if uppercase, it's a type
-    // Run varName.method() - varName is a variable
-    rule.pattern = QRegularExpression("(?<=Run\\s)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Run TypeName::method() - TypeName is a type
-    rule.pattern = QRegularExpression("(?<=Run\\s)[A-Z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Method calls after Do keyword: Do methodName
-    rule.pattern = QRegularExpression("(?<=Do\\s)[a-zA-Z_][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // Member access after . (dot operator) - general case for properties
-    rule.pattern = QRegularExpression("(?<=\\.)[a-zA-Z_][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Identifier;
-    m_rules.append(rule);
-
-    // Method calls after . (dot operator) - overrides above when followed by (
-    rule.pattern = QRegularExpression("(?<=\\.)[a-zA-Z_][a-zA-Z0-9_]*(?=\\s*\\()");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // Member access after this. - should be variable colored (overrides Identifier)
-    rule.pattern = QRegularExpression("(?<=this\\.)[a-zA-Z_][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Method calls after this. - still gold (overrides Variable when followed by ()
-    rule.pattern = QRegularExpression("(?<=this\\.)[a-zA-Z_][a-zA-Z0-9_]*(?=\\s*\\()");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // Variable after For keyword: For varName In ...
-    rule.pattern = QRegularExpression("(?<=For\\s)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Variable after Let keyword: Let varName = ...
-    rule.pattern = QRegularExpression("(?<=Let\\s)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Variable after Set keyword: Set varName = ...
-    rule.pattern = QRegularExpression("(?<=Set\\s)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Type after As keyword: ... As TypeName
-    rule.pattern = QRegularExpression("(?<=As\\s)[A-Z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Type after Instantiate keyword: Instantiate TypeName^ ...
-    rule.pattern = QRegularExpression("(?<=Instantiate\\s)[A-Z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Variable after If/While/Else keywords (condition variables)
-    rule.pattern = QRegularExpression("(?<=(If|While)\\s)[a-z][a-zA-Z0-9_]*");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Ownership markers: ^ (owned), & (reference), % (copy) after type names
-    rule.pattern = QRegularExpression("[\\^&%]");
-    rule.formatType = FormatType::Ownership;
-    m_rules.append(rule);
-
-    // Square brackets for declaration blocks
-    rule.pattern = QRegularExpression("[\\[\\]]");
-    rule.formatType = FormatType::Bracket;
-    m_rules.append(rule);
-
-    // Arrow operator: ->
-    rule.pattern = QRegularExpression("->");
-    rule.formatType = FormatType::Operator;
-    m_rules.append(rule);
-
-    // Range operator: ..
-    rule.pattern = QRegularExpression("\\.\\.");
-    rule.formatType = FormatType::Operator;
-    m_rules.append(rule);
-
-    // Scope resolution operator: ::
-    rule.pattern = QRegularExpression("::");
-    rule.formatType = FormatType::Operator;
-    m_rules.append(rule);
-
-    // Numbers (integers and floats)
-    rule.pattern = QRegularExpression("\\b[0-9]+\\.?[0-9]*([eE][+-]?[0-9]+)?[fFdDlLuU]*\\b");
-    rule.formatType = FormatType::Number;
-    m_rules.append(rule);
-
-    // Hexadecimal numbers
-    rule.pattern = QRegularExpression("\\b0[xX][0-9a-fA-F]+[uUlL]*\\b");
-    rule.formatType = FormatType::Number;
-    m_rules.append(rule);
-
-    // Binary numbers
-    rule.pattern = QRegularExpression("\\b0[bB][01]+[uUlL]*\\b");
-    rule.formatType = FormatType::Number;
-    m_rules.append(rule);
-
-    // String literals
-    rule.pattern = QRegularExpression("\"(?:[^\"\\\\]|\\\\.)*\"");
-    rule.formatType = FormatType::String;
-    m_rules.append(rule);
-
-    // Character literals
-    rule.pattern = QRegularExpression("'(?:[^'\\\\]|\\\\.)'");
-    rule.formatType = FormatType::String;
-    m_rules.append(rule);
-
-    // Import path (what comes after #import) - applied late to override Type/MethodCall rules
-    // Matches the path portion after #import (e.g., "Namespace::Type")
-    rule.pattern = QRegularExpression("(?<=#import\\s)[A-Za-z_][A-Za-z0-9_]*(?:::[A-Za-z_][A-Za-z0-9_]*)*");
-    rule.formatType = FormatType::ImportPath;
-    m_rules.append(rule);
-
-    // Import directive: #import
-    rule.pattern = QRegularExpression("#import\\b");
-    rule.formatType = FormatType::Import;
-    m_rules.append(rule);
-
-    // Single-line comments
-    rule.pattern = QRegularExpression("//[^\n]*");
-    rule.formatType = FormatType::Comment;
-    m_rules.append(rule);
-
-    // Angle brackets < > should ALWAYS be white - applied last to override other rules
-    rule.pattern = QRegularExpression("[<>]");
-    rule.formatType = FormatType::Operator;
-    m_rules.append(rule);
-
-    // Variable names inside angle brackets: <varName> - applied after < > rule
-    rule.pattern = QRegularExpression("(?<=<)[a-z][a-zA-Z0-9_]*(?=>)");
-    rule.formatType = FormatType::Variable;
-    m_rules.append(rule);
-
-    // Type names inside angle brackets: <TypeName>
-    rule.pattern = QRegularExpression("(?<=<)[A-Z][a-zA-Z0-9_]*(?:::[a-zA-Z_][a-zA-Z0-9_]*)*(?=>)");
-    rule.formatType = FormatType::Type;
-    m_rules.append(rule);
-
-    // Method names after Method keyword: Method <methodName>
-    rule.pattern = QRegularExpression("(?<=Method\\s<)[a-zA-Z_][a-zA-Z0-9_]*(?=>)");
-    rule.formatType = FormatType::MethodCall;
-    m_rules.append(rule);
-
-    // Multi-line comment markers
-    m_commentStartExpression = QRegularExpression("/\\*");
-    m_commentEndExpression = QRegularExpression("\\*/");
+void XXMLSyntaxHighlighter::setSemanticTokens(const QList<LSPSemanticToken>& tokens)
+{
+    QTextDocument* doc = document();
+    if (!doc) return;
+    setSemanticTokens(tokens, 0, doc->blockCount() - 1);
+}
+
+void XXMLSyntaxHighlighter::setSemanticTokens(const QList<LSPSemanticToken>& tokens, int firstLine, int lastLine)
+{
+    QTextDocument* doc = document();
+    if (!doc) return;
+
+    QHash<int, QVector<XXMLBlockData::SemanticRange>> rangesByLine;
+    for (const LSPSemanticToken& token : tokens) {
+        XXMLBlockData::SemanticRange range;
+        if (token.line < firstLine || token.line > lastLine
+            || !semanticFormatFor(token.type, range.formatType)) {
+            continue;
+        }
+        range.start = token.character;
+        range.length = token.length;
+        rangesByLine[token.line].append(range);
+    }
+
+    for (QTextBlock block = doc->findBlockByNumber(firstLine);
+         block.isValid() && block.blockNumber() <= lastLine;
+         block = block.next()) {
+        const QVector<XXMLBlockData::SemanticRange> ranges = rangesByLine.value(block.blockNumber());
+        size_t textHash = qHash(block.text());
+
+        auto* data = static_cast<XXMLBlockData*>(block.userData());
+        if (data && data->hasSemantic && data->textHash == textHash && data->semanticRanges == ranges) {
+            continue;  // Unchanged, keep the current formatting
+        }
+        if (!data) {
+            data = new XXMLBlockData();
+            block.setUserData(data);
+        }
+
+        data->semanticRanges = ranges;
+        data->hasSemantic = true;
+        data->textHash = textHash;
+        rehighlightBlock(block);
+    }
+}
+
+void XXMLSyntaxHighlighter::clearSemanticTokens()
+{
+    QTextDocument* doc = document();
+    if (!doc) return;
+
+    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
+        auto* data = static_cast<XXMLBlockData*>(block.userData());
+        if (data && data->hasSemantic) {
+            data->semanticRanges.clear();
+            data->hasSemantic = false;
+            rehighlightBlock(block);
+        }
+    }
 }
 
 void XXMLSyntaxHighlighter::highlightBlock(const QString& text)
 {
-    // Apply regular highlighting rules
-    for (const HighlightingRule& rule : m_rules) {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(match.capturedStart(), match.capturedLength(), formatFor(rule.formatType));
+    auto* data = static_cast<XXMLBlockData*>(currentBlockUserData());
+
+    if (defersOffscreenBlocks()) {
+        if (!data) {
+            data = new XXMLBlockData();
+            setCurrentBlockUserData(data);
+        }
+
+        int blockNumber = currentBlock().blockNumber();
+        if (!m_forceHighlight && (blockNumber < m_visibleFirst || blockNumber > m_visibleLast)) {
+            // Off screen: only carry the comment state forward, which keeps
+            // edits that open or close /* */ correct for the blocks below,
+            // and leave the full pass to processPendingBlocks()
+            data->generation = -1;
+            data->bracketsValid = false;
+            m_pendingFrom = qMin(m_pendingFrom, blockNumber);
+            if (!m_pendingTimer->isActive()) {
+                m_pendingTimer->start();
+            }
+
+            m_spans.clear();
+            setCurrentBlockState(XXMLLexer::lexBlockComments(text, previousBlockState(), m_spans));
+            for (const XXMLLexer::Span& span : m_spans) {
+                setFormat(span.start, span.length, m_commentFormat);
+            }
+            return;
         }
     }
+    if (data) {
+        data->generation = m_generation;
+    }
 
-    // Handle multi-line comments
-    setCurrentBlockState(0);
+    // Semantic ranges only apply to the exact text they were computed for;
+    // after an edit the line falls back to the lexer's heuristics until the
+    // server sends new tokens
+    bool semantic = data && data->hasSemantic && data->textHash == qHash(text);
 
-    int startIndex = 0;
-    if (previousBlockState() != 1) {
-        QRegularExpressionMatch startMatch = m_commentStartExpression.match(text);
-        startIndex = startMatch.hasMatch() ? startMatch.capturedStart() : -1;
+    QStringView lexed(text);
+    if (m_maxHighlightLength > 0) {
+        lexed = lexed.left(m_maxHighlightLength);
     }
 
-    while (startIndex >= 0) {
-        QRegularExpressionMatch endMatch = m_commentEndExpression.match(text, startIndex);
-        int endIndex = endMatch.hasMatch() ? endMatch.capturedStart() : -1;
-        int commentLength;
+    m_spans.clear();
+    XXMLLexer::lexLine(lexed, semantic, m_spans);
+    m_literalSpans.clear();
+    for (const XXMLLexer::Span& span : m_spans) {
+        setFormat(span.start, span.length, formatFor(span.formatType));
+        if (span.formatType == FormatType::String || span.formatType == FormatType::Comment) {
+            m_literalSpans.append(span);
+        }
+    }
 
-        if (endIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
-        } else {
-            commentLength = endIndex - startIndex + endMatch.capturedLength();
+    if (semantic) {
+        for (const XXMLBlockData::SemanticRange& range : data->semanticRanges) {
+            if (range.start < lexed.size()) {
+                setFormat(range.start, range.length, formatFor(range.formatType));
+            }
         }
+    }
 
-        setFormat(startIndex, commentLength, m_commentFormat);
+    // Multi-line comments override everything else
+    m_spans.clear();
+    setCurrentBlockState(XXMLLexer::lexBlockComments(text, previousBlockState(), m_spans));
+    for (const XXMLLexer::Span& span : m_spans) {
+        setFormat(span.start, span.length, m_commentFormat);
+    }
+
+    if (!data) {
+        data = new XXMLBlockData();
+        setCurrentBlockUserData(data);
+    }
+    m_literalSpans += m_spans;
+    // Past the cap nothing is lexed, so nothing is known to be code
+    updateBrackets(data, lexed, m_literalSpans);
+}
+
+int XXMLBlockData::bracketKind(char16_t ch)
+{
+    switch (ch) {
+    case u'(': case u')': return 0;
+    case u'[': case u']': return 1;
+    case u'{': case u'}': return 2;
+    default:              return -1;
+    }
+}
+
+void XXMLSyntaxHighlighter::updateBrackets(XXMLBlockData* data, QStringView text,
+                                           const QVector<XXMLLexer::Span>& spans)
+{
+    data->brackets.clear();
+    XXMLLexer::collectBrackets(text, spans, data->brackets);
+
+    for (XXMLBlockData::BracketSummary& summary : data->bracketSummary) {
+        summary = XXMLBlockData::BracketSummary();
+    }
+    for (const XXMLLexer::Bracket& bracket : data->brackets) {
+        XXMLBlockData::BracketSummary& summary = data->bracketSummary[XXMLBlockData::bracketKind(bracket.ch)];
+        summary.net += XXMLBlockData::isOpenBracket(bracket.ch) ? 1 : -1;
+        summary.minPrefix = qMin(summary.minPrefix, summary.net);
+    }
+    int reverse[3] = {0, 0, 0};
+    for (auto it = data->brackets.crbegin(); it != data->brackets.crend(); ++it) {
+        int kind = XXMLBlockData::bracketKind(it->ch);
+        reverse[kind] += XXMLBlockData::isOpenBracket(it->ch) ? -1 : 1;
+        data->bracketSummary[kind].minSuffix = qMin(data->bracketSummary[kind].minSuffix, reverse[kind]);
+    }
+    data->bracketsValid = true;
+}
+
+const XXMLBlockData* XXMLSyntaxHighlighter::bracketData(QTextBlock block)
+{
+    auto* data = static_cast<XXMLBlockData*>(block.userData());
+    if (data && data->bracketsValid) {
+        return data;
+    }
+
+    if (!data) {
+        data = new XXMLBlockData();
+        block.setUserData(data);
+    }
 
-        QRegularExpressionMatch nextStartMatch = m_commentStartExpression.match(text, startIndex + commentLength);
-        startIndex = nextStartMatch.hasMatch() ? nextStartMatch.capturedStart() : -1;
+    // The same classification highlightBlock() would make
+    QString text = block.text();
+    QStringView lexed(text);
+    if (m_maxHighlightLength > 0) {
+        lexed = lexed.left(m_maxHighlightLength);
     }
+    QVector<XXMLLexer::Span> spans;
+    XXMLLexer::lexLine(lexed, false, spans);
+    QTextBlock previous = block.previous();
+    XXMLLexer::lexBlockComments(text, previous.isValid() ? previous.userState() : XXMLLexer::Normal, spans);
+    updateBrackets(data, lexed, spans);
+    return data;
 }
 
 } // namespace XXMLStudio
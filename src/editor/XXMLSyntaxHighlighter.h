@@ -3,9 +3,12 @@
 
 #include <QSyntaxHighlighter>
 #include <QTextCharFormat>
-#include <QRegularExpression>
+#include <QTextBlockUserData>
+#include <QTimer>
 #include <QVector>
 
+#include "XXMLLexer.h"
+
 namespace XXMLStudio {
 
 /**
@@ -17,32 +20,60 @@ enum class SyntaxTheme {
     VSCodeDark    // Visual Studio Code Dark+ theme
 };
 
+struct LSPSemanticToken;
+
 /**
- * Format types for syntax highlighting rules.
+ * Per-block state kept by the highlighter: the semantic token ranges
+ * last received from the language server for this line, and a hash of
+ * the line's text when they were applied. Callers only pass tokens for
+ * the text the server saw, so the hash stops them being painted once
+ * the line is edited afterwards.
+ * It also records the line's code brackets with a per-kind summary that
+ * lets bracket matching step over the whole block without scanning it.
  */
-enum class FormatType {
-    Keyword,
-    Type,
-    AngleBracketId,
-    String,
-    Comment,
-    Number,
-    Operator,
-    Bracket,
-    Ownership,
-    Import,
-    TemplateInst,
-    MethodCall,
-    Identifier,
-    Variable,
-    ImportPath,
-    This
+class XXMLBlockData : public QTextBlockUserData
+{
+public:
+    struct SemanticRange {
+        int start = 0;
+        int length = 0;
+        FormatType formatType = FormatType::Identifier;
+
+        bool operator==(const SemanticRange& other) const {
+            return start == other.start && length == other.length && formatType == other.formatType;
+        }
+        bool operator!=(const SemanticRange& other) const { return !(*this == other); }
+    };
+
+    QVector<SemanticRange> semanticRanges;
+    bool hasSemantic = false;
+    size_t textHash = 0;
+
+    // Highlighter generation this block was last fully highlighted in,
+    // -1 while only its comment state is known
+    int generation = -1;
+
+    // Running depth of one bracket kind, +1 per opener and -1 per closer
+    struct BracketSummary {
+        int net = 0;        // Depth change over the whole block
+        int minPrefix = 0;  // Lowest depth reached scanning forward, <= 0
+        int minSuffix = 0;  // Lowest reverse depth (closers count up) scanning backward, <= 0
+    };
+
+    // Brackets outside strings and comments, valid once bracketsValid is set
+    QVector<XXMLLexer::Bracket> brackets;
+    BracketSummary bracketSummary[3];  // (), [], {}
+    bool bracketsValid = false;
+
+    // 0, 1 or 2 for the bracket kinds above, -1 for anything else
+    static int bracketKind(char16_t ch);
+    static bool isOpenBracket(char16_t ch) { return ch == u'(' || ch == u'[' || ch == u'{'; }
 };
 
 /**
  * Syntax highlighter for the XXML programming language.
  * Highlights keywords, types, strings, comments, and angle bracket identifiers.
- * Supports multiple color themes.
+ * Supports multiple color themes. Classification is done by XXMLLexer.
  */
 class XXMLSyntaxHighlighter : public QSyntaxHighlighter
 {
@@ -55,19 +86,55 @@ public:
     void setTheme(SyntaxTheme theme);
     SyntaxTheme theme() const { return m_theme; }
 
+    // Semantic tokens from the language server, computed for the
+    // document's current text. Lines covered by tokens drop the regex
+    // identifier heuristics; only changed blocks are rehighlighted.
+    void setSemanticTokens(const QList<LSPSemanticToken>& tokens);
+    void setSemanticTokens(const QList<LSPSemanticToken>& tokens, int firstLine, int lastLine);
+    void clearSemanticTokens();
+
+    // Bracket data for a block, lexed on the spot if the block has not
+    // been fully highlighted yet (deferred, or while the document loads)
+    const XXMLBlockData* bracketData(QTextBlock block);
+
+    // Large documents highlight the visible lines (0-based) first and the
+    // rest in time slices on the GUI thread
+    void setVisibleRange(int firstLine, int lastLine);
+
+    // Only the first maxLength characters of a line are lexed (0 for no
+    // limit), so a multi-megabyte line costs no more than a long one
+    void setMaxHighlightLength(int maxLength);
+
 protected:
     void highlightBlock(const QString& text) override;
 
 private:
-    void setupRules();
     void applyTheme();
     const QTextCharFormat& formatFor(FormatType type) const;
+    static bool semanticFormatFor(const QString& tokenType, FormatType& formatType);
+    static void updateBrackets(XXMLBlockData* data, QStringView text, const QVector<XXMLLexer::Span>& spans);
 
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        FormatType formatType;
-    };
-    QVector<HighlightingRule> m_rules;
+    void invalidateAllBlocks();
+    bool defersOffscreenBlocks() const;
+    bool isPending(const QTextBlock& block) const;
+    void highlightVisibleBlocks();
+    void processPendingBlocks();
+
+    // Reused between blocks to avoid reallocating
+    QVector<XXMLLexer::Span> m_spans;
+    QVector<XXMLLexer::Span> m_literalSpans;
+
+    // Background highlighting of large documents
+    QTimer* m_pendingTimer = nullptr;
+    int m_pendingFrom = 0;      // No pending block before this one
+    int m_generation = 0;       // Bumped when every block must be redone
+    int m_visibleFirst = 0;
+    int m_visibleLast = DEFAULT_VISIBLE_LINES;
+    bool m_forceHighlight = false;
+    int m_maxHighlightLength = 0;
+    static constexpr int DEFERRED_MIN_BLOCKS = 5000;
+    static constexpr int DEFAULT_VISIBLE_LINES = 200;
+    static constexpr int SLICE_MS = 8;
 
     // Text formats - updated by applyTheme()
     QTextCharFormat m_keywordFormat;
@@ -87,10 +154,6 @@ private:
     QTextCharFormat m_importPathFormat;
     QTextCharFormat m_thisFormat;
 
-    // Multi-line comment state
-    QRegularExpression m_commentStartExpression;
-    QRegularExpression m_commentEndExpression;
-
     // Current theme
     SyntaxTheme m_theme = SyntaxTheme::VSCodeDark;
 };
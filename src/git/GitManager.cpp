@@ -1,52 +1,56 @@
 #include "GitManager.h"
+#include "GitStatusParser.h"
+#include "../project/ProjectWatcher.h"
 
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QStandardPaths>
 #include <QRegularExpression>
+#include <QtConcurrent>
 #include <QDebug>
+#include <algorithm>
 
 namespace XXMLStudio {
 
-GitManager::GitManager(QObject* parent)
+GitManager::GitManager(ProjectWatcher* watcher, QObject* parent)
     : QObject(parent)
+    , m_projectWatcher(watcher)
 {
     m_gitExecutable = findGitExecutable();
     qDebug() << "[GitManager] Initialized with git executable:" << m_gitExecutable;
 
-    m_process = new QProcess(this);
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &GitManager::onProcessFinished);
-    connect(m_process, &QProcess::errorOccurred,
-            this, &GitManager::onProcessError);
-    connect(m_process, &QProcess::readyReadStandardOutput,
-            this, &GitManager::onReadyReadStdout);
-    connect(m_process, &QProcess::readyReadStandardError,
-            this, &GitManager::onReadyReadStderr);
+    m_statusParsePool.setMaxThreadCount(1);
 
     // Set environment to prevent git from prompting for credentials
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    env.insert("GIT_TERMINAL_PROMPT", "0");  // Disable terminal prompts
-    env.insert("GIT_ASKPASS", "");           // Disable askpass
-    env.insert("SSH_ASKPASS", "");           // Disable SSH askpass
-    m_process->setProcessEnvironment(env);
-
-    m_autoRefreshTimer = new QTimer(this);
-    connect(m_autoRefreshTimer, &QTimer::timeout,
-            this, &GitManager::onAutoRefreshTimer);
-
-    // Operation timeout timer
-    m_operationTimeout = new QTimer(this);
-    m_operationTimeout->setSingleShot(true);
-    connect(m_operationTimeout, &QTimer::timeout,
-            this, &GitManager::onOperationTimeout);
+    m_processEnvironment = QProcessEnvironment::systemEnvironment();
+    m_processEnvironment.insert("GIT_TERMINAL_PROMPT", "0");  // Disable terminal prompts
+    m_processEnvironment.insert("GIT_ASKPASS", "");           // Disable askpass
+    m_processEnvironment.insert("SSH_ASKPASS", "");           // Disable SSH askpass
+
+    // Status follows the work tree and the repository's own files
+    connect(m_projectWatcher, &ProjectWatcher::directoryChanged,
+            this, &GitManager::onWorkTreeChanged);
+    m_gitDirWatcher = new QFileSystemWatcher(this);
+    connect(m_gitDirWatcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        // HEAD, the index and refs are replaced by rename, which shows up
+        // here; any of them can change the status of every file
+        scheduleStatusRefresh();
+    });
+
+    m_statusDebounce = new QTimer(this);
+    m_statusDebounce->setSingleShot(true);
+    m_statusDebounce->setInterval(STATUS_DEBOUNCE_MS);
+    connect(m_statusDebounce, &QTimer::timeout, this, &GitManager::runScheduledRefresh);
 }
 
 GitManager::~GitManager()
 {
-    if (m_process->state() != QProcess::NotRunning) {
-        m_process->kill();
-        m_process->waitForFinished(1000);
+    m_pending.clear();
+    for (const Command& command : std::as_const(m_running)) {
+        command.process->disconnect(this);
+        command.process->kill();
+        command.process->waitForFinished(1000);
     }
 }
 
@@ -80,13 +84,28 @@ bool GitManager::detectGitRepository(const QString& path)
 {
     QDir dir(path);
     while (dir.exists()) {
-        if (dir.exists(".git")) {
+        QFileInfo dotGit(dir.filePath(".git"));
+        if (dotGit.exists()) {
+            m_workTreeRoot = dir.absolutePath();
+            m_gitDir = dotGit.absoluteFilePath();
+            if (dotGit.isFile()) {
+                // Linked worktrees and submodules: .git names the real directory
+                QFile file(dotGit.absoluteFilePath());
+                if (file.open(QIODevice::ReadOnly)) {
+                    QString line = QString::fromUtf8(file.readLine()).trimmed();
+                    if (line.startsWith("gitdir:")) {
+                        m_gitDir = QDir::cleanPath(dir.absoluteFilePath(line.mid(7).trimmed()));
+                    }
+                }
+            }
             return true;
         }
         if (!dir.cdUp()) {
             break;
         }
     }
+    m_workTreeRoot.clear();
+    m_gitDir.clear();
     return false;
 }
 
@@ -113,17 +132,12 @@ void GitManager::setRepositoryPath(const QString& path)
         emit repositoryChanged(m_isGitRepo);
     }
 
+    stopWatching();
     if (m_isGitRepo) {
-        // Start auto-refresh if enabled
-        if (m_autoRefreshEnabled) {
-            qDebug() << "[GitManager] Starting auto-refresh timer:" << m_autoRefreshInterval << "ms";
-            m_autoRefreshTimer->start(m_autoRefreshInterval);
-        }
+        startWatching();
         // Initial status refresh
         qDebug() << "[GitManager] Calling initial refreshStatus()";
         refreshStatus();
-    } else {
-        m_autoRefreshTimer->stop();
     }
 }
 
@@ -144,186 +158,453 @@ void GitManager::initRepository()
     executeCommand(args, Operation::Init);
 }
 
-void GitManager::setAutoRefresh(bool enabled, int intervalMs)
+void GitManager::setAutoRefresh(bool enabled)
 {
+    if (m_autoRefreshEnabled == enabled) {
+        return;
+    }
     m_autoRefreshEnabled = enabled;
-    m_autoRefreshInterval = intervalMs;
 
+    stopWatching();
     if (enabled && m_isGitRepo) {
-        m_autoRefreshTimer->start(intervalMs);
-    } else {
-        m_autoRefreshTimer->stop();
+        startWatching();
+        refreshStatus();    // Catch up on what happened unwatched
     }
 }
 
-void GitManager::onAutoRefreshTimer()
+void GitManager::notifyFilesChanged(const QStringList& paths)
 {
-    if (m_isGitRepo && m_currentOperation == Operation::None) {
-        refreshStatus();
+    if (!m_isGitRepo || !m_autoRefreshEnabled) {
+        return;
+    }
+    const QString rootPrefix = m_workTreeRoot + QLatin1Char('/');
+    for (const QString& path : paths) {
+        QString cleanPath = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+        if (cleanPath.startsWith(rootPrefix)) {
+            scheduleStatusRefresh(cleanPath);
+        }
     }
 }
 
-void GitManager::executeCommand(const QStringList& args, Operation operation, const QVariant& userData)
-{
-    qDebug() << "[GitManager] executeCommand: operation=" << static_cast<int>(operation)
-             << "args=" << args << "path=" << m_repoPath;
+// ============================================================================
+// File-System Watching
+// ============================================================================
 
-    if (m_process->state() != QProcess::NotRunning) {
-        qDebug() << "[GitManager] Process busy (state=" << m_process->state() << "), queueing command";
-        queueCommand(args, operation, userData);
+void GitManager::startWatching()
+{
+    if (!m_isGitRepo || !m_autoRefreshEnabled) {
         return;
     }
 
-    m_currentOperation = operation;
-    m_currentUserData = userData;
-    m_currentOutput.clear();
-    m_currentErrorOutput.clear();
+    // Linked worktrees keep HEAD and the index in their own git
+    // directory and everything else in the common one
+    QString commonDir = m_gitDir;
+    QFile commonDirFile(m_gitDir + "/commondir");
+    if (commonDirFile.open(QIODevice::ReadOnly)) {
+        commonDir = QDir::cleanPath(QDir(m_gitDir).absoluteFilePath(
+            QString::fromUtf8(commonDirFile.readAll()).trimmed()));
+    }
+
+    QStringList gitPaths = {m_gitDir, commonDir, commonDir + "/refs/heads", commonDir + "/refs/remotes"};
+    const QStringList remotes = QDir(commonDir + "/refs/remotes").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& remote : remotes) {
+        gitPaths.append(commonDir + "/refs/remotes/" + remote);
+    }
+    gitPaths.removeDuplicates();
+    gitPaths.erase(std::remove_if(gitPaths.begin(), gitPaths.end(), [](const QString& path) {
+        return !QFileInfo::exists(path);
+    }), gitPaths.end());
+    if (!gitPaths.isEmpty()) {
+        m_gitDirWatcher->addPaths(gitPaths);
+    }
+}
 
-    m_process->setWorkingDirectory(m_repoPath);
-    qDebug() << "[GitManager] Starting process:" << m_gitExecutable << args;
-    m_process->start(m_gitExecutable, args);
+void GitManager::stopWatching()
+{
+    m_statusDebounce->stop();
+    m_pendingPaths.clear();
+    m_pendingFullRefresh = false;
 
-    if (!m_process->waitForStarted(1000)) {
-        qDebug() << "[GitManager] ERROR: Failed to start process:" << m_process->errorString();
-        emit operationError(tr("Failed to start git: %1").arg(m_process->errorString()));
-        m_currentOperation = Operation::None;
-    } else {
-        qDebug() << "[GitManager] Process started successfully, PID:" << m_process->processId();
-        // Start timeout timer for network operations
-        if (operation == Operation::Push || operation == Operation::Pull ||
-            operation == Operation::Fetch || operation == Operation::AddRemote) {
-            m_operationTimeout->start(OPERATION_TIMEOUT_MS);
-        }
+    const QStringList gitPaths = m_gitDirWatcher->directories();
+    if (!gitPaths.isEmpty()) {
+        m_gitDirWatcher->removePaths(gitPaths);
     }
 }
 
-void GitManager::queueCommand(const QStringList& args, Operation operation, const QVariant& userData)
+void GitManager::onWorkTreeChanged(const QString& directory)
 {
-    QueuedCommand cmd;
-    cmd.operation = operation;
-    cmd.args = args;
-    cmd.userData = userData;
-    m_commandQueue.enqueue(cmd);
+    // New subdirectories are picked up by the watcher's next walk
+    if (!m_isGitRepo || !m_autoRefreshEnabled) {
+        return;
+    }
+    if (directory == m_workTreeRoot || directory.startsWith(m_workTreeRoot + QLatin1Char('/'))) {
+        scheduleStatusRefresh(directory);
+    }
 }
 
-void GitManager::processQueue()
+void GitManager::scheduleStatusRefresh(const QString& path)
 {
-    if (m_commandQueue.isEmpty()) {
-        qDebug() << "[GitManager] processQueue: queue is empty";
+    if (path.isEmpty()) {
+        m_pendingFullRefresh = true;
+    } else {
+        m_pendingPaths.insert(path);
+    }
+    // Not restarted by later changes, so a steady stream of them still
+    // gets refreshed every interval
+    if (!m_statusDebounce->isActive()) {
+        m_statusDebounce->start();
+    }
+}
+
+void GitManager::runScheduledRefresh()
+{
+    if (!m_isGitRepo) {
+        return;
+    }
+    if (m_pendingFullRefresh || m_pendingPaths.size() > MAX_SCOPED_PATHS) {
+        refreshStatus();
+        return;
+    }
+    if (m_pendingPaths.isEmpty()) {
         return;
     }
 
-    qDebug() << "[GitManager] processQueue: processing next command, queue size=" << m_commandQueue.size();
-    QueuedCommand cmd = m_commandQueue.dequeue();
-    executeCommand(cmd.args, cmd.operation, cmd.userData);
+    // Absolute pathspecs, taken literally; the scopes are the same
+    // paths relative to the work tree, as status reports them
+    QDir root(m_workTreeRoot);
+    QStringList args = {"--no-optional-locks", "--literal-pathspecs",
+                        "status", "--porcelain=v2", "-z", "--branch", "--untracked-files=all", "--"};
+    QStringList scopes;
+    for (const QString& path : std::as_const(m_pendingPaths)) {
+        QString relativePath = root.relativeFilePath(path);
+        if (relativePath.isEmpty() || relativePath == ".") {
+            refreshStatus();
+            return;
+        }
+        if (relativePath.startsWith("../")) {
+            continue;
+        }
+        scopes.append(relativePath);
+        args.append(path);
+    }
+    m_pendingPaths.clear();
+
+    if (!scopes.isEmpty()) {
+        executeCommand(args, Operation::Status, scopes);
+    }
+}
+
+// ============================================================================
+// Command Scheduling
+// ============================================================================
+
+GitManager::Lane GitManager::laneOf(Operation operation)
+{
+    switch (operation) {
+    case Operation::Fetch:
+    case Operation::Pull:
+    case Operation::Push:
+        return Lane::Network;
+    case Operation::Status:
+        return Lane::Status;
+    case Operation::Branches:
+    case Operation::Log:
+    case Operation::Diff:
+    case Operation::GetRemotes:
+        return Lane::Read;
+    default:
+        return Lane::Write;
+    }
 }
 
-void GitManager::onReadyReadStdout()
+int GitManager::priorityOf(Operation operation)
 {
-    m_currentOutput += QString::fromUtf8(m_process->readAllStandardOutput());
+    // Lower runs first when processes are scarce: what a view is
+    // waiting for, then what the user asked to change, then keeping
+    // the status current, then the network
+    switch (laneOf(operation)) {
+    case Lane::Read: return 0;
+    case Lane::Write: return 1;
+    case Lane::Status: return 2;
+    case Lane::Network: return 3;
+    }
+    return 3;
 }
 
-void GitManager::onReadyReadStderr()
+bool GitManager::canStart(Operation operation) const
 {
-    m_currentErrorOutput += QString::fromUtf8(m_process->readAllStandardError());
+    if (m_running.size() >= MAX_CONCURRENT_COMMANDS) {
+        return false;
+    }
+
+    int network = 0, writes = 0, statuses = 0, reads = 0;
+    bool pulling = false;
+    for (const Command& running : m_running) {
+        switch (laneOf(running.operation)) {
+        case Lane::Network: ++network; break;
+        case Lane::Write: ++writes; break;
+        case Lane::Status: ++statuses; break;
+        case Lane::Read: ++reads; break;
+        }
+        pulling |= running.operation == Operation::Pull;
+    }
+
+    switch (laneOf(operation)) {
+    case Lane::Network:
+        // A pull changes the work tree and index like any local write
+        return network == 0 && (operation != Operation::Pull || writes == 0);
+    case Lane::Write:
+        return writes == 0 && !pulling;
+    case Lane::Status:
+        // One at a time, so results arrive in the order they were taken
+        return statuses == 0;
+    case Lane::Read:
+        return reads < MAX_CONCURRENT_READS;
+    }
+    return false;
 }
 
-void GitManager::onProcessFinished(int exitCode, QProcess::ExitStatus status)
+GitManager::CommandId GitManager::executeCommand(const QStringList& args, Operation operation, const QVariant& userData)
 {
-    // Stop timeout timer
-    m_operationTimeout->stop();
+    qDebug() << "[GitManager] executeCommand: operation=" << static_cast<int>(operation)
+             << "args=" << args << "path=" << m_repoPath;
 
-    bool success = (status == QProcess::NormalExit && exitCode == 0);
-    qDebug() << "[GitManager] onProcessFinished: operation=" << static_cast<int>(m_currentOperation)
-             << "exitCode=" << exitCode << "exitStatus=" << status << "success=" << success;
-    qDebug() << "[GitManager] stdout:" << m_currentOutput.left(500);
-    if (!m_currentErrorOutput.isEmpty()) {
-        qDebug() << "[GitManager] stderr:" << m_currentErrorOutput;
+    if (operation == Operation::Status) {
+        // A full status covers every other; scoped ones waiting together
+        // are merged into one
+        const bool full = userData.toStringList().isEmpty();
+        for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+            if (it->operation != Operation::Status) {
+                ++it;
+            } else if (full) {
+                it = m_pending.erase(it);
+            } else if (it->userData.toStringList().isEmpty()) {
+                return it->id;
+            } else {
+                QStringList scopes = it->userData.toStringList() + userData.toStringList();
+                scopes.removeDuplicates();
+                if (scopes.size() > MAX_SCOPED_PATHS) {
+                    it->args = it->args.mid(0, it->args.indexOf("--"));
+                    it->userData = QVariant();
+                } else {
+                    it->args.append(args.mid(args.indexOf("--") + 1));
+                    it->args.removeDuplicates();
+                    it->userData = scopes;
+                }
+                return it->id;
+            }
+        }
+    } else if (operation == Operation::Log) {
+        // Only the latest history is shown
+        for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+            it = it->operation == Operation::Log ? m_pending.erase(it) : it + 1;
+        }
+        for (Command& running : m_running) {
+            if (running.operation == Operation::Log) {
+                running.superseded = true;
+                running.process->kill();
+            }
+        }
     }
 
-    Operation completedOp = m_currentOperation;
-    handleOperationResult(completedOp, exitCode, m_currentOutput, m_currentErrorOutput);
+    Command command;
+    command.id = m_nextCommandId++;
+    command.operation = operation;
+    command.args = args;
+    command.userData = userData;
 
-    qDebug() << "[GitManager] Operation" << static_cast<int>(completedOp) << "completed, queue size:" << m_commandQueue.size();
-    m_currentOperation = Operation::None;
-    m_currentUserData = QVariant();
+    // After the last command of the same or higher priority
+    const int priority = priorityOf(operation);
+    auto position = std::find_if(m_pending.begin(), m_pending.end(), [priority](const Command& pending) {
+        return priorityOf(pending.operation) > priority;
+    });
+    m_pending.insert(position, command);
 
-    processQueue();
+    startCommands();
+    return command.id;
 }
 
-void GitManager::onOperationTimeout()
+void GitManager::startCommands()
 {
-    qDebug() << "[GitManager] TIMEOUT: Operation" << static_cast<int>(m_currentOperation) << "timed out after" << OPERATION_TIMEOUT_MS << "ms";
+    for (auto it = m_pending.begin(); it != m_pending.end() && m_running.size() < MAX_CONCURRENT_COMMANDS; ) {
+        if (canStart(it->operation)) {
+            Command command = *it;
+            it = m_pending.erase(it);
+            startCommand(command);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void GitManager::startCommand(Command command)
+{
+    const CommandId id = command.id;
+    const bool network = laneOf(command.operation) == Lane::Network;
+
+    QProcess* process = new QProcess(this);
+    process->setProcessEnvironment(m_processEnvironment);
+    process->setWorkingDirectory(m_repoPath);
+    command.process = process;
+    if (command.operation == Operation::Status) {
+        command.statusParser = std::make_shared<GitStatusParser>();
+    }
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, id]() {
+        auto it = m_running.find(id);
+        if (it == m_running.end()) return;
+        readOutput(*it);
+        if (it->stallTimer) it->stallTimer->start();
+    });
+    connect(process, &QProcess::readyReadStandardError, this, [this, id, network]() {
+        auto it = m_running.find(id);
+        if (it == m_running.end()) return;
+        QByteArray chunk = it->process->readAllStandardError();
+        it->errorOutput += chunk;
+        if (!network) return;
+
+        it->stallTimer->start();
+        // --progress redraws its line with carriage returns; show the latest
+        const QList<QByteArray> lines = chunk.split('\r').last().split('\n');
+        for (auto line = lines.crbegin(); line != lines.crend(); ++line) {
+            QString message = QString::fromUtf8(line->trimmed());
+            if (!message.isEmpty()) {
+                emit operationProgress(message);
+                break;
+            }
+        }
+    });
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, id](int exitCode, QProcess::ExitStatus status) {
+        finishCommand(id, status == QProcess::NormalExit ? exitCode : -1);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+        // Every other error is followed by finished()
+        if (error != QProcess::FailedToStart) return;
+        auto it = m_running.find(id);
+        if (it == m_running.end()) return;
+        qDebug() << "[GitManager] ERROR: Failed to start process:" << it->process->errorString();
+        it->errorOutput = tr("Git failed to start. Please ensure Git is installed.").toUtf8();
+        finishCommand(id, -1);
+    });
+
+    if (network) {
+        // No overall limit: a large fetch may take long, but it keeps
+        // printing progress while it works
+        command.stallTimer = new QTimer(process);
+        command.stallTimer->setSingleShot(true);
+        command.stallTimer->setInterval(NETWORK_STALL_TIMEOUT_MS);
+        connect(command.stallTimer, &QTimer::timeout, this, [this, id]() {
+            auto it = m_running.find(id);
+            if (it == m_running.end()) return;
+            qDebug() << "[GitManager] STALLED: Operation" << static_cast<int>(it->operation)
+                     << "printed nothing for" << NETWORK_STALL_TIMEOUT_MS << "ms";
+            it->stalled = true;
+            it->process->kill();
+        });
+        command.stallTimer->start();
+    }
+
+    qDebug() << "[GitManager] Starting process:" << m_gitExecutable << command.args;
+    m_running.insert(id, command);
+    process->start(m_gitExecutable, command.args);
+}
 
-    if (m_process->state() != QProcess::NotRunning) {
-        m_process->kill();
-        m_process->waitForFinished(1000);
+void GitManager::readOutput(Command& command)
+{
+    QByteArray chunk = command.process->readAllStandardOutput();
+    if (chunk.isEmpty()) {
+        return;
     }
+    if (command.statusParser) {
+        QtConcurrent::run(&m_statusParsePool, [parser = command.statusParser, chunk]() {
+            parser->feed(chunk);
+        });
+    } else {
+        command.output += chunk;
+    }
+}
 
-    Operation timedOutOp = m_currentOperation;
-    QString errorMsg = tr("Operation timed out. This may indicate:\n"
-                          "- Network connectivity issues\n"
-                          "- Authentication required (set up SSH keys or credential helper)\n"
-                          "- Invalid remote URL");
+void GitManager::finishCommand(CommandId id, int exitCode)
+{
+    auto it = m_running.find(id);
+    if (it == m_running.end()) {
+        return;
+    }
+    Command command = *it;
+    m_running.erase(it);
+    readOutput(command);
+    command.process->disconnect(this);
+    command.process->deleteLater();
 
-    // Emit appropriate error signal based on operation
-    switch (timedOutOp) {
-    case Operation::Push:
-        emit pushCompleted(false, errorMsg);
-        break;
-    case Operation::Pull:
-        emit pullCompleted(false, errorMsg);
-        break;
-    case Operation::Fetch:
-        emit fetchCompleted(false, errorMsg);
-        break;
-    case Operation::AddRemote:
-        emit remoteAdded(false, m_currentUserData.toString(), errorMsg);
-        break;
-    default:
-        emit operationError(errorMsg);
-        break;
+    qDebug() << "[GitManager] Command finished: operation=" << static_cast<int>(command.operation)
+             << "exitCode=" << exitCode << "cancelled=" << command.cancelled;
+    if (!command.errorOutput.isEmpty()) {
+        qDebug() << "[GitManager] stderr:" << command.errorOutput;
     }
 
-    m_currentOperation = Operation::None;
-    m_currentUserData = QVariant();
-    processQueue();
+    if (command.stalled) {
+        command.errorOutput = tr("Operation stopped after %1 seconds without progress. This may indicate:\n"
+                                 "- Network connectivity issues\n"
+                                 "- Authentication required (set up SSH keys or credential helper)\n"
+                                 "- Invalid remote URL").arg(NETWORK_STALL_TIMEOUT_MS / 1000).toUtf8();
+    } else if (command.cancelled) {
+        command.errorOutput = tr("Cancelled").toUtf8();
+    }
+    if (!command.superseded) {
+        handleOperationResult(command, command.cancelled || command.stalled ? -1 : exitCode);
+    }
+
+    startCommands();
 }
 
-void GitManager::onProcessError(QProcess::ProcessError error)
+void GitManager::cancel(CommandId id)
 {
-    QString errorMessage;
-    switch (error) {
-    case QProcess::FailedToStart:
-        errorMessage = tr("Git failed to start. Please ensure Git is installed.");
-        break;
-    case QProcess::Crashed:
-        errorMessage = tr("Git process crashed.");
-        break;
-    case QProcess::Timedout:
-        errorMessage = tr("Git operation timed out.");
-        break;
-    case QProcess::WriteError:
-        errorMessage = tr("Error writing to Git process.");
-        break;
-    case QProcess::ReadError:
-        errorMessage = tr("Error reading from Git process.");
-        break;
-    default:
-        errorMessage = tr("Unknown Git error occurred.");
-        break;
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (it->id == id) {
+            Command command = *it;
+            m_pending.erase(it);
+            command.errorOutput = tr("Cancelled").toUtf8();
+            handleOperationResult(command, -1);
+            return;
+        }
     }
 
-    emit operationError(errorMessage);
-    m_currentOperation = Operation::None;
-    processQueue();
+    auto it = m_running.find(id);
+    if (it != m_running.end()) {
+        it->cancelled = true;
+        it->process->kill();    // finished() reports it
+    }
 }
 
-void GitManager::handleOperationResult(Operation op, int exitCode, const QString& output, const QString& errorOutput)
+void GitManager::cancelNetworkOperations()
+{
+    QList<CommandId> ids;
+    for (const Command& command : std::as_const(m_pending)) {
+        if (laneOf(command.operation) == Lane::Network) ids.append(command.id);
+    }
+    for (const Command& command : std::as_const(m_running)) {
+        if (laneOf(command.operation) == Lane::Network) ids.append(command.id);
+    }
+    for (CommandId id : std::as_const(ids)) {
+        cancel(id);
+    }
+}
+
+bool GitManager::isNetworkBusy() const
+{
+    auto isNetwork = [](const Command& command) { return laneOf(command.operation) == Lane::Network; };
+    return std::any_of(m_running.cbegin(), m_running.cend(), isNetwork)
+        || std::any_of(m_pending.cbegin(), m_pending.cend(), isNetwork);
+}
+
+void GitManager::handleOperationResult(const Command& command, int exitCode)
 {
     bool success = (exitCode == 0);
+    const QString output = QString::fromUtf8(command.output);
+    const QString errorOutput = QString::fromUtf8(command.errorOutput);
 
-    switch (op) {
+    switch (command.operation) {
     case Operation::Init: {
         emit initCompleted(success, success ? QString() : errorOutput);
         if (success) {
@@ -332,9 +613,7 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
             qDebug() << "[GitManager] Init successful, isGitRepo:" << m_isGitRepo;
             emit repositoryChanged(m_isGitRepo);
             if (m_isGitRepo) {
-                if (m_autoRefreshEnabled) {
-                    m_autoRefreshTimer->start(m_autoRefreshInterval);
-                }
+                startWatching();
                 // Queue all refresh operations to update the UI
                 refreshStatus();
                 getBranches();
@@ -345,21 +624,7 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
     }
     case Operation::Status: {
         if (success) {
-            m_cachedStatus = parseStatus(output);
-            qDebug() << "[GitManager] Parsed status - branch:" << m_cachedStatus.branch
-                     << "entries:" << m_cachedStatus.entries.size()
-                     << "ahead:" << m_cachedStatus.aheadCount
-                     << "behind:" << m_cachedStatus.behindCount;
-            // Update file status cache
-            m_fileStatusCache.clear();
-            for (const GitStatusEntry& entry : m_cachedStatus.entries) {
-                m_fileStatusCache[entry.path] = entry;
-                qDebug() << "[GitManager] File entry:" << entry.path
-                         << "index:" << static_cast<int>(entry.indexStatus)
-                         << "worktree:" << static_cast<int>(entry.workTreeStatus);
-            }
-            qDebug() << "[GitManager] Emitting statusRefreshed signal";
-            emit statusRefreshed(m_cachedStatus);
+            finishStatus(command);
         } else {
             qDebug() << "[GitManager] Status operation failed:" << errorOutput;
             emit operationError(tr("Failed to get status: %1").arg(errorOutput));
@@ -449,7 +714,7 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
         break;
     }
     case Operation::Checkout: {
-        QString branch = m_currentUserData.toString();
+        QString branch = command.userData.toString();
         emit branchCheckoutCompleted(success, branch, success ? QString() : errorOutput);
         if (success) {
             refreshStatus();
@@ -458,13 +723,13 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
         break;
     }
     case Operation::CreateBranch: {
-        QString branch = m_currentUserData.toString();
+        QString branch = command.userData.toString();
         emit branchCreated(success, branch, success ? QString() : errorOutput);
         if (success) getBranches();
         break;
     }
     case Operation::DeleteBranch: {
-        QString branch = m_currentUserData.toString();
+        QString branch = command.userData.toString();
         emit branchDeleted(success, branch, success ? QString() : errorOutput);
         if (success) getBranches();
         break;
@@ -493,7 +758,7 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
         break;
     }
     case Operation::AddRemote: {
-        QString remoteName = m_currentUserData.toString();
+        QString remoteName = command.userData.toString();
         qDebug() << "[GitManager] Add remote result: success=" << success << "remoteName=" << remoteName << "error=" << errorOutput;
         emit operationProgress(tr("Remote %1 added").arg(remoteName));
         emit remoteAdded(success, remoteName, success ? QString() : errorOutput);
@@ -502,7 +767,7 @@ void GitManager::handleOperationResult(Operation op, int exitCode, const QString
         break;
     }
     case Operation::RemoveRemote: {
-        QString remoteName = m_currentUserData.toString();
+        QString remoteName = command.userData.toString();
         emit remoteRemoved(success, remoteName, success ? QString() : errorOutput);
         if (success) getRemotes();
         break;
@@ -522,101 +787,88 @@ void GitManager::refreshStatus()
         return;
     }
 
-    // Use porcelain v2 format for detailed status
-    QStringList args = {"status", "--porcelain=v2", "--branch", "--untracked-files=all"};
+    // Whatever was waiting to be refreshed is covered by this
+    m_pendingPaths.clear();
+    m_pendingFullRefresh = false;
+
+    // Use porcelain v2 format for detailed status. No optional locks:
+    // status would otherwise rewrite the index, which the watcher
+    // would report as a change.
+    QStringList args = {"--no-optional-locks", "status", "--porcelain=v2", "-z", "--branch", "--untracked-files=all"};
     executeCommand(args, Operation::Status);
 }
 
-GitRepositoryStatus GitManager::parseStatus(const QString& output)
+void GitManager::mergeStatus(const GitRepositoryStatus& partial, const QStringList& scopes)
 {
-    GitRepositoryStatus status;
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-
-    for (const QString& line : lines) {
-        if (line.startsWith("# branch.head ")) {
-            status.branch = line.mid(14);
-            if (status.branch == "(detached)") {
-                status.detachedHead = true;
+    auto inScope = [&scopes](const QString& path) {
+        for (const QString& scope : scopes) {
+            if (path == scope || (path.startsWith(scope) && path.at(scope.size()) == QLatin1Char('/'))) {
+                return true;
             }
-        } else if (line.startsWith("# branch.upstream ")) {
-            status.upstream = line.mid(18);
-        } else if (line.startsWith("# branch.ab ")) {
-            // Parse ahead/behind: # branch.ab +1 -2
-            QRegularExpression re("\\+(-?\\d+)\\s+(-?\\d+)");
-            QRegularExpressionMatch match = re.match(line);
-            if (match.hasMatch()) {
-                status.aheadCount = match.captured(1).toInt();
-                status.behindCount = -match.captured(2).toInt();
-            }
-        } else if (line.startsWith("1 ") || line.startsWith("2 ")) {
-            // Ordinary or renamed/copied entry
-            // Format: 1 XY sub mH mI mW hH hI path
-            // or:     2 XY sub mH mI mW hH hI X path\torigPath
-            GitStatusEntry entry;
-            QStringList parts = line.split(' ');
-            if (parts.size() >= 9) {
-                QString xy = parts[1];
-                entry.indexStatus = parseStatusChar(xy[0]);
-                entry.workTreeStatus = parseStatusChar(xy[1]);
-
-                if (line.startsWith("2 ")) {
-                    // Renamed/copied - path contains tab separator
-                    QString pathPart = parts.mid(8).join(' ');
-                    int tabIndex = pathPart.indexOf('\t');
-                    if (tabIndex != -1) {
-                        entry.path = pathPart.left(tabIndex);
-                        entry.oldPath = pathPart.mid(tabIndex + 1);
-                    } else {
-                        entry.path = pathPart;
-                    }
-                } else {
-                    entry.path = parts.mid(8).join(' ');
-                }
-                status.entries.append(entry);
-            }
-        } else if (line.startsWith("u ")) {
-            // Unmerged entry
-            GitStatusEntry entry;
-            QStringList parts = line.split(' ');
-            if (parts.size() >= 11) {
-                entry.indexStatus = GitFileStatus::Conflicted;
-                entry.workTreeStatus = GitFileStatus::Conflicted;
-                entry.path = parts.mid(10).join(' ');
-                status.entries.append(entry);
-            }
-        } else if (line.startsWith("? ")) {
-            // Untracked
-            GitStatusEntry entry;
-            entry.indexStatus = GitFileStatus::Untracked;
-            entry.workTreeStatus = GitFileStatus::Untracked;
-            entry.path = line.mid(2);
-            status.entries.append(entry);
-        } else if (line.startsWith("! ")) {
-            // Ignored
-            GitStatusEntry entry;
-            entry.indexStatus = GitFileStatus::Ignored;
-            entry.workTreeStatus = GitFileStatus::Ignored;
-            entry.path = line.mid(2);
-            status.entries.append(entry);
+        }
+        return false;
+    };
+
+    // Branch information is always for the whole repository
+    QList<GitStatusEntry> entries = std::move(m_cachedStatus.entries);
+    m_cachedStatus = partial;
+    m_cachedStatus.entries.clear();
+    m_cachedStatus.entries.reserve(entries.size() + partial.entries.size());
+    for (GitStatusEntry& entry : entries) {
+        if (!inScope(entry.path)) {
+            m_cachedStatus.entries.append(std::move(entry));
         }
     }
+    m_cachedStatus.entries.append(partial.entries);
+}
+
+void GitManager::finishStatus(const Command& command)
+{
+    // Queued behind the last chunk of output on the parse thread
+    std::shared_ptr<GitStatusParser> parser = command.statusParser;
+    const QStringList scopes = command.userData.toStringList();
+    const QString repoPath = m_repoPath;
+
+    auto* watcher = new QFutureWatcher<GitRepositoryStatus>(this);
+    connect(watcher, &QFutureWatcher<GitRepositoryStatus>::finished, this, [this, watcher, scopes, repoPath]() {
+        watcher->deleteLater();
+        // The repository may have changed while the output was parsed
+        if (m_isGitRepo && repoPath == m_repoPath) {
+            applyStatus(watcher->result(), scopes);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&m_statusParsePool, [parser]() {
+        if (!parser->finish()) {
+            qDebug() << "[GitManager] Status output ended inside a record";
+        }
+        return parser->takeStatus();
+    }));
+}
 
-    return status;
+void GitManager::applyStatus(const GitRepositoryStatus& status, const QStringList& scopes)
+{
+    // Scoped refreshes carry the paths they covered
+    if (scopes.isEmpty()) {
+        m_cachedStatus = status;
+    } else {
+        mergeStatus(status, scopes);
+    }
+    qDebug() << "[GitManager] Parsed status - branch:" << m_cachedStatus.branch
+             << "entries:" << m_cachedStatus.entries.size()
+             << "scopes:" << scopes.size()
+             << "ahead:" << m_cachedStatus.aheadCount
+             << "behind:" << m_cachedStatus.behindCount;
+    rebuildFileStatusCache();
+    qDebug() << "[GitManager] Emitting statusRefreshed signal";
+    emit statusRefreshed(m_cachedStatus);
 }
 
-GitFileStatus GitManager::parseStatusChar(QChar c)
+void GitManager::rebuildFileStatusCache()
 {
-    switch (c.toLatin1()) {
-    case 'M': return GitFileStatus::Modified;
-    case 'T': return GitFileStatus::TypeChanged;
-    case 'A': return GitFileStatus::Added;
-    case 'D': return GitFileStatus::Deleted;
-    case 'R': return GitFileStatus::Renamed;
-    case 'C': return GitFileStatus::Copied;
-    case 'U': return GitFileStatus::Conflicted;
-    case '?': return GitFileStatus::Untracked;
-    case '!': return GitFileStatus::Ignored;
-    default: return GitFileStatus::Unmodified;
+    m_fileStatusCache.clear();
+    m_fileStatusCache.reserve(m_cachedStatus.entries.size());
+    for (const GitStatusEntry& entry : m_cachedStatus.entries) {
+        m_fileStatusCache[entry.path] = entry;
     }
 }
 
@@ -733,57 +985,57 @@ void GitManager::commitAmend(const QString& message)
 // Remote Operations
 // ============================================================================
 
-void GitManager::fetch(const QString& remote)
+GitManager::CommandId GitManager::fetch(const QString& remote)
 {
     if (!m_isGitRepo) {
-        return;
+        return 0;
     }
 
-    QStringList args = {"fetch", remote};
+    QStringList args = {"fetch", "--progress", remote};
     emit operationStarted(tr("Fetching from %1...").arg(remote));
-    executeCommand(args, Operation::Fetch);
+    return executeCommand(args, Operation::Fetch);
 }
 
-void GitManager::pull(const QString& remote, const QString& branch)
+GitManager::CommandId GitManager::pull(const QString& remote, const QString& branch)
 {
     if (!m_isGitRepo) {
-        return;
+        return 0;
     }
 
-    QStringList args = {"pull", remote};
+    QStringList args = {"pull", "--progress", remote};
     if (!branch.isEmpty()) {
         args << branch;
     }
     emit operationStarted(tr("Pulling from %1...").arg(remote));
-    executeCommand(args, Operation::Pull);
+    return executeCommand(args, Operation::Pull);
 }
 
-void GitManager::push(const QString& remote, const QString& branch)
+GitManager::CommandId GitManager::push(const QString& remote, const QString& branch)
 {
     qDebug() << "[GitManager] push() called - remote:" << remote << "branch:" << branch << "isGitRepo:" << m_isGitRepo;
 
     if (!m_isGitRepo) {
         qDebug() << "[GitManager] Not a git repo, returning";
-        return;
+        return 0;
     }
 
-    QStringList args = {"push", remote};
+    QStringList args = {"push", "--progress", remote};
     if (!branch.isEmpty()) {
         args << branch;
     }
     emit operationStarted(tr("Pushing to %1...").arg(remote));
-    executeCommand(args, Operation::Push);
+    return executeCommand(args, Operation::Push);
 }
 
-void GitManager::pushWithUpstream(const QString& remote, const QString& branch)
+GitManager::CommandId GitManager::pushWithUpstream(const QString& remote, const QString& branch)
 {
     if (!m_isGitRepo) {
-        return;
+        return 0;
     }
 
-    QStringList args = {"push", "-u", remote, branch};
+    QStringList args = {"push", "--progress", "-u", remote, branch};
     emit operationStarted(tr("Pushing to %1/%2...").arg(remote, branch));
-    executeCommand(args, Operation::Push);
+    return executeCommand(args, Operation::Push);
 }
 
 // ============================================================================
@@ -3,24 +3,51 @@
 
 #include <QObject>
 #include <QProcess>
-#include <QQueue>
+#include <QProcessEnvironment>
 #include <QTimer>
 #include <QHash>
+#include <QSet>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <memory>
 #include "GitTypes.h"
 
 namespace XXMLStudio {
 
+class GitStatusParser;
+class ProjectWatcher;
+
 /**
  * Central Git operations manager.
  * Handles all Git commands via QProcess with async signals.
- * Automatically watches for file changes and refreshes status.
+ *
+ * Status is refreshed from file-system notifications rather than on a
+ * timer: directory changes in the project come from its ProjectWatcher,
+ * and the git directory and its refs are watched here. Changes
+ * are collected for a moment and then refreshed with one
+ * `git status -- <paths>` whose result is merged into the cached
+ * status. Many changed paths, or a change to HEAD, the index or refs,
+ * refresh everything. With nothing changing, no git process runs.
+ *
+ * Commands run concurrently by class: one network operation (fetch,
+ * pull, push), one local write, one status and a couple of reads
+ * (log, diff, branches) at a time, so views never wait behind the
+ * network. Network operations have no fixed time limit; they report
+ * progress and are stopped only when they stall or are cancelled.
+ *
+ * Status output is parsed on a background thread while git is still
+ * writing it, so large untracked trees do not stall the GUI thread.
  */
 class GitManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit GitManager(QObject* parent = nullptr);
+    // Identifies a command to cancel(); 0 when nothing was started
+    using CommandId = quint64;
+
+    explicit GitManager(ProjectWatcher* watcher, QObject* parent = nullptr);
     ~GitManager();
 
     // Repository management
@@ -45,10 +72,10 @@ public:
     void commitAmend(const QString& message);
 
     // Remote operations
-    void fetch(const QString& remote = "origin");
-    void pull(const QString& remote = "origin", const QString& branch = QString());
-    void push(const QString& remote = "origin", const QString& branch = QString());
-    void pushWithUpstream(const QString& remote, const QString& branch);
+    CommandId fetch(const QString& remote = "origin");
+    CommandId pull(const QString& remote = "origin", const QString& branch = QString());
+    CommandId push(const QString& remote = "origin", const QString& branch = QString());
+    CommandId pushWithUpstream(const QString& remote, const QString& branch);
 
     // Remote management
     void getRemotes();
@@ -71,12 +98,22 @@ public:
     GitFileStatus fileIndexStatus(const QString& path) const;
     GitFileStatus fileWorkTreeStatus(const QString& path) const;
 
-    // Auto-refresh control
-    void setAutoRefresh(bool enabled, int intervalMs = 3000);
+    // Refresh status when files change (on by default)
+    void setAutoRefresh(bool enabled);
     bool isAutoRefreshEnabled() const { return m_autoRefreshEnabled; }
 
+    // Files the IDE has written. Rewriting a file in place does not
+    // change its directory, so watching directories alone misses it.
+    void notifyFilesChanged(const QStringList& paths);
+
     // Check if an operation is running
-    bool isBusy() const { return m_currentOperation != Operation::None; }
+    bool isBusy() const { return !m_running.isEmpty() || !m_pending.isEmpty(); }
+    bool isNetworkBusy() const;
+
+    // Stops a queued or running command; it completes with a
+    // "Cancelled" error
+    void cancel(CommandId id);
+    void cancelNetworkOperations();
 
 signals:
     // Status signals
@@ -117,12 +154,7 @@ signals:
     void operationError(const QString& error);
 
 private slots:
-    void onProcessFinished(int exitCode, QProcess::ExitStatus status);
-    void onProcessError(QProcess::ProcessError error);
-    void onReadyReadStdout();
-    void onReadyReadStderr();
-    void onAutoRefreshTimer();
-    void onOperationTimeout();
+    void onWorkTreeChanged(const QString& directory);
 
 private:
     enum class Operation {
@@ -147,46 +179,101 @@ private:
         RemoveRemote
     };
 
-    struct QueuedCommand {
-        Operation operation;
+    // Commands of one lane share its concurrency limit
+    enum class Lane {
+        Network,
+        Write,
+        Status,
+        Read
+    };
+
+    struct Command {
+        CommandId id = 0;
+        Operation operation = Operation::None;
         QStringList args;
         QVariant userData;
+        QProcess* process = nullptr;
+        QTimer* stallTimer = nullptr;
+        QByteArray output;
+        QByteArray errorOutput;
+        // Status output goes here instead of into output
+        std::shared_ptr<GitStatusParser> statusParser;
+        bool cancelled = false;
+        bool stalled = false;
+        // Replaced by a newer request; finishes without a signal
+        bool superseded = false;
     };
 
-    void executeCommand(const QStringList& args, Operation operation, const QVariant& userData = QVariant());
-    void queueCommand(const QStringList& args, Operation operation, const QVariant& userData = QVariant());
-    void processQueue();
-    void handleOperationResult(Operation op, int exitCode, const QString& output, const QString& errorOutput);
+    static Lane laneOf(Operation operation);
+    static int priorityOf(Operation operation);
+    bool canStart(Operation operation) const;
+
+    CommandId executeCommand(const QStringList& args, Operation operation, const QVariant& userData = QVariant());
+    void startCommands();
+    void startCommand(Command command);
+    void readOutput(Command& command);
+    void finishCommand(CommandId id, int exitCode);
+    void handleOperationResult(const Command& command, int exitCode);
 
     QString findGitExecutable();
+    // Finds the work tree root and git directory at or above path
     bool detectGitRepository(const QString& path);
 
+    // File-system watching
+    void startWatching();
+    void stopWatching();
+    void scheduleStatusRefresh(const QString& path = QString());
+    void runScheduledRefresh();
+    void mergeStatus(const GitRepositoryStatus& partial, const QStringList& scopes);
+    void rebuildFileStatusCache();
+
+    // Status results, applied in the order the commands finished
+    void finishStatus(const Command& command);
+    void applyStatus(const GitRepositoryStatus& status, const QStringList& scopes);
+
     // Parsing methods
-    GitRepositoryStatus parseStatus(const QString& output);
     QList<GitBranch> parseBranches(const QString& output);
     QList<GitCommit> parseLog(const QString& output);
-    GitFileStatus parseStatusChar(QChar c);
 
     QString m_gitExecutable;
     QString m_repoPath;
+    QString m_workTreeRoot;
+    QString m_gitDir;
     bool m_isGitRepo = false;
 
-    QProcess* m_process = nullptr;
-    Operation m_currentOperation = Operation::None;
-    QVariant m_currentUserData;
-    QString m_currentOutput;
-    QString m_currentErrorOutput;
-    QQueue<QueuedCommand> m_commandQueue;
+    QProcessEnvironment m_processEnvironment;
+    // Waiting commands by priority, then in order of request
+    QList<Command> m_pending;
+    QHash<CommandId, Command> m_running;
+    CommandId m_nextCommandId = 1;
+    // One thread, so chunks of status output are parsed in order
+    QThreadPool m_statusParsePool;
 
     GitRepositoryStatus m_cachedStatus;
     QHash<QString, GitStatusEntry> m_fileStatusCache;
 
-    QTimer* m_autoRefreshTimer = nullptr;
     bool m_autoRefreshEnabled = true;
-    int m_autoRefreshInterval = 3000;
-
-    QTimer* m_operationTimeout = nullptr;
-    static const int OPERATION_TIMEOUT_MS = 30000;  // 30 seconds for network operations
+    // Work tree changes come from the project's watcher, changes to
+    // HEAD, the index and refs from a watcher of our own
+    ProjectWatcher* m_projectWatcher = nullptr;
+    QFileSystemWatcher* m_gitDirWatcher = nullptr;
+
+    // Changes waiting for the debounce timer: absolute paths to refresh,
+    // or everything
+    QTimer* m_statusDebounce = nullptr;
+    QSet<QString> m_pendingPaths;
+    bool m_pendingFullRefresh = false;
+
+    // Editors and builds write in bursts
+    static constexpr int STATUS_DEBOUNCE_MS = 300;
+    // Beyond this, one full status is cheaper than a long pathspec
+    static constexpr int MAX_SCOPED_PATHS = 64;
+
+    static constexpr int MAX_CONCURRENT_COMMANDS = 4;
+    static constexpr int MAX_CONCURRENT_READS = 2;
+    // A network operation printing nothing for this long is assumed to
+    // be waiting on something that will not come, like a credential
+    static constexpr int NETWORK_STALL_TIMEOUT_MS = 120000;
 };
 
 } // namespace XXMLStudio
@@ -3,9 +3,34 @@
 #include <QFileInfo>
 #include <QColor>
 #include <QFont>
+#include <algorithm>
 
 namespace XXMLStudio {
 
+namespace {
+
+// Internal IDs: 1-3 for the section headers, 4-6 for the files of each
+// section. A file's row is the index's own row, so persistent indexes
+// stay valid as rows are inserted and removed around them.
+constexpr quintptr FIRST_CHILD_ID = static_cast<quintptr>(GitStatusModel::Section::SectionCount) + 1;
+
+quintptr childId(int section)
+{
+    return FIRST_CHILD_ID + section;
+}
+
+int childSection(quintptr id)
+{
+    return static_cast<int>(id - FIRST_CHILD_ID);
+}
+
+bool sameEntry(const GitStatusEntry& a, const GitStatusEntry& b)
+{
+    return a.indexStatus == b.indexStatus && a.workTreeStatus == b.workTreeStatus && a.oldPath == b.oldPath;
+}
+
+} // namespace
+
 GitStatusModel::GitStatusModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
@@ -39,9 +64,7 @@ QModelIndex GitStatusModel::index(int row, int column, const QModelIndex& parent
         }
 
         if (row >= 0 && row < count) {
-            // Store section in internal ID (0 = child of section 0, etc.)
-            // We use section * 10000 + row to encode both
-            return createIndex(row, column, quintptr((static_cast<int>(section) + 1) * 10000 + row));
+            return createIndex(row, column, childId(static_cast<int>(section)));
         }
     }
 
@@ -62,7 +85,7 @@ QModelIndex GitStatusModel::parent(const QModelIndex& child) const
     }
 
     // Otherwise it's a file entry - extract section from ID
-    int section = (id / 10000) - 1;
+    int section = childSection(id);
     if (section >= 0 && section < static_cast<int>(Section::SectionCount)) {
         return createIndex(section, 0, quintptr(section + 1));
     }
@@ -129,8 +152,8 @@ QVariant GitStatusModel::data(const QModelIndex& index, int role) const
     }
 
     // File entry
-    int section = (id / 10000) - 1;
-    int row = id % 10000;
+    int section = childSection(id);
+    int row = index.row();
 
     const QList<GitStatusEntry>* entries = nullptr;
     GitFileStatus displayStatus = GitFileStatus::Unmodified;
@@ -218,35 +241,81 @@ Qt::ItemFlags GitStatusModel::flags(const QModelIndex& index) const
 
 void GitStatusModel::setStatus(const GitRepositoryStatus& status)
 {
-    beginResetModel();
-
-    m_stagedEntries.clear();
-    m_unstagedEntries.clear();
-    m_untrackedEntries.clear();
+    QList<GitStatusEntry> staged;
+    QList<GitStatusEntry> unstaged;
+    QList<GitStatusEntry> untracked;
 
     for (const GitStatusEntry& entry : status.entries) {
         if (entry.isUntracked()) {
-            m_untrackedEntries.append(entry);
+            untracked.append(entry);
         } else {
             if (entry.isStaged()) {
-                m_stagedEntries.append(entry);
+                staged.append(entry);
             }
             if (entry.isUnstaged()) {
-                m_unstagedEntries.append(entry);
+                unstaged.append(entry);
             }
         }
     }
 
-    endResetModel();
+    updateSection(Section::Staged, m_stagedEntries, staged);
+    updateSection(Section::Unstaged, m_unstagedEntries, unstaged);
+    updateSection(Section::Untracked, m_untrackedEntries, untracked);
+}
+
+void GitStatusModel::updateSection(Section section, QList<GitStatusEntry>& entries, QList<GitStatusEntry> updated)
+{
+    // Both lists in path order, so one pass finds what came and went
+    auto byPath = [](const GitStatusEntry& a, const GitStatusEntry& b) { return a.path < b.path; };
+    std::sort(updated.begin(), updated.end(), byPath);
+
+    const QModelIndex parent = index(static_cast<int>(section), 0);
+    const int oldCount = entries.size();
+    int row = 0;
+    int next = 0;
+    while (row < entries.size() || next < updated.size()) {
+        if (next == updated.size() || (row < entries.size() && entries[row].path < updated[next].path)) {
+            // Gone: remove the run of rows before the next new path
+            int last = row;
+            while (last + 1 < entries.size() && (next == updated.size() || entries[last + 1].path < updated[next].path)) {
+                ++last;
+            }
+            beginRemoveRows(parent, row, last);
+            entries.remove(row, last - row + 1);
+            endRemoveRows();
+        } else if (row == entries.size() || updated[next].path < entries[row].path) {
+            // New: insert the run of entries before the next old path
+            int last = next;
+            while (last + 1 < updated.size() && (row == entries.size() || updated[last + 1].path < entries[row].path)) {
+                ++last;
+            }
+            beginInsertRows(parent, row, row + last - next);
+            for (int i = next; i <= last; ++i) {
+                entries.insert(row + i - next, updated[i]);
+            }
+            endInsertRows();
+            row += last - next + 1;
+            next = last + 1;
+        } else {
+            if (!sameEntry(entries[row], updated[next])) {
+                entries[row] = updated[next];
+                QModelIndex changed = index(row, 0, parent);
+                emit dataChanged(changed, changed);
+            }
+            ++row;
+            ++next;
+        }
+    }
+
+    // The header shows the count
+    if (entries.size() != oldCount) {
+        emit dataChanged(parent, parent, {Qt::DisplayRole});
+    }
 }
 
 void GitStatusModel::clear()
 {
-    beginResetModel();
-    m_stagedEntries.clear();
-    m_unstagedEntries.clear();
-    m_untrackedEntries.clear();
-    endResetModel();
+    setStatus(GitRepositoryStatus());
 }
 
 GitStatusEntry GitStatusModel::entryAt(const QModelIndex& index) const
@@ -256,8 +325,8 @@ GitStatusEntry GitStatusModel::entryAt(const QModelIndex& index) const
     }
 
     quintptr id = index.internalId();
-    int section = (id / 10000) - 1;
-    int row = id % 10000;
+    int section = childSection(id);
+    int row = index.row();
 
     switch (static_cast<Section>(section)) {
     case Section::Staged:
@@ -288,8 +357,7 @@ GitStatusModel::Section GitStatusModel::sectionAt(const QModelIndex& index) cons
         return static_cast<Section>(id - 1);
     }
 
-    int section = (id / 10000) - 1;
-    return static_cast<Section>(section);
+    return static_cast<Section>(childSection(id));
 }
 
 bool GitStatusModel::isHeader(const QModelIndex& index) const
@@ -17,6 +17,8 @@ namespace XXMLStudio {
  *     - file3.cpp
  *   - Untracked Files (N)
  *     - file4.txt
+ *
+ * Files are listed in path order within each section.
  */
 class GitStatusModel : public QAbstractItemModel
 {
@@ -67,6 +69,10 @@ public:
     QStringList pathsForIndices(const QModelIndexList& indices) const;
 
 private:
+    // Brings one section's rows to updated with row inserts, removals
+    // and changes, so selection and expansion survive a refresh
+    void updateSection(Section section, QList<GitStatusEntry>& entries, QList<GitStatusEntry> updated);
+
     QString sectionTitle(Section section) const;
     QIcon statusIcon(GitFileStatus status) const;
     QColor statusColor(GitFileStatus status) const;
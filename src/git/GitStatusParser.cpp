@@ -0,0 +1,204 @@
+#include "GitStatusParser.h"
+
+#include <cstring>
+
+namespace XXMLStudio {
+
+namespace {
+
+// Fields before the path of each record type:
+//   1 XY sub mH mI mW hH hI path
+//   2 XY sub mH mI mW hH hI Xscore path
+//   u XY sub m1 m2 m3 mW h1 h2 h3 path
+constexpr int ORDINARY_FIELDS = 8;
+constexpr int RENAMED_FIELDS = 9;
+constexpr int UNMERGED_FIELDS = 10;
+
+GitFileStatus statusFromChar(char c)
+{
+    switch (c) {
+    case 'M': return GitFileStatus::Modified;
+    case 'T': return GitFileStatus::TypeChanged;
+    case 'A': return GitFileStatus::Added;
+    case 'D': return GitFileStatus::Deleted;
+    case 'R': return GitFileStatus::Renamed;
+    case 'C': return GitFileStatus::Copied;
+    case 'U': return GitFileStatus::Conflicted;
+    case '?': return GitFileStatus::Untracked;
+    case '!': return GitFileStatus::Ignored;
+    default: return GitFileStatus::Unmodified;
+    }
+}
+
+// Position after the given number of space-separated fields, or nullptr
+// if the record has fewer
+const char* skipFields(const char* p, const char* end, int count)
+{
+    while (count-- > 0) {
+        p = static_cast<const char*>(std::memchr(p, ' ', end - p));
+        if (!p) {
+            return nullptr;
+        }
+        ++p;
+    }
+    return p;
+}
+
+bool startsWith(const char* begin, const char* end, const char* prefix, qsizetype length)
+{
+    return end - begin >= length && std::memcmp(begin, prefix, length) == 0;
+}
+
+// Signed decimal at p, advancing p past it
+int parseInt(const char*& p, const char* end)
+{
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    return negative ? -value : value;
+}
+
+QString decodePath(const char* begin, const char* end)
+{
+    return QString::fromUtf8(begin, end - begin);
+}
+
+} // namespace
+
+void GitStatusParser::feed(const char* data, qsizetype size)
+{
+    const char* p = data;
+    const char* end = data + size;
+
+    if (!m_partial.isEmpty()) {
+        const char* terminator = static_cast<const char*>(std::memchr(p, '\0', end - p));
+        if (!terminator) {
+            m_partial.append(p, end - p);
+            return;
+        }
+        m_partial.append(p, terminator - p);
+        parseRecord(m_partial.constData(), m_partial.constData() + m_partial.size());
+        m_partial.clear();
+        p = terminator + 1;
+    }
+
+    while (p < end) {
+        const char* terminator = static_cast<const char*>(std::memchr(p, '\0', end - p));
+        if (!terminator) {
+            m_partial.append(p, end - p);
+            return;
+        }
+        parseRecord(p, terminator);
+        p = terminator + 1;
+    }
+}
+
+bool GitStatusParser::finish()
+{
+    bool complete = m_partial.isEmpty() && !m_expectOriginalPath;
+    m_partial.clear();
+    m_expectOriginalPath = false;
+    return complete;
+}
+
+GitRepositoryStatus GitStatusParser::takeStatus()
+{
+    GitRepositoryStatus status = std::move(m_status);
+    m_status = GitRepositoryStatus();
+    return status;
+}
+
+GitRepositoryStatus GitStatusParser::parse(const QByteArray& output)
+{
+    GitStatusParser parser;
+    parser.feed(output);
+    parser.finish();
+    return parser.takeStatus();
+}
+
+void GitStatusParser::parseRecord(const char* begin, const char* end)
+{
+    if (m_expectOriginalPath) {
+        m_expectOriginalPath = false;
+        if (!m_status.entries.isEmpty()) {
+            m_status.entries.last().oldPath = decodePath(begin, end);
+        }
+        return;
+    }
+    if (end - begin < 2 || begin[1] != ' ') {
+        return;
+    }
+
+    GitStatusEntry entry;
+    const char* path = nullptr;
+    switch (begin[0]) {
+    case '#':
+        parseHeader(begin, end);
+        return;
+    case '1':
+    case '2':
+        if (end - begin < 4) {
+            return;
+        }
+        entry.indexStatus = statusFromChar(begin[2]);
+        entry.workTreeStatus = statusFromChar(begin[3]);
+        path = skipFields(begin, end, begin[0] == '1' ? ORDINARY_FIELDS : RENAMED_FIELDS);
+        m_expectOriginalPath = begin[0] == '2';
+        break;
+    case 'u':
+        entry.indexStatus = GitFileStatus::Conflicted;
+        entry.workTreeStatus = GitFileStatus::Conflicted;
+        path = skipFields(begin, end, UNMERGED_FIELDS);
+        break;
+    case '?':
+        entry.indexStatus = GitFileStatus::Untracked;
+        entry.workTreeStatus = GitFileStatus::Untracked;
+        path = begin + 2;
+        break;
+    case '!':
+        entry.indexStatus = GitFileStatus::Ignored;
+        entry.workTreeStatus = GitFileStatus::Ignored;
+        path = begin + 2;
+        break;
+    default:
+        return;
+    }
+
+    if (!path) {
+        m_expectOriginalPath = false;
+        return;
+    }
+    entry.path = decodePath(path, end);
+    m_status.entries.append(std::move(entry));
+}
+
+void GitStatusParser::parseHeader(const char* begin, const char* end)
+{
+    static const char HEAD[] = "# branch.head ";
+    static const char UPSTREAM[] = "# branch.upstream ";
+    static const char AHEAD_BEHIND[] = "# branch.ab ";
+
+    if (startsWith(begin, end, HEAD, sizeof(HEAD) - 1)) {
+        m_status.branch = QString::fromUtf8(begin + sizeof(HEAD) - 1, end - begin - (sizeof(HEAD) - 1));
+        m_status.detachedHead = m_status.branch == QLatin1String("(detached)");
+    } else if (startsWith(begin, end, UPSTREAM, sizeof(UPSTREAM) - 1)) {
+        m_status.upstream = QString::fromUtf8(begin + sizeof(UPSTREAM) - 1, end - begin - (sizeof(UPSTREAM) - 1));
+    } else if (startsWith(begin, end, AHEAD_BEHIND, sizeof(AHEAD_BEHIND) - 1)) {
+        // # branch.ab +<ahead> -<behind>
+        const char* p = begin + sizeof(AHEAD_BEHIND) - 1;
+        m_status.aheadCount = parseInt(p, end);
+        if (p < end && *p == ' ') {
+            ++p;
+        }
+        m_status.behindCount = -parseInt(p, end);
+    }
+}
+
+} // namespace XXMLStudio
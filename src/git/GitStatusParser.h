@@ -0,0 +1,50 @@
+#ifndef GITSTATUSPARSER_H
+#define GITSTATUSPARSER_H
+
+#include <QByteArray>
+#include "GitTypes.h"
+
+namespace XXMLStudio {
+
+/**
+ * Incremental parser for `git status --porcelain=v2 --branch -z`.
+ *
+ * Output is fed in chunks as it arrives from the process. Records are
+ * NUL-terminated, so each complete record is parsed directly from the
+ * chunk and only a record split across chunks is copied. Paths are
+ * decoded as UTF-8 exactly as git wrote them; with -z git neither
+ * quotes nor escapes them, so spaces, tabs and newlines survive.
+ *
+ * Not thread-safe; one thread feeds a parser at a time.
+ */
+class GitStatusParser
+{
+public:
+    void feed(const char* data, qsizetype size);
+    void feed(const QByteArray& data) { feed(data.constData(), data.size()); }
+
+    // Call once the output has ended. Returns false if it stopped
+    // partway through a record, which is then dropped.
+    bool finish();
+
+    GitRepositoryStatus takeStatus();
+    int entryCount() const { return m_status.entries.size(); }
+
+    // Parses complete output in one go
+    static GitRepositoryStatus parse(const QByteArray& output);
+
+private:
+    void parseRecord(const char* begin, const char* end);
+    void parseHeader(const char* begin, const char* end);
+
+    GitRepositoryStatus m_status;
+    // The start of a record whose terminator has not arrived yet
+    QByteArray m_partial;
+    // A rename or copy record is followed by its original path as a
+    // record of its own
+    bool m_expectOriginalPath = false;
+};
+
+} // namespace XXMLStudio
+
+#endif // GITSTATUSPARSER_H
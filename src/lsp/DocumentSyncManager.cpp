@@ -18,7 +18,9 @@ DocumentSyncManager::DocumentSyncManager(LSPClient* client, QObject* parent)
 DocumentSyncManager::~DocumentSyncManager()
 {
     // Flush any pending changes before destruction
-    flushPendingChanges();
+    if (m_client) {
+        flushPendingChanges();
+    }
 }
 
 void DocumentSyncManager::openDocument(const QString& filePath, const QString& text)
@@ -74,6 +76,25 @@ void DocumentSyncManager::documentChanged(const QString& filePath, const QString
     m_debounceTimer->start(m_debounceDelay);
 }
 
+void DocumentSyncManager::documentEdited(const QString& filePath, const LSPTextChange& change)
+{
+    if (!m_documents.contains(filePath)) {
+        return;
+    }
+
+    DocumentState& state = m_documents[filePath];
+
+    if (!change.range) {
+        // Full content replaces everything queued before it
+        state.pendingEdits = {change};
+    } else if (state.pendingEdits.isEmpty() || !coalesce(state.pendingEdits.last(), change)) {
+        state.pendingEdits.append(change);
+    }
+
+    // Restart debounce timer
+    m_debounceTimer->start(m_debounceDelay);
+}
+
 void DocumentSyncManager::documentSaved(const QString& filePath, const QString& text)
 {
     if (!m_documents.contains(filePath)) {
@@ -81,15 +102,17 @@ void DocumentSyncManager::documentSaved(const QString& filePath, const QString&
     }
 
     // Flush any pending changes first
-    if (m_documents[filePath].hasPendingChanges) {
-        DocumentState& state = m_documents[filePath];
-        state.version++;
-        m_client->changeDocument(state.uri, state.version, state.pendingText);
-        state.hasPendingChanges = false;
-    }
+    DocumentState& state = m_documents[filePath];
+    flushState(state);
 
-    QString uri = m_documents[filePath].uri;
-    m_client->saveDocument(uri, text);
+    m_client->saveDocument(state.uri, text);
+}
+
+void DocumentSyncManager::flushDocument(const QString& filePath)
+{
+    if (m_documents.contains(filePath) && flushState(m_documents[filePath])) {
+        emit changesSent(filePath, m_documents[filePath].version);
+    }
 }
 
 int DocumentSyncManager::documentVersion(const QString& filePath) const
@@ -100,18 +123,95 @@ int DocumentSyncManager::documentVersion(const QString& filePath) const
     return 0;
 }
 
+bool DocumentSyncManager::hasPendingChanges(const QString& filePath) const
+{
+    auto it = m_documents.constFind(filePath);
+    return it != m_documents.constEnd() && (it->hasPendingChanges || !it->pendingEdits.isEmpty());
+}
+
 void DocumentSyncManager::flushPendingChanges()
 {
+    QStringList flushed;
     for (auto it = m_documents.begin(); it != m_documents.end(); ++it) {
-        DocumentState& state = it.value();
+        if (flushState(it.value())) {
+            flushed.append(it.key());
+        }
+    }
+
+    for (const QString& filePath : flushed) {
+        emit changesSent(filePath, m_documents[filePath].version);
+    }
+}
+
+bool DocumentSyncManager::flushState(DocumentState& state)
+{
+    if (!state.hasPendingChanges && state.pendingEdits.isEmpty()) {
+        return false;
+    }
+
+    if (state.hasPendingChanges) {
+        state.version++;
+        m_client->changeDocument(state.uri, state.version, state.pendingText);
+        state.hasPendingChanges = false;
+        state.pendingText.clear();
+    }
+
+    if (!state.pendingEdits.isEmpty()) {
+        state.version++;
+        m_client->changeDocument(state.uri, state.version, state.pendingEdits);
+        state.pendingEdits.clear();
+    }
+    return true;
+}
+
+static LSPPosition endOfInsertedText(const LSPPosition& start, const QString& text)
+{
+    int newlines = text.count(QLatin1Char('\n'));
+    if (newlines == 0) {
+        return {start.line, start.character + static_cast<int>(text.size())};
+    }
+    return {start.line + newlines, static_cast<int>(text.size() - text.lastIndexOf(QLatin1Char('\n')) - 1)};
+}
+
+static bool samePosition(const LSPPosition& a, const LSPPosition& b)
+{
+    return a.line == b.line && a.character == b.character;
+}
 
-        if (state.hasPendingChanges) {
-            state.version++;
-            m_client->changeDocument(state.uri, state.version, state.pendingText);
-            state.hasPendingChanges = false;
-            state.pendingText.clear();
+bool DocumentSyncManager::coalesce(LSPTextChange& last, const LSPTextChange& change)
+{
+    if (!last.range || !change.range) {
+        return false;
+    }
+
+    const LSPRange& range = *change.range;
+    LSPPosition insertedEnd = endOfInsertedText(last.range->start, last.text);
+
+    // Typing: insertion right after the previously inserted text
+    if (samePosition(range.start, range.end) && samePosition(range.start, insertedEnd)) {
+        last.text += change.text;
+        return true;
+    }
+
+    // Backspace over text that was inserted by the previous change
+    if (change.text.isEmpty() && range.start.line == range.end.line
+        && samePosition(range.end, insertedEnd)) {
+        int removed = range.end.character - range.start.character;
+        int lineStart = last.text.lastIndexOf(QLatin1Char('\n')) + 1;
+        if (removed <= last.text.size() - lineStart) {
+            last.text.chop(removed);
+            return true;
         }
     }
+
+    // Backspace extending a previous deletion
+    if (change.text.isEmpty() && last.text.isEmpty()
+        && samePosition(range.end, last.range->start)) {
+        last.range->start = range.start;
+        return true;
+    }
+
+    return false;
 }
 
 QString DocumentSyncManager::filePathToUri(const QString& path)
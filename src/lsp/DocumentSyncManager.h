@@ -3,7 +3,9 @@
 
 #include <QObject>
 #include <QMap>
+#include <QPointer>
 #include <QTimer>
+#include "LSPProtocol.h"
 
 namespace XXMLStudio {
 
@@ -12,6 +14,7 @@ class LSPClient;
 /**
  * Manages document synchronization with the LSP server.
  * Debounces document changes to avoid overwhelming the server.
+ * Incremental edits are coalesced and sent as ranged content changes.
  */
 class DocumentSyncManager : public QObject
 {
@@ -29,15 +32,26 @@ public:
     void openDocument(const QString& filePath, const QString& text);
     void closeDocument(const QString& filePath);
     void documentChanged(const QString& filePath, const QString& text);
+    void documentEdited(const QString& filePath, const LSPTextChange& change);
     void documentSaved(const QString& filePath, const QString& text);
 
+    // Send pending changes for a document now (e.g. before a request)
+    void flushDocument(const QString& filePath);
+    bool isOpen(const QString& filePath) const { return m_documents.contains(filePath); }
+
     // Get document version
     int documentVersion(const QString& filePath) const;
+    // Edits made since the last version sent, still waiting out the debounce
+    bool hasPendingChanges(const QString& filePath) const;
 
     // Convert between file path and URI
     static QString filePathToUri(const QString& path);
     static QString uriToFilePath(const QString& uri);
 
+signals:
+    // Emitted after pending changes for a document were sent to the server
+    void changesSent(const QString& filePath, int version);
+
 private slots:
     void flushPendingChanges();
 
@@ -45,11 +59,15 @@ private:
     struct DocumentState {
         QString uri;
         QString pendingText;
+        QList<LSPTextChange> pendingEdits;
         int version = 0;
         bool hasPendingChanges = false;
     };
 
-    LSPClient* m_client;
+    bool flushState(DocumentState& state);
+    static bool coalesce(LSPTextChange& last, const LSPTextChange& change);
+
+    QPointer<LSPClient> m_client;
     QMap<QString, DocumentState> m_documents;  // filePath -> state
     QTimer* m_debounceTimer;
     int m_debounceDelay = 300;
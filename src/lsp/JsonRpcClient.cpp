@@ -1,13 +1,16 @@
 #include "JsonRpcClient.h"
 
+#include <QDateTime>
 #include <QJsonDocument>
-#include <QRegularExpression>
+#include <QThread>
 
 namespace XXMLStudio {
 
 JsonRpcClient::JsonRpcClient(QObject* parent)
     : QObject(parent)
 {
+    m_clock.start();
+
     m_process = new QProcess(this);
 
     // Use separate channels to properly handle both stdout and stderr
@@ -28,24 +31,48 @@ JsonRpcClient::~JsonRpcClient()
     stop();
 }
 
-bool JsonRpcClient::start(const QString& serverPath, const QStringList& arguments)
+void JsonRpcClient::runInClientThread(std::function<void()> task)
+{
+    if (QThread::currentThread() == thread()) {
+        task();
+    } else {
+        QMetaObject::invokeMethod(this, std::move(task), Qt::QueuedConnection);
+    }
+}
+
+void JsonRpcClient::start(const QString& serverPath, const QStringList& arguments)
+{
+    runInClientThread([this, serverPath, arguments]() {
+        startProcess(serverPath, arguments);
+    });
+}
+
+void JsonRpcClient::startProcess(const QString& serverPath, const QStringList& arguments)
 {
     if (isRunning()) {
-        return true;
+        emit serverStarted();
+        return;
     }
 
+    m_framer.reset();
     m_process->start(serverPath, arguments);
     if (!m_process->waitForStarted(5000)) {
         emit serverError(tr("Failed to start LSP server: %1").arg(m_process->errorString()));
-        return false;
+        return;
     }
 
     emit serverStarted();
     emit logMessage(tr("LSP server started: %1").arg(serverPath));
-    return true;
 }
 
 void JsonRpcClient::stop()
+{
+    runInClientThread([this]() {
+        stopProcess();
+    });
+}
+
+void JsonRpcClient::stopProcess()
 {
     if (!isRunning()) {
         return;
@@ -73,8 +100,17 @@ bool JsonRpcClient::isRunning() const
 
 int JsonRpcClient::sendRequest(const QString& method, const QJsonObject& params, ResponseCallback callback)
 {
-    int id = m_nextRequestId++;
+    int id = m_nextRequestId.fetchAndAddRelaxed(1);
 
+    runInClientThread([this, id, method, params, callback]() {
+        writeRequest(id, method, params, callback);
+    });
+
+    return id;
+}
+
+void JsonRpcClient::writeRequest(int id, const QString& method, const QJsonObject& params, ResponseCallback callback)
+{
     QJsonObject request;
     request["jsonrpc"] = "2.0";
     request["id"] = id;
@@ -83,14 +119,21 @@ int JsonRpcClient::sendRequest(const QString& method, const QJsonObject& params,
         request["params"] = params;
     }
 
-    m_pendingRequests[id] = callback;
-    writeMessage(request);
+    qint64 bytes = writeMessage(request);
+    m_pendingRequests[id] = {callback, method, m_clock.nsecsElapsed(), false};
+    recordTraffic(LSPTrafficEvent::Kind::Request, id, method, bytes);
 
     emit logMessage(tr("Request [%1]: %2").arg(id).arg(method));
-    return id;
 }
 
 void JsonRpcClient::sendNotification(const QString& method, const QJsonObject& params)
+{
+    runInClientThread([this, method, params]() {
+        writeNotification(method, params);
+    });
+}
+
+void JsonRpcClient::writeNotification(const QString& method, const QJsonObject& params)
 {
     QJsonObject notification;
     notification["jsonrpc"] = "2.0";
@@ -99,13 +142,29 @@ void JsonRpcClient::sendNotification(const QString& method, const QJsonObject& p
         notification["params"] = params;
     }
 
-    writeMessage(notification);
+    qint64 bytes = writeMessage(notification);
+    recordTraffic(LSPTrafficEvent::Kind::Notification, 0, method, bytes);
     emit logMessage(tr("Notification: %1").arg(method));
 }
 
+void JsonRpcClient::cancelRequest(int id)
+{
+    runInClientThread([this, id]() {
+        // Already answered requests need no cancellation. The entry stays
+        // until the server responds so the reply can still be accounted for.
+        auto it = m_pendingRequests.find(id);
+        if (it != m_pendingRequests.end() && !it->cancelled) {
+            it->cancelled = true;
+            it->callback = nullptr;
+            recordTraffic(LSPTrafficEvent::Kind::Cancel, id, it->method, 0);
+            writeNotification("$/cancelRequest", QJsonObject{{"id", id}});
+        }
+    });
+}
+
 void JsonRpcClient::onReadyReadStandardOutput()
 {
-    m_readBuffer.append(m_process->readAllStandardOutput());
+    m_framer.append(m_process->readAllStandardOutput());
     processIncomingData();
 }
 
@@ -119,6 +178,10 @@ void JsonRpcClient::onProcessFinished(int exitCode, QProcess::ExitStatus exitSta
 {
     Q_UNUSED(exitCode)
     Q_UNUSED(exitStatus)
+
+    // Outstanding requests will never be answered
+    m_pendingRequests.clear();
+
     emit serverStopped();
     emit logMessage(tr("LSP server stopped"));
 }
@@ -131,29 +194,19 @@ void JsonRpcClient::onProcessError(QProcess::ProcessError error)
 
 void JsonRpcClient::processIncomingData()
 {
-    // Parse Content-Length header and JSON body
-    while (!m_readBuffer.isEmpty()) {
-        // Look for Content-Length header
-        static QRegularExpression headerRegex(R"(Content-Length:\s*(\d+)\r\n\r\n)");
-        QString bufferStr = QString::fromUtf8(m_readBuffer);
-
-        QRegularExpressionMatch match = headerRegex.match(bufferStr);
-        if (!match.hasMatch()) {
-            // Not enough data yet, or no valid header
+    // Extract every complete Content-Length framed message
+    QByteArray jsonData;
+    while (true) {
+        MessageFramer::Result result = m_framer.next(jsonData);
+        if (result == MessageFramer::Result::NeedMoreData) {
             break;
         }
-
-        int headerEnd = match.capturedEnd();
-        int contentLength = match.captured(1).toInt();
-
-        // Check if we have enough data for the body
-        if (m_readBuffer.size() < headerEnd + contentLength) {
-            break;  // Wait for more data
+        if (result == MessageFramer::Result::Malformed) {
+            emit logMessage(tr("Skipped malformed message header"));
+            continue;
         }
 
-        // Extract the JSON body
-        QByteArray jsonData = m_readBuffer.mid(headerEnd, contentLength);
-        m_readBuffer.remove(0, headerEnd + contentLength);
+        qint64 receivedNs = m_clock.nsecsElapsed();
 
         // Parse JSON
         QJsonParseError parseError;
@@ -163,39 +216,66 @@ void JsonRpcClient::processIncomingData()
             continue;
         }
 
-        handleMessage(doc.object());
+        handleMessage(doc.object(), receivedNs, jsonData.size());
     }
 }
 
-void JsonRpcClient::handleMessage(const QJsonObject& message)
+void JsonRpcClient::handleMessage(const QJsonObject& message, qint64 receivedNs, qint64 bytes)
 {
     // Check if it's a response
     if (message.contains("id") && !message.contains("method")) {
         int id = message["id"].toInt();
 
-        if (m_pendingRequests.contains(id)) {
-            ResponseCallback callback = m_pendingRequests.take(id);
+        LSPTrafficEvent event;
+        event.kind = LSPTrafficEvent::Kind::Response;
+        event.id = id;
+        event.bytes = bytes;
+        event.timestamp = QDateTime::currentMSecsSinceEpoch();
+        event.error = message.contains("error");
 
-            if (message.contains("error")) {
-                callback(QJsonValue(), message["error"].toObject());
-            } else {
-                // Pass the raw result value - could be array, object, or other type
-                callback(message["result"], QJsonObject{});
+        if (m_pendingRequests.contains(id)) {
+            PendingRequest pending = m_pendingRequests.take(id);
+            event.method = pending.method;
+            event.cancelled = pending.cancelled;
+            event.serverNs = receivedNs - pending.sentNs;
+
+            if (pending.callback) {
+                if (event.error) {
+                    pending.callback(QJsonValue(), message["error"].toObject());
+                } else {
+                    // Pass the raw result value - could be array, object, or other type
+                    pending.callback(message["result"], QJsonObject{});
+                }
             }
         }
+
+        // Parsing plus whatever the callback did to convert the result
+        event.decodeNs = m_clock.nsecsElapsed() - receivedNs;
+        emit trafficRecorded(event);
     }
     // Check if it's a notification
     else if (message.contains("method") && !message.contains("id")) {
         QString method = message["method"].toString();
         QJsonObject params = message["params"].toObject();
+        if (m_notificationHandler) {
+            m_notificationHandler(method, params);
+        }
         emit notificationReceived(method, params);
+
+        LSPTrafficEvent event;
+        event.kind = LSPTrafficEvent::Kind::ServerNotification;
+        event.method = method;
+        event.bytes = bytes;
+        event.timestamp = QDateTime::currentMSecsSinceEpoch();
+        event.decodeNs = m_clock.nsecsElapsed() - receivedNs;
+        emit trafficRecorded(event);
     }
 }
 
-void JsonRpcClient::writeMessage(const QJsonObject& message)
+qint64 JsonRpcClient::writeMessage(const QJsonObject& message)
 {
     if (!isRunning()) {
-        return;
+        return 0;
     }
 
     QJsonDocument doc(message);
@@ -205,6 +285,18 @@ void JsonRpcClient::writeMessage(const QJsonObject& message)
     QByteArray header = QString("Content-Length: %1\r\n\r\n").arg(json.size()).toUtf8();
     m_process->write(header);
     m_process->write(json);
+    return json.size();
+}
+
+void JsonRpcClient::recordTraffic(LSPTrafficEvent::Kind kind, int id, const QString& method, qint64 bytes)
+{
+    LSPTrafficEvent event;
+    event.kind = kind;
+    event.id = id;
+    event.method = method;
+    event.bytes = bytes;
+    event.timestamp = QDateTime::currentMSecsSinceEpoch();
+    emit trafficRecorded(event);
 }
 
 } // namespace XXMLStudio
@@ -6,13 +6,27 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QMap>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <functional>
 
+#include "MessageFramer.h"
+#include "LSPTrafficMonitor.h"
+
 namespace XXMLStudio {
 
 /**
  * JSON-RPC client for communicating with the LSP server over stdio.
  * Handles the Content-Length header protocol.
+ *
+ * The client is meant to live on its own thread: process I/O, framing
+ * and JSON parsing/serialization all happen there. The public methods
+ * may be called from any thread; response callbacks and the
+ * notification handler run on the client's thread.
+ *
+ * Every message written or read is reported through trafficRecorded()
+ * with its size and, for responses, the time spent in the server and
+ * in decoding.
  */
 class JsonRpcClient : public QObject
 {
@@ -21,17 +35,18 @@ class JsonRpcClient : public QObject
 public:
     // Response callback receives the raw QJsonValue to handle both arrays and objects
     using ResponseCallback = std::function<void(const QJsonValue& result, const QJsonObject& error)>;
+    using NotificationHandler = std::function<void(const QString& method, const QJsonObject& params)>;
 
     explicit JsonRpcClient(QObject* parent = nullptr);
     ~JsonRpcClient();
 
-    // Start the LSP server process
-    bool start(const QString& serverPath, const QStringList& arguments = {});
+    // Start the LSP server process (serverStarted or serverError follows)
+    void start(const QString& serverPath, const QStringList& arguments = {});
 
     // Stop the server
     void stop();
 
-    // Check if server is running
+    // Check if server is running (client thread only)
     bool isRunning() const;
 
     // Send a request (expects a response)
@@ -40,12 +55,20 @@ public:
     // Send a notification (no response expected)
     void sendNotification(const QString& method, const QJsonObject& params);
 
+    // Send $/cancelRequest and drop the callback so a late response is ignored
+    void cancelRequest(int id);
+
+    // Handler for server notifications, called on the client thread.
+    // Must be set before the client is moved to its thread.
+    void setNotificationHandler(NotificationHandler handler) { m_notificationHandler = std::move(handler); }
+
 signals:
     void serverStarted();
     void serverStopped();
     void serverError(const QString& error);
     void notificationReceived(const QString& method, const QJsonObject& params);
     void logMessage(const QString& message);
+    void trafficRecorded(const XXMLStudio::LSPTrafficEvent& event);
 
 private slots:
     void onReadyReadStandardOutput();
@@ -54,14 +77,29 @@ private slots:
     void onProcessError(QProcess::ProcessError error);
 
 private:
+    void runInClientThread(std::function<void()> task);
+    void startProcess(const QString& serverPath, const QStringList& arguments);
+    void stopProcess();
+    void writeRequest(int id, const QString& method, const QJsonObject& params, ResponseCallback callback);
+    void writeNotification(const QString& method, const QJsonObject& params);
     void processIncomingData();
-    void handleMessage(const QJsonObject& message);
-    void writeMessage(const QJsonObject& message);
+    void handleMessage(const QJsonObject& message, qint64 receivedNs, qint64 bytes);
+    qint64 writeMessage(const QJsonObject& message);
+    void recordTraffic(LSPTrafficEvent::Kind kind, int id, const QString& method, qint64 bytes);
+
+    struct PendingRequest {
+        ResponseCallback callback;
+        QString method;
+        qint64 sentNs = 0;          // m_clock time the request was written
+        bool cancelled = false;     // Response is only awaited for accounting
+    };
 
     QProcess* m_process = nullptr;
-    QByteArray m_readBuffer;
-    int m_nextRequestId = 1;
-    QMap<int, ResponseCallback> m_pendingRequests;
+    MessageFramer m_framer;
+    QAtomicInt m_nextRequestId{1};
+    QMap<int, PendingRequest> m_pendingRequests;
+    QElapsedTimer m_clock;
+    NotificationHandler m_notificationHandler;
 };
 
 } // namespace XXMLStudio
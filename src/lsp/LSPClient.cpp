@@ -1,18 +1,45 @@
 #include "LSPClient.h"
 #include "JsonRpcClient.h"
+#include "LSPTrafficMonitor.h"
 
 #include <QDebug>
 #include <QJsonArray>
 #include <QUrl>
 #include <QDir>
 #include <QCoreApplication>
+#include <QThread>
+#include <algorithm>
 
 namespace XXMLStudio {
 
+template <typename Fn>
+void LSPClient::deliver(const char* method, Fn fn)
+{
+    QElapsedTimer queued;
+    queued.start();
+    QMetaObject::invokeMethod(this, [this, method, queued, fn]() {
+        fn();
+        m_trafficMonitor->recordDelivery(QString::fromLatin1(method), queued.nsecsElapsed());
+    }, Qt::QueuedConnection);
+}
+
 LSPClient::LSPClient(QObject* parent)
     : QObject(parent)
 {
-    m_rpc = new JsonRpcClient(this);
+    qRegisterMetaType<LSPTrafficEvent>();
+    m_trafficMonitor = new LSPTrafficMonitor(this);
+
+    // JSON-RPC transport, JSON decoding and conversion to LSP types run on
+    // their own thread; only typed results are delivered to this thread.
+    m_rpc = new JsonRpcClient();
+    m_rpc->setNotificationHandler([this](const QString& method, const QJsonObject& params) {
+        handleNotification(method, params);
+    });
+
+    m_rpcThread = new QThread(this);
+    m_rpcThread->setObjectName("LSP JSON-RPC");
+    m_rpc->moveToThread(m_rpcThread);
+    connect(m_rpcThread, &QThread::finished, m_rpc, &QObject::deleteLater);
 
     connect(m_rpc, &JsonRpcClient::serverStarted,
             this, &LSPClient::onServerStarted);
@@ -20,15 +47,21 @@ LSPClient::LSPClient(QObject* parent)
             this, &LSPClient::onServerStopped);
     connect(m_rpc, &JsonRpcClient::serverError,
             this, &LSPClient::onServerError);
-    connect(m_rpc, &JsonRpcClient::notificationReceived,
-            this, &LSPClient::onNotificationReceived);
     connect(m_rpc, &JsonRpcClient::logMessage,
             this, &LSPClient::logMessage);
+    connect(m_rpc, &JsonRpcClient::trafficRecorded,
+            m_trafficMonitor, &LSPTrafficMonitor::record);
+
+    m_rpcThread->start();
 }
 
 LSPClient::~LSPClient()
 {
     stop();
+
+    // The client is deleted on its own thread once the thread finishes
+    m_rpcThread->quit();
+    m_rpcThread->wait();
 }
 
 bool LSPClient::start(const QString& serverPath)
@@ -46,11 +79,8 @@ bool LSPClient::start(const QString& serverPath)
         args << "-I" << path;
     }
 
-    if (!m_rpc->start(serverPath, args)) {
-        setState(State::Disconnected);
-        return false;
-    }
-
+    // Failure to start is reported through serverError
+    m_rpc->start(serverPath, args);
     return true;
 }
 
@@ -61,11 +91,15 @@ void LSPClient::restart()
     }
 
     // Clear pending requests
-    m_pendingCompletions.clear();
-    m_pendingHovers.clear();
+    m_latestCompletions.clear();
+    m_latestHovers.clear();
+    m_latestSymbols.clear();
+    m_latestSemanticTokens.clear();
+    m_latestSemanticRanges.clear();
+    m_semanticTokens.clear();
     m_pendingDefinitions.clear();
     m_pendingReferences.clear();
-    m_pendingSymbols.clear();
+    m_documentVersions.clear();
 
     // If already disconnected, start immediately
     if (m_state == State::Disconnected) {
@@ -97,6 +131,16 @@ void LSPClient::onServerStarted()
 void LSPClient::onServerStopped()
 {
     setState(State::Disconnected);
+    m_syncKind = TextDocumentSyncKind::Full;
+    m_semanticTokensProvider = SemanticTokensProvider();
+    m_trafficMonitor->resetInFlight();
+    m_latestCompletions.clear();
+    m_latestHovers.clear();
+    m_latestSymbols.clear();
+    m_latestSemanticTokens.clear();
+    m_latestSemanticRanges.clear();
+    m_semanticTokens.clear();
+    m_documentVersions.clear();
 
     // Check if we need to restart
     if (m_pendingRestart) {
@@ -109,9 +153,19 @@ void LSPClient::onServerStopped()
 
 void LSPClient::onServerError(const QString& errorMsg)
 {
+    if (m_state == State::Connecting) {
+        setState(State::Disconnected);
+    }
     emit error(errorMsg);
 }
 
+void LSPClient::reportError(const QString& message)
+{
+    deliver([this, message]() {
+        emit error(message);
+    });
+}
+
 void LSPClient::setProjectRoot(const QString& path)
 {
     m_rootPath = path;
@@ -186,22 +240,72 @@ void LSPClient::initialize()
         {"hierarchicalDocumentSymbolSupport", true}
     };
     textDocumentCapabilities["publishDiagnostics"] = QJsonObject{{"relatedInformation", true}};
+    textDocumentCapabilities["semanticTokens"] = QJsonObject{
+        {"dynamicRegistration", false},
+        {"requests", QJsonObject{
+            {"range", true},
+            {"full", QJsonObject{{"delta", true}}}
+        }},
+        {"tokenTypes", QJsonArray{
+            "namespace", "type", "class", "enum", "interface", "struct", "typeParameter",
+            "parameter", "variable", "property", "enumMember", "event", "function",
+            "method", "macro", "keyword", "modifier", "comment", "string", "number",
+            "regexp", "operator"
+        }},
+        {"tokenModifiers", QJsonArray{
+            "declaration", "definition", "readonly", "static", "deprecated",
+            "abstract", "async", "modification", "documentation", "defaultLibrary"
+        }},
+        {"formats", QJsonArray{"relative"}},
+        {"overlappingTokenSupport", false},
+        {"multilineTokenSupport", false}
+    };
 
     capabilities["textDocument"] = textDocumentCapabilities;
     params["capabilities"] = capabilities;
 
     m_rpc->sendRequest("initialize", params,
         [this](const QJsonValue& result, const QJsonObject& err) {
-            Q_UNUSED(result)
             if (!err.isEmpty()) {
-                emit this->error(QString("Initialize failed: %1").arg(err["message"].toString()));
-                setState(State::Disconnected);
+                QString message = err["message"].toString();
+                deliver([this, message]() {
+                    emit error(QString("Initialize failed: %1").arg(message));
+                    setState(State::Disconnected);
+                });
                 return;
             }
 
-            m_rpc->sendNotification("initialized", QJsonObject{});
-            setState(State::Ready);
-            emit initialized();
+            // textDocumentSync is either a TextDocumentSyncKind or TextDocumentSyncOptions
+            QJsonObject serverCapabilities = result.toObject()["capabilities"].toObject();
+            QJsonValue sync = serverCapabilities["textDocumentSync"];
+            int syncKind = static_cast<int>(TextDocumentSyncKind::Full);
+            if (sync.isObject()) {
+                syncKind = sync.toObject()["change"].toInt(syncKind);
+            } else if (sync.isDouble()) {
+                syncKind = sync.toInt(syncKind);
+            }
+
+            // full and range are either booleans or option objects
+            SemanticTokensProvider semanticTokens;
+            QJsonObject provider = serverCapabilities["semanticTokensProvider"].toObject();
+            if (!provider.isEmpty()) {
+                QJsonValue full = provider["full"];
+                semanticTokens.full = full.isObject() || full.toBool();
+                semanticTokens.delta = full.toObject()["delta"].toBool();
+                QJsonValue range = provider["range"];
+                semanticTokens.range = range.isObject() || range.toBool();
+                for (const auto& type : provider["legend"].toObject()["tokenTypes"].toArray()) {
+                    semanticTokens.tokenTypes.append(type.toString());
+                }
+            }
+
+            deliver([this, syncKind, semanticTokens]() {
+                m_syncKind = static_cast<TextDocumentSyncKind>(syncKind);
+                m_semanticTokensProvider = semanticTokens;
+                m_rpc->sendNotification("initialized", QJsonObject{});
+                setState(State::Ready);
+                emit initialized();
+            });
         });
 }
 
@@ -225,6 +329,7 @@ void LSPClient::openDocument(const QString& uri, const QString& languageId, int
         {"text", text}
     };
 
+    m_documentVersions[uri] = version;
     m_rpc->sendNotification("textDocument/didOpen", params);
 }
 
@@ -232,6 +337,16 @@ void LSPClient::closeDocument(const QString& uri)
 {
     if (!isReady()) return;
 
+    // Results for a closed document are of no use anymore
+    for (auto* latest : {&m_latestCompletions, &m_latestHovers, &m_latestSymbols,
+                         &m_latestSemanticTokens, &m_latestSemanticRanges}) {
+        if (latest->contains(uri)) {
+            m_rpc->cancelRequest(latest->take(uri).id);
+        }
+    }
+    m_documentVersions.remove(uri);
+    m_semanticTokens.remove(uri);
+
     QJsonObject params;
     params["textDocument"] = QJsonObject{{"uri", uri}};
     m_rpc->sendNotification("textDocument/didClose", params);
@@ -245,6 +360,24 @@ void LSPClient::changeDocument(const QString& uri, int version, const QString& t
     params["textDocument"] = QJsonObject{{"uri", uri}, {"version", version}};
     params["contentChanges"] = QJsonArray{QJsonObject{{"text", text}}};
 
+    m_documentVersions[uri] = version;
+    m_rpc->sendNotification("textDocument/didChange", params);
+}
+
+void LSPClient::changeDocument(const QString& uri, int version, const QList<LSPTextChange>& changes)
+{
+    if (!isReady() || changes.isEmpty()) return;
+
+    QJsonArray contentChanges;
+    for (const LSPTextChange& change : changes) {
+        contentChanges.append(change.toJson());
+    }
+
+    QJsonObject params;
+    params["textDocument"] = QJsonObject{{"uri", uri}, {"version", version}};
+    params["contentChanges"] = contentChanges;
+
+    m_documentVersions[uri] = version;
     m_rpc->sendNotification("textDocument/didChange", params);
 }
 
@@ -259,6 +392,37 @@ void LSPClient::saveDocument(const QString& uri, const QString& text)
     m_rpc->sendNotification("textDocument/didSave", params);
 }
 
+int LSPClient::supersede(QHash<QString, LatestRequest>& latest, const QString& uri)
+{
+    auto it = latest.find(uri);
+    if (it != latest.end()) {
+        m_rpc->cancelRequest(it->id);
+        latest.erase(it);
+    }
+    return ++m_requestSerial;
+}
+
+bool LSPClient::finishSuperseded(QHash<QString, LatestRequest>& latest, const QString& uri, int serial,
+                                 bool requireCurrentVersion)
+{
+    auto it = latest.find(uri);
+    if (it == latest.end() || it->serial != serial) {
+        return false;  // A newer request replaced this one
+    }
+
+    int version = it->version;
+    latest.erase(it);
+
+    // Drop results computed for an older version of the document
+    return !requireCurrentVersion || m_documentVersions.value(uri, -1) == version;
+}
+
+static bool isCancellation(const QJsonObject& err)
+{
+    int code = err["code"].toInt();
+    return code == LSPErrorCode::RequestCancelled || code == LSPErrorCode::ContentModified;
+}
+
 void LSPClient::requestCompletion(const QString& uri, int line, int character)
 {
     if (!isReady()) {
@@ -272,19 +436,28 @@ void LSPClient::requestCompletion(const QString& uri, int line, int character)
     params["textDocument"] = QJsonObject{{"uri", uri}};
     params["position"] = QJsonObject{{"line", line}, {"character", character}};
 
+    int serial = supersede(m_latestCompletions, uri);
+    int version = m_documentVersions.value(uri);
+
     int id = m_rpc->sendRequest("textDocument/completion", params,
-        [this, uri](const QJsonValue& result, const QJsonObject& err) {
+        [this, uri, serial, version](const QJsonValue& result, const QJsonObject& err) {
             qDebug() << "LSPClient: completion response received, isArray:" << result.isArray()
                      << "isObject:" << result.isObject() << "isNull:" << result.isNull();
 
             if (!err.isEmpty()) {
                 qDebug() << "LSPClient: completion error:" << err["message"].toString();
-                emit this->error(QString("Completion failed: %1").arg(err["message"].toString()));
+                if (!isCancellation(err)) {
+                    reportError(QString("Completion failed: %1").arg(err["message"].toString()));
+                }
+                deliver([this, uri, serial]() {
+                    finishSuperseded(m_latestCompletions, uri, serial);
+                });
                 return;
             }
 
             QList<LSPCompletionItem> items;
             QJsonArray itemsArray;
+            bool isIncomplete = false;
 
             // Handle both CompletionList (object with items) and CompletionItem[] (direct array)
             if (result.isArray()) {
@@ -292,6 +465,7 @@ void LSPClient::requestCompletion(const QString& uri, int line, int character)
                 qDebug() << "LSPClient: got array with" << itemsArray.size() << "items";
             } else if (result.isObject()) {
                 QJsonObject obj = result.toObject();
+                isIncomplete = obj["isIncomplete"].toBool();
                 if (obj.contains("items")) {
                     itemsArray = obj["items"].toArray();
                     qDebug() << "LSPClient: got object with" << itemsArray.size() << "items";
@@ -303,10 +477,14 @@ void LSPClient::requestCompletion(const QString& uri, int line, int character)
             }
 
             qDebug() << "LSPClient: emitting completionReceived with" << items.size() << "items";
-            emit completionReceived(uri, items);
+            deliver("textDocument/completion", [this, uri, serial, version, items, isIncomplete]() {
+                if (finishSuperseded(m_latestCompletions, uri, serial, false)) {
+                    emit completionReceived(uri, items, version, isIncomplete);
+                }
+            });
         });
 
-    m_pendingCompletions[id] = uri;
+    m_latestCompletions[uri] = {id, serial, version};
 }
 
 void LSPClient::requestHover(const QString& uri, int line, int character)
@@ -317,23 +495,34 @@ void LSPClient::requestHover(const QString& uri, int line, int character)
     params["textDocument"] = QJsonObject{{"uri", uri}};
     params["position"] = QJsonObject{{"line", line}, {"character", character}};
 
+    int serial = supersede(m_latestHovers, uri);
+    int version = m_documentVersions.value(uri);
+
     int id = m_rpc->sendRequest("textDocument/hover", params,
-        [this, uri](const QJsonValue& result, const QJsonObject& err) {
+        [this, uri, serial, version](const QJsonValue& result, const QJsonObject& err) {
             if (!err.isEmpty()) {
-                emit this->error(QString("Hover failed: %1").arg(err["message"].toString()));
+                if (!isCancellation(err)) {
+                    reportError(QString("Hover failed: %1").arg(err["message"].toString()));
+                }
+                deliver([this, uri, serial]() {
+                    finishSuperseded(m_latestHovers, uri, serial);
+                });
                 return;
             }
 
-            if (result.isNull() || !result.isObject()) {
-                emit hoverReceived(uri, LSPHover{});
-                return;
+            LSPHover hover;
+            if (result.isObject()) {
+                hover = LSPHover::fromJson(result.toObject());
             }
 
-            LSPHover hover = LSPHover::fromJson(result.toObject());
-            emit hoverReceived(uri, hover);
+            deliver("textDocument/hover", [this, uri, serial, version, hover]() {
+                if (finishSuperseded(m_latestHovers, uri, serial)) {
+                    emit hoverReceived(uri, hover, version);
+                }
+            });
         });
 
-    m_pendingHovers[id] = uri;
+    m_latestHovers[uri] = {id, serial, version};
 }
 
 void LSPClient::requestDefinition(const QString& uri, int line, int character)
@@ -347,7 +536,7 @@ void LSPClient::requestDefinition(const QString& uri, int line, int character)
     int id = m_rpc->sendRequest("textDocument/definition", params,
         [this, uri](const QJsonValue& result, const QJsonObject& err) {
             if (!err.isEmpty()) {
-                emit this->error(QString("Definition failed: %1").arg(err["message"].toString()));
+                reportError(QString("Definition failed: %1").arg(err["message"].toString()));
                 return;
             }
 
@@ -364,7 +553,9 @@ void LSPClient::requestDefinition(const QString& uri, int line, int character)
                 }
             }
 
-            emit definitionReceived(uri, locations);
+            deliver("textDocument/definition", [this, uri, locations]() {
+                emit definitionReceived(uri, locations);
+            });
         });
 
     m_pendingDefinitions[id] = uri;
@@ -382,7 +573,7 @@ void LSPClient::requestReferences(const QString& uri, int line, int character)
     int id = m_rpc->sendRequest("textDocument/references", params,
         [this, uri](const QJsonValue& result, const QJsonObject& err) {
             if (!err.isEmpty()) {
-                emit this->error(QString("References failed: %1").arg(err["message"].toString()));
+                reportError(QString("References failed: %1").arg(err["message"].toString()));
                 return;
             }
 
@@ -392,7 +583,9 @@ void LSPClient::requestReferences(const QString& uri, int line, int character)
                     locations.append(LSPLocation::fromJson(loc.toObject()));
                 }
             }
-            emit referencesReceived(uri, locations);
+            deliver("textDocument/references", [this, uri, locations]() {
+                emit referencesReceived(uri, locations);
+            });
         });
 
     m_pendingReferences[id] = uri;
@@ -405,10 +598,18 @@ void LSPClient::requestDocumentSymbols(const QString& uri)
     QJsonObject params;
     params["textDocument"] = QJsonObject{{"uri", uri}};
 
+    int serial = supersede(m_latestSymbols, uri);
+    int version = m_documentVersions.value(uri);
+
     int id = m_rpc->sendRequest("textDocument/documentSymbol", params,
-        [this, uri](const QJsonValue& result, const QJsonObject& err) {
+        [this, uri, serial, version](const QJsonValue& result, const QJsonObject& err) {
             if (!err.isEmpty()) {
-                emit this->error(QString("DocumentSymbol failed: %1").arg(err["message"].toString()));
+                if (!isCancellation(err)) {
+                    reportError(QString("DocumentSymbol failed: %1").arg(err["message"].toString()));
+                }
+                deliver([this, uri, serial]() {
+                    finishSuperseded(m_latestSymbols, uri, serial);
+                });
                 return;
             }
 
@@ -418,14 +619,143 @@ void LSPClient::requestDocumentSymbols(const QString& uri)
                     symbols.append(LSPDocumentSymbol::fromJson(sym.toObject()));
                 }
             }
-            emit documentSymbolsReceived(uri, symbols);
+            deliver("textDocument/documentSymbol", [this, uri, serial, version, symbols]() {
+                if (finishSuperseded(m_latestSymbols, uri, serial)) {
+                    emit documentSymbolsReceived(uri, symbols, version);
+                }
+            });
+        });
+
+    m_latestSymbols[uri] = {id, serial, version};
+}
+
+static QList<int> semanticTokensData(const QJsonArray& array)
+{
+    QList<int> data;
+    data.reserve(array.size());
+    for (const auto& value : array) {
+        data.append(value.toInt());
+    }
+    return data;
+}
+
+void LSPClient::requestSemanticTokens(const QString& uri)
+{
+    if (!isReady() || !m_semanticTokensProvider.full) return;
+
+    int serial = supersede(m_latestSemanticTokens, uri);
+    int version = m_documentVersions.value(uri);
+
+    SemanticTokensResult previous = m_semanticTokens.value(uri);
+    bool delta = m_semanticTokensProvider.delta && !previous.resultId.isEmpty();
+    QStringList tokenTypes = m_semanticTokensProvider.tokenTypes;
+
+    QJsonObject params;
+    params["textDocument"] = QJsonObject{{"uri", uri}};
+    if (delta) {
+        params["previousResultId"] = previous.resultId;
+    }
+
+    QString method = delta ? "textDocument/semanticTokens/full/delta" : "textDocument/semanticTokens/full";
+    int id = m_rpc->sendRequest(method, params,
+        [this, uri, serial, version, previous, tokenTypes](const QJsonValue& result, const QJsonObject& err) {
+            if (!err.isEmpty()) {
+                if (!isCancellation(err)) {
+                    reportError(QString("SemanticTokens failed: %1").arg(err["message"].toString()));
+                }
+                deliver([this, uri, serial]() {
+                    finishSuperseded(m_latestSemanticTokens, uri, serial);
+                });
+                return;
+            }
+
+            // A delta request may still be answered with full tokens
+            QJsonObject obj = result.toObject();
+            SemanticTokensResult current;
+            current.resultId = obj["resultId"].toString();
+            if (obj.contains("edits")) {
+                current.data = previous.data;
+
+                // Edits refer to the previous array; apply from the back
+                QJsonArray edits = obj["edits"].toArray();
+                QList<QJsonObject> sorted;
+                for (const auto& edit : edits) {
+                    sorted.append(edit.toObject());
+                }
+                std::sort(sorted.begin(), sorted.end(), [](const QJsonObject& a, const QJsonObject& b) {
+                    return a["start"].toInt() > b["start"].toInt();
+                });
+                for (const QJsonObject& edit : sorted) {
+                    int start = qBound(0, edit["start"].toInt(), static_cast<int>(current.data.size()));
+                    int deleteCount = qBound(0, edit["deleteCount"].toInt(),
+                                             static_cast<int>(current.data.size()) - start);
+                    QList<int> inserted = semanticTokensData(edit["data"].toArray());
+                    QList<int> merged;
+                    merged.reserve(current.data.size() - deleteCount + inserted.size());
+                    merged.append(current.data.mid(0, start));
+                    merged.append(inserted);
+                    merged.append(current.data.mid(start + deleteCount));
+                    current.data = std::move(merged);
+                }
+            } else {
+                current.data = semanticTokensData(obj["data"].toArray());
+            }
+
+            QList<LSPSemanticToken> tokens = LSPSemanticToken::decode(current.data, tokenTypes);
+            deliver("textDocument/semanticTokens/full", [this, uri, serial, version, current, tokens]() {
+                if (!finishSuperseded(m_latestSemanticTokens, uri, serial, false)) {
+                    return;
+                }
+                // Keep the result as the delta base even when it is already outdated
+                m_semanticTokens[uri] = current;
+                if (m_documentVersions.value(uri, -1) == version) {
+                    emit semanticTokensReceived(uri, tokens, version);
+                }
+            });
         });
 
-    m_pendingSymbols[id] = uri;
+    m_latestSemanticTokens[uri] = {id, serial, version};
 }
 
-void LSPClient::onNotificationReceived(const QString& method, const QJsonObject& params)
+void LSPClient::requestSemanticTokensRange(const QString& uri, const LSPRange& range)
 {
+    if (!isReady() || !m_semanticTokensProvider.range) return;
+
+    int serial = supersede(m_latestSemanticRanges, uri);
+    int version = m_documentVersions.value(uri);
+    QStringList tokenTypes = m_semanticTokensProvider.tokenTypes;
+
+    QJsonObject params;
+    params["textDocument"] = QJsonObject{{"uri", uri}};
+    params["range"] = range.toJson();
+
+    int id = m_rpc->sendRequest("textDocument/semanticTokens/range", params,
+        [this, uri, range, serial, version, tokenTypes](const QJsonValue& result, const QJsonObject& err) {
+            if (!err.isEmpty()) {
+                if (!isCancellation(err)) {
+                    reportError(QString("SemanticTokens failed: %1").arg(err["message"].toString()));
+                }
+                deliver([this, uri, serial]() {
+                    finishSuperseded(m_latestSemanticRanges, uri, serial);
+                });
+                return;
+            }
+
+            QList<int> data = semanticTokensData(result.toObject()["data"].toArray());
+            QList<LSPSemanticToken> tokens = LSPSemanticToken::decode(data, tokenTypes);
+            deliver("textDocument/semanticTokens/range", [this, uri, range, serial, version, tokens]() {
+                if (finishSuperseded(m_latestSemanticRanges, uri, serial)) {
+                    emit semanticTokensRangeReceived(uri, range, tokens, version);
+                }
+            });
+        });
+
+    m_latestSemanticRanges[uri] = {id, serial, version};
+}
+
+void LSPClient::handleNotification(const QString& method, const QJsonObject& params)
+{
+    // Runs on the JSON-RPC thread
     if (method == "textDocument/publishDiagnostics") {
         QString uri = params["uri"].toString();
         QJsonArray diagnosticsArray = params["diagnostics"].toArray();
@@ -435,11 +765,15 @@ void LSPClient::onNotificationReceived(const QString& method, const QJsonObject&
             diagnostics.append(LSPDiagnostic::fromJson(diag.toObject()));
         }
 
-        emit diagnosticsReceived(uri, diagnostics);
+        deliver("textDocument/publishDiagnostics", [this, uri, diagnostics]() {
+            emit diagnosticsReceived(uri, diagnostics);
+        });
     }
     else if (method == "window/logMessage") {
         QString message = params["message"].toString();
-        emit logMessage(QString("Server: %1").arg(message));
+        deliver([this, message]() {
+            emit logMessage(QString("Server: %1").arg(message));
+        });
     }
 }
 
@@ -4,11 +4,15 @@
 #include <QObject>
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QThread>
+#include <QElapsedTimer>
 #include "LSPProtocol.h"
 
 namespace XXMLStudio {
 
 class JsonRpcClient;
+class LSPTrafficMonitor;
 
 /**
  * High-level LSP client that provides async API for LSP operations.
@@ -45,19 +49,35 @@ public:
     QStringList includePaths() const { return m_includePaths; }
     void updateConfiguration();  // Send config update to running server
 
+    // Per-method traffic and latency statistics
+    LSPTrafficMonitor* trafficMonitor() const { return m_trafficMonitor; }
+
+    // Sync kind advertised by the server (Full until initialized)
+    TextDocumentSyncKind textDocumentSyncKind() const { return m_syncKind; }
+
     // Document management
     void openDocument(const QString& uri, const QString& languageId, int version, const QString& text);
     void closeDocument(const QString& uri);
     void changeDocument(const QString& uri, int version, const QString& text);
+    void changeDocument(const QString& uri, int version, const QList<LSPTextChange>& changes);
     void saveDocument(const QString& uri, const QString& text);
 
-    // Language features
+    // Language features. A completion, hover or symbols request cancels the
+    // previous one of the same kind for the same document.
     void requestCompletion(const QString& uri, int line, int character);
     void requestHover(const QString& uri, int line, int character);
     void requestDefinition(const QString& uri, int line, int character);
     void requestReferences(const QString& uri, int line, int character);
     void requestDocumentSymbols(const QString& uri);
 
+    // Semantic tokens. requestSemanticTokens asks for a delta against the
+    // previous result when the server supports it; range requests are
+    // meant for the visible part of large documents.
+    bool supportsSemanticTokens() const { return m_semanticTokensProvider.full; }
+    bool supportsSemanticTokensRange() const { return m_semanticTokensProvider.range; }
+    void requestSemanticTokens(const QString& uri);
+    void requestSemanticTokensRange(const QString& uri, const LSPRange& range);
+
 signals:
     void stateChanged(State state);
     void initialized();
@@ -67,44 +87,100 @@ signals:
     // Diagnostics
     void diagnosticsReceived(const QString& uri, const QList<LSPDiagnostic>& diagnostics);
 
-    // Completion
-    void completionReceived(const QString& uri, const QList<LSPCompletionItem>& items);
+    // Completion, hover and symbols carry the document version they were
+    // computed for; superseded results are never emitted. Hover and symbols
+    // for an outdated version are dropped too, while completions are kept:
+    // the editor checks that the edits since the request only extended the
+    // word being completed.
+
+    // Completion. isIncomplete means further typing must re-request
+    // instead of filtering this list.
+    void completionReceived(const QString& uri, const QList<LSPCompletionItem>& items, int version,
+                            bool isIncomplete);
 
     // Hover
-    void hoverReceived(const QString& uri, const LSPHover& hover);
+    void hoverReceived(const QString& uri, const LSPHover& hover, int version);
 
     // Definition/References
     void definitionReceived(const QString& uri, const QList<LSPLocation>& locations);
     void referencesReceived(const QString& uri, const QList<LSPLocation>& locations);
 
     // Document symbols
-    void documentSymbolsReceived(const QString& uri, const QList<LSPDocumentSymbol>& symbols);
+    void documentSymbolsReceived(const QString& uri, const QList<LSPDocumentSymbol>& symbols, int version);
+
+    // Semantic tokens for the whole document or for a line range
+    void semanticTokensReceived(const QString& uri, const QList<LSPSemanticToken>& tokens, int version);
+    void semanticTokensRangeReceived(const QString& uri, const LSPRange& range,
+                                     const QList<LSPSemanticToken>& tokens, int version);
 
 private slots:
     void onServerStarted();
     void onServerStopped();
     void onServerError(const QString& error);
-    void onNotificationReceived(const QString& method, const QJsonObject& params);
 
 private:
+    // Response callbacks and notifications are decoded on the JSON-RPC
+    // thread; deliver() queues the typed result onto this object's thread.
+    template <typename Fn>
+    void deliver(Fn fn) { QMetaObject::invokeMethod(this, std::move(fn), Qt::QueuedConnection); }
+    // Same, recording queueing plus signal handling time for the method
+    template <typename Fn>
+    void deliver(const char* method, Fn fn);
+    void reportError(const QString& message);
+    void handleNotification(const QString& method, const QJsonObject& params);
+
     void initialize();
     void setState(State state);
     QString filePathToUri(const QString& path) const;
     QString uriToFilePath(const QString& uri) const;
 
     JsonRpcClient* m_rpc = nullptr;
+    QThread* m_rpcThread = nullptr;
+    LSPTrafficMonitor* m_trafficMonitor = nullptr;
     State m_state = State::Disconnected;
     QString m_serverPath;
     QString m_rootPath;
     QStringList m_includePaths;
     bool m_pendingRestart = false;
+    TextDocumentSyncKind m_syncKind = TextDocumentSyncKind::Full;
+
+    // semanticTokensProvider from the server capabilities
+    struct SemanticTokensProvider {
+        bool full = false;
+        bool delta = false;
+        bool range = false;
+        QStringList tokenTypes;
+    };
+    SemanticTokensProvider m_semanticTokensProvider;
+
+    // Last full result per document, the base for delta requests
+    struct SemanticTokensResult {
+        QString resultId;
+        QList<int> data;
+    };
+    QHash<QString, SemanticTokensResult> m_semanticTokens;
+
+    // Latest in-flight request per document for superseding request kinds
+    struct LatestRequest {
+        int id = 0;         // JSON-RPC id, for $/cancelRequest
+        int serial = 0;     // Distinguishes requests locally
+        int version = 0;    // Document version the request was made against
+    };
+    int supersede(QHash<QString, LatestRequest>& latest, const QString& uri);
+    bool finishSuperseded(QHash<QString, LatestRequest>& latest, const QString& uri, int serial,
+                          bool requireCurrentVersion = true);
+
+    QHash<QString, LatestRequest> m_latestCompletions;
+    QHash<QString, LatestRequest> m_latestHovers;
+    QHash<QString, LatestRequest> m_latestSymbols;
+    QHash<QString, LatestRequest> m_latestSemanticTokens;
+    QHash<QString, LatestRequest> m_latestSemanticRanges;
+    QHash<QString, int> m_documentVersions;  // uri -> last version sent
+    int m_requestSerial = 0;
 
     // Track pending request URIs for routing responses
-    QMap<int, QString> m_pendingCompletions;
-    QMap<int, QString> m_pendingHovers;
     QMap<int, QString> m_pendingDefinitions;
     QMap<int, QString> m_pendingReferences;
-    QMap<int, QString> m_pendingSymbols;
 };
 
 } // namespace XXMLStudio
@@ -5,6 +5,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QList>
+#include <QStringList>
 #include <optional>
 
 namespace XXMLStudio {
@@ -40,6 +41,34 @@ struct LSPRange {
     }
 };
 
+// JSON-RPC error codes the client treats as expected rather than failures
+namespace LSPErrorCode {
+constexpr int RequestCancelled = -32800;
+constexpr int ContentModified = -32801;
+}
+
+// How the server wants document changes to be synchronized
+enum class TextDocumentSyncKind {
+    None = 0,
+    Full = 1,
+    Incremental = 2
+};
+
+// A single content change for textDocument/didChange.
+// Without a range the text is the full new content of the document.
+struct LSPTextChange {
+    std::optional<LSPRange> range;
+    QString text;
+
+    QJsonObject toJson() const {
+        QJsonObject j{{"text", text}};
+        if (range) {
+            j["range"] = range->toJson();
+        }
+        return j;
+    }
+};
+
 // Location represents a location in a document
 struct LSPLocation {
     QString uri;
@@ -200,6 +229,41 @@ struct LSPDocumentSymbol {
     }
 };
 
+// Semantic token with absolute position, decoded from the relative
+// integer encoding of textDocument/semanticTokens
+struct LSPSemanticToken {
+    int line = 0;
+    int character = 0;
+    int length = 0;
+    QString type;       // Name from the server's legend, e.g. "variable"
+    int modifiers = 0;  // Bit set over the legend's tokenModifiers
+
+    static QList<LSPSemanticToken> decode(const QList<int>& data, const QStringList& tokenTypes) {
+        QList<LSPSemanticToken> tokens;
+        tokens.reserve(data.size() / 5);
+
+        int line = 0;
+        int character = 0;
+        for (qsizetype i = 0; i + 4 < data.size(); i += 5) {
+            int deltaLine = data[i];
+            if (deltaLine > 0) {
+                line += deltaLine;
+                character = 0;
+            }
+            character += data[i + 1];
+
+            LSPSemanticToken token;
+            token.line = line;
+            token.character = character;
+            token.length = data[i + 2];
+            token.type = tokenTypes.value(data[i + 3]);
+            token.modifiers = data[i + 4];
+            tokens.append(token);
+        }
+        return tokens;
+    }
+};
+
 } // namespace XXMLStudio
 
 #endif // LSPPROTOCOL_H
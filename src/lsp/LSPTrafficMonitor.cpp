@@ -0,0 +1,275 @@
+#include "LSPTrafficMonitor.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+
+namespace XXMLStudio {
+
+QString LSPTrafficEvent::kindName(Kind kind)
+{
+    switch (kind) {
+        case Kind::Request: return "request";
+        case Kind::Response: return "response";
+        case Kind::Notification: return "notification";
+        case Kind::ServerNotification: return "serverNotification";
+        case Kind::Cancel: return "cancel";
+    }
+    return QString();
+}
+
+// =============================================================================
+// LatencySamples
+// =============================================================================
+
+void LatencySamples::add(qint64 ns)
+{
+    if (m_samples.size() < MAX_SAMPLES) {
+        m_samples.append(ns);
+    } else {
+        m_samples[m_next] = ns;
+    }
+    m_next = (m_next + 1) % MAX_SAMPLES;
+    ++m_count;
+
+    // Bucket 0 is < 1ms, bucket n covers [2^(n-1), 2^n) ms
+    qint64 ms = ns / 1000000;
+    int bucket = 0;
+    while (ms > 0 && bucket < BUCKET_COUNT - 1) {
+        ms >>= 1;
+        ++bucket;
+    }
+    ++m_buckets[bucket];
+}
+
+void LatencySamples::clear()
+{
+    m_samples.clear();
+    m_next = 0;
+    m_count = 0;
+    m_buckets.fill(0);
+}
+
+double LatencySamples::percentileMs(double percentile) const
+{
+    if (m_samples.isEmpty()) {
+        return 0.0;
+    }
+
+    // Nearest-rank on a copy; at most MAX_SAMPLES elements
+    QList<qint64> sorted = m_samples;
+    qsizetype rank = static_cast<qsizetype>(std::ceil(percentile / 100.0 * sorted.size())) - 1;
+    rank = qBound<qsizetype>(0, rank, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank] / 1e6;
+}
+
+QString LatencySamples::bucketLabel(int bucket)
+{
+    if (bucket == 0) {
+        return "< 1 ms";
+    }
+    if (bucket == BUCKET_COUNT - 1) {
+        return QString(">= %1 ms").arg(1 << (bucket - 1));
+    }
+    return QString("%1-%2 ms").arg(1 << (bucket - 1)).arg(1 << bucket);
+}
+
+// =============================================================================
+// LSPTrafficMonitor
+// =============================================================================
+
+LSPTrafficMonitor::LSPTrafficMonitor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+LSPTrafficMonitor::MethodStats& LSPTrafficMonitor::statsFor(const QString& method)
+{
+    QString key = method.isEmpty() ? QStringLiteral("(unknown)") : method;
+    auto it = m_stats.find(key);
+    if (it == m_stats.end()) {
+        it = m_stats.insert(key, MethodStats());
+        it->method = key;
+    }
+    return *it;
+}
+
+void LSPTrafficMonitor::record(const LSPTrafficEvent& event)
+{
+    MethodStats& stats = statsFor(event.method);
+
+    switch (event.kind) {
+        case LSPTrafficEvent::Kind::Request:
+            ++stats.sent;
+            ++stats.inFlight;
+            ++m_inFlight;
+            stats.bytesOut += event.bytes;
+            m_bytesOut += event.bytes;
+            break;
+
+        case LSPTrafficEvent::Kind::Notification:
+            ++stats.sent;
+            stats.bytesOut += event.bytes;
+            m_bytesOut += event.bytes;
+            break;
+
+        case LSPTrafficEvent::Kind::Response:
+            ++stats.received;
+            stats.bytesIn += event.bytes;
+            m_bytesIn += event.bytes;
+            if (stats.inFlight > 0) {
+                --stats.inFlight;
+                --m_inFlight;
+            }
+            if (event.error) {
+                ++stats.errors;
+            }
+            // Cancelled requests would only skew the distribution
+            if (!event.cancelled && event.serverNs >= 0) {
+                stats.server.add(event.serverNs);
+                stats.decode.add(qMax<qint64>(event.decodeNs, 0));
+                stats.roundTrip.add(event.serverNs + qMax<qint64>(event.decodeNs, 0));
+            }
+            break;
+
+        case LSPTrafficEvent::Kind::ServerNotification:
+            ++stats.received;
+            stats.bytesIn += event.bytes;
+            m_bytesIn += event.bytes;
+            if (event.decodeNs >= 0) {
+                stats.decode.add(event.decodeNs);
+            }
+            break;
+
+        case LSPTrafficEvent::Kind::Cancel:
+            ++stats.cancelled;
+            break;
+    }
+
+    m_events.append(event);
+    if (m_events.size() > MAX_EVENTS) {
+        m_events.removeFirst();
+    }
+
+    emit changed();
+}
+
+void LSPTrafficMonitor::recordDelivery(const QString& method, qint64 ns)
+{
+    statsFor(method).ui.add(ns);
+    emit changed();
+}
+
+void LSPTrafficMonitor::resetInFlight()
+{
+    for (MethodStats& stats : m_stats) {
+        stats.inFlight = 0;
+    }
+    m_inFlight = 0;
+    emit changed();
+}
+
+void LSPTrafficMonitor::clear()
+{
+    m_stats.clear();
+    m_events.clear();
+    m_inFlight = 0;
+    m_bytesOut = 0;
+    m_bytesIn = 0;
+    emit changed();
+}
+
+static QJsonObject latencyToJson(const LatencySamples& samples)
+{
+    QJsonArray histogram;
+    const QList<int> buckets = samples.histogram();
+    for (int i = 0; i < buckets.size(); ++i) {
+        histogram.append(QJsonObject{
+            {"bucket", LatencySamples::bucketLabel(i)},
+            {"count", buckets[i]}
+        });
+    }
+
+    return QJsonObject{
+        {"count", samples.count()},
+        {"p50Ms", samples.percentileMs(50)},
+        {"p95Ms", samples.percentileMs(95)},
+        {"p99Ms", samples.percentileMs(99)},
+        {"histogram", histogram}
+    };
+}
+
+bool LSPTrafficMonitor::exportToFile(const QString& filePath, QString* errorMessage) const
+{
+    QJsonArray methods;
+    for (const MethodStats& stats : m_stats) {
+        methods.append(QJsonObject{
+            {"method", stats.method},
+            {"sent", stats.sent},
+            {"received", stats.received},
+            {"inFlight", stats.inFlight},
+            {"errors", stats.errors},
+            {"cancelled", stats.cancelled},
+            {"bytesOut", stats.bytesOut},
+            {"bytesIn", stats.bytesIn},
+            {"roundTrip", latencyToJson(stats.roundTrip)},
+            {"server", latencyToJson(stats.server)},
+            {"decode", latencyToJson(stats.decode)},
+            {"ui", latencyToJson(stats.ui)}
+        });
+    }
+
+    QJsonArray events;
+    for (const LSPTrafficEvent& event : m_events) {
+        QJsonObject obj{
+            {"timestamp", QDateTime::fromMSecsSinceEpoch(event.timestamp).toString(Qt::ISODateWithMs)},
+            {"kind", LSPTrafficEvent::kindName(event.kind)},
+            {"method", event.method},
+            {"bytes", event.bytes}
+        };
+        if (event.kind != LSPTrafficEvent::Kind::Notification
+            && event.kind != LSPTrafficEvent::Kind::ServerNotification) {
+            obj["id"] = event.id;
+        }
+        if (event.serverNs >= 0) {
+            obj["serverMs"] = event.serverNs / 1e6;
+        }
+        if (event.decodeNs >= 0) {
+            obj["decodeMs"] = event.decodeNs / 1e6;
+        }
+        if (event.error) {
+            obj["error"] = true;
+        }
+        if (event.cancelled) {
+            obj["cancelled"] = true;
+        }
+        events.append(obj);
+    }
+
+    QJsonObject root{
+        {"exported", QDateTime::currentDateTime().toString(Qt::ISODateWithMs)},
+        {"inFlight", m_inFlight},
+        {"bytesOut", m_bytesOut},
+        {"bytesIn", m_bytesIn},
+        {"methods", methods},
+        {"events", events}
+    };
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+} // namespace XXMLStudio
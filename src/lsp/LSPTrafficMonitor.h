@@ -0,0 +1,133 @@
+#ifndef LSPTRAFFICMONITOR_H
+#define LSPTRAFFICMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+
+namespace XXMLStudio {
+
+/**
+ * A single message seen by the JSON-RPC transport.
+ */
+struct LSPTrafficEvent {
+    enum class Kind {
+        Request,            // Client -> server, expects a response
+        Response,           // Server -> client, answers a request
+        Notification,       // Client -> server
+        ServerNotification, // Server -> client
+        Cancel              // Client gave up on a request ($/cancelRequest)
+    };
+
+    Kind kind = Kind::Request;
+    int id = 0;                 // Request id (requests, responses, cancels)
+    QString method;
+    qint64 bytes = 0;           // JSON body size
+    qint64 timestamp = 0;       // Wall clock, ms since epoch
+
+    // Responses only, in nanoseconds
+    qint64 serverNs = -1;       // Request written -> response framed
+    qint64 decodeNs = -1;       // JSON parse + conversion to LSP types
+    bool error = false;
+    bool cancelled = false;     // Response to a request cancelled earlier
+
+    static QString kindName(Kind kind);
+};
+
+/**
+ * Rolling latency distribution: the most recent samples for percentiles
+ * plus a log2 millisecond histogram over the whole session.
+ */
+class LatencySamples
+{
+public:
+    static constexpr int MAX_SAMPLES = 1024;
+    static constexpr int BUCKET_COUNT = 12;     // <1ms, 1-2ms, ... >=1024ms
+
+    void add(qint64 ns);
+    void clear();
+
+    int count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // Percentile (0..100) over the retained samples, in milliseconds
+    double percentileMs(double percentile) const;
+    QList<int> histogram() const { return m_buckets; }
+
+    static QString bucketLabel(int bucket);
+
+private:
+    QList<qint64> m_samples;
+    int m_next = 0;
+    int m_count = 0;
+    QList<int> m_buckets = QList<int>(BUCKET_COUNT, 0);
+};
+
+/**
+ * Aggregates JSON-RPC traffic per method: message counts, in-flight
+ * requests, payload sizes and where response time is spent (server,
+ * worker-thread decoding, GUI-thread delivery).
+ *
+ * Lives on the GUI thread; JsonRpcClient reports events through a
+ * queued connection and LSPClient reports delivery times directly.
+ */
+class LSPTrafficMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct MethodStats {
+        QString method;
+        int sent = 0;
+        int received = 0;
+        int inFlight = 0;
+        int errors = 0;
+        int cancelled = 0;
+        qint64 bytesOut = 0;
+        qint64 bytesIn = 0;
+        LatencySamples roundTrip;   // server + decode
+        LatencySamples server;
+        LatencySamples decode;
+        LatencySamples ui;          // Queued delivery + signal handlers
+    };
+
+    static constexpr int MAX_EVENTS = 5000;
+
+    explicit LSPTrafficMonitor(QObject* parent = nullptr);
+
+    void record(const LSPTrafficEvent& event);
+    void recordDelivery(const QString& method, qint64 ns);
+
+    // Requests outstanding when the server went away will never be answered
+    void resetInFlight();
+    void clear();
+
+    QList<MethodStats> methodStats() const { return m_stats.values(); }
+    QList<LSPTrafficEvent> recentEvents() const { return m_events; }
+    int inFlight() const { return m_inFlight; }
+    qint64 bytesOut() const { return m_bytesOut; }
+    qint64 bytesIn() const { return m_bytesIn; }
+
+    // Write statistics and recent events as JSON
+    bool exportToFile(const QString& filePath, QString* errorMessage = nullptr) const;
+
+signals:
+    void changed();
+
+private:
+    MethodStats& statsFor(const QString& method);
+
+    QMap<QString, MethodStats> m_stats;
+    QList<LSPTrafficEvent> m_events;
+    int m_inFlight = 0;
+    qint64 m_bytesOut = 0;
+    qint64 m_bytesIn = 0;
+};
+
+} // namespace XXMLStudio
+
+Q_DECLARE_METATYPE(XXMLStudio::LSPTrafficEvent)
+
+#endif // LSPTRAFFICMONITOR_H
@@ -0,0 +1,125 @@
+#include "MessageFramer.h"
+
+#include <QByteArrayView>
+
+namespace XXMLStudio {
+
+namespace {
+
+// Compact only once this much has been consumed and it is at least half the buffer
+constexpr qsizetype COMPACT_THRESHOLD = 64 * 1024;
+
+// A header line longer than this cannot be valid; treat it as garbage
+constexpr qsizetype MAX_HEADER_LINE = 64 * 1024;
+
+constexpr char CONTENT_LENGTH[] = "Content-Length";
+constexpr qsizetype CONTENT_LENGTH_SIZE = sizeof(CONTENT_LENGTH) - 1;
+
+} // namespace
+
+void MessageFramer::append(const QByteArray& data)
+{
+    compact();
+    m_buffer.append(data);
+}
+
+MessageFramer::Result MessageFramer::next(QByteArray& body)
+{
+    while (true) {
+        if (m_state == State::Header) {
+            qsizetype lineEnd = m_buffer.indexOf("\r\n", qMax(m_scanOffset, m_offset));
+            if (lineEnd < 0) {
+                if (m_buffer.size() - m_offset > MAX_HEADER_LINE) {
+                    reset();
+                    return Result::Malformed;
+                }
+                // Resume at the last byte in case a CR arrived without its LF
+                m_scanOffset = qMax(m_offset, m_buffer.size() - 1);
+                return Result::NeedMoreData;
+            }
+
+            qsizetype lineStart = m_offset;
+            m_offset = lineEnd + 2;
+            m_scanOffset = m_offset;
+
+            if (lineEnd > lineStart) {
+                parseHeaderLine(lineStart, lineEnd);
+                continue;
+            }
+
+            // Empty line terminates the header block
+            if (m_contentLength < 0) {
+                bool hadFields = m_headerFields > 0;
+                m_headerFields = 0;
+                if (hadFields) {
+                    return Result::Malformed;
+                }
+                continue;  // Stray blank line between messages
+            }
+
+            m_state = State::Body;
+        }
+
+        if (m_buffer.size() - m_offset < m_contentLength) {
+            return Result::NeedMoreData;
+        }
+
+        body = m_buffer.mid(m_offset, m_contentLength);
+        m_offset += m_contentLength;
+        m_scanOffset = m_offset;
+        m_contentLength = -1;
+        m_headerFields = 0;
+        m_state = State::Header;
+        return Result::Message;
+    }
+}
+
+void MessageFramer::reset()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_scanOffset = 0;
+    m_contentLength = -1;
+    m_headerFields = 0;
+    m_state = State::Header;
+}
+
+void MessageFramer::parseHeaderLine(qsizetype lineStart, qsizetype lineEnd)
+{
+    ++m_headerFields;
+
+    // Header names are case-insensitive; other fields (Content-Type) are ignored
+    const char* line = m_buffer.constData() + lineStart;
+    qsizetype length = lineEnd - lineStart;
+    if (length <= CONTENT_LENGTH_SIZE || line[CONTENT_LENGTH_SIZE] != ':'
+        || qstrnicmp(line, CONTENT_LENGTH, CONTENT_LENGTH_SIZE) != 0) {
+        return;
+    }
+
+    QByteArrayView value(line + CONTENT_LENGTH_SIZE + 1, length - CONTENT_LENGTH_SIZE - 1);
+    bool ok = false;
+    qlonglong contentLength = value.trimmed().toLongLong(&ok);
+    if (ok && contentLength >= 0) {
+        m_contentLength = contentLength;
+    }
+}
+
+void MessageFramer::compact()
+{
+    if (m_offset == 0) {
+        return;
+    }
+
+    if (m_offset == m_buffer.size()) {
+        // Everything consumed: keep the allocation, drop the contents
+        m_buffer.truncate(0);
+        m_scanOffset = 0;
+        m_offset = 0;
+    } else if (m_offset >= COMPACT_THRESHOLD && m_offset * 2 >= m_buffer.size()) {
+        m_buffer.remove(0, m_offset);
+        m_scanOffset -= m_offset;
+        m_offset = 0;
+    }
+}
+
+} // namespace XXMLStudio
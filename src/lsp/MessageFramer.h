@@ -0,0 +1,57 @@
+#ifndef MESSAGEFRAMER_H
+#define MESSAGEFRAMER_H
+
+#include <QByteArray>
+
+namespace XXMLStudio {
+
+/**
+ * Incremental parser for the LSP base protocol framing
+ * (header fields terminated by an empty line, followed by a
+ * Content-Length sized body).
+ *
+ * Data is appended as it arrives and scanned in place from a read
+ * offset, so a burst of messages is parsed in linear time. The buffer
+ * is only compacted once the consumed prefix dominates it.
+ */
+class MessageFramer
+{
+public:
+    enum class Result {
+        NeedMoreData,   // No complete message buffered yet
+        Message,        // A message body was extracted
+        Malformed       // A header block without a valid Content-Length was skipped
+    };
+
+    // Append raw bytes read from the transport
+    void append(const QByteArray& data);
+
+    // Extract the next complete message body, if any
+    Result next(QByteArray& body);
+
+    // Drop all buffered data and parser state
+    void reset();
+
+    // Number of bytes received but not yet consumed
+    qsizetype bufferedBytes() const { return m_buffer.size() - m_offset; }
+
+private:
+    enum class State {
+        Header,
+        Body
+    };
+
+    void parseHeaderLine(qsizetype lineStart, qsizetype lineEnd);
+    void compact();
+
+    QByteArray m_buffer;
+    qsizetype m_offset = 0;         // Start of unconsumed data (current header line or body)
+    qsizetype m_scanOffset = 0;     // Where the search for the next CRLF resumes
+    qsizetype m_contentLength = -1;
+    int m_headerFields = 0;         // Fields seen in the current header block
+    State m_state = State::Header;
+};
+
+} // namespace XXMLStudio
+
+#endif // MESSAGEFRAMER_H
@@ -0,0 +1,195 @@
+#include "FindInFilesPanel.h"
+
+#include <QDir>
+#include <QHBoxLayout>
+
+namespace XXMLStudio {
+
+namespace {
+
+enum Role {
+    FileRole = Qt::UserRole,
+    LineRole,
+    ColumnRole
+};
+
+} // namespace
+
+FindInFilesPanel::FindInFilesPanel(QWidget* parent)
+    : QWidget(parent)
+{
+    setupUi();
+
+    m_search = new FindInFiles(this);
+    connect(m_search, &FindInFiles::resultsFound, this, &FindInFilesPanel::addResults);
+    connect(m_search, &FindInFiles::progressChanged, this, &FindInFilesPanel::updateSummary);
+    connect(m_search, &FindInFiles::finished, this, [this]() {
+        m_searchButton->setText(tr("Search"));
+        updateSummary();
+    });
+}
+
+FindInFilesPanel::~FindInFilesPanel()
+{
+    // The search reports finishing when it is destroyed, after the
+    // widgets it would update
+    disconnect(m_search, nullptr, this, nullptr);
+}
+
+void FindInFilesPanel::setupUi()
+{
+    m_layout = new QVBoxLayout(this);
+    m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->setSpacing(0);
+
+    // Search bar
+    QHBoxLayout* searchLayout = new QHBoxLayout();
+    searchLayout->setContentsMargins(4, 4, 4, 4);
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Search in project..."));
+    m_searchEdit->setClearButtonEnabled(true);
+    searchLayout->addWidget(m_searchEdit, 1);
+
+    m_caseSensitiveCheck = new QCheckBox(tr("Case sensitive"), this);
+    searchLayout->addWidget(m_caseSensitiveCheck);
+
+    m_wholeWordCheck = new QCheckBox(tr("Whole word"), this);
+    searchLayout->addWidget(m_wholeWordCheck);
+
+    m_regexCheck = new QCheckBox(tr("Regular expression"), this);
+    searchLayout->addWidget(m_regexCheck);
+
+    m_searchButton = new QPushButton(tr("Search"), this);
+    searchLayout->addWidget(m_searchButton);
+
+    m_layout->addLayout(searchLayout);
+
+    // Summary label
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("padding: 4px; background-color: #2d2d2d;");
+    m_layout->addWidget(m_summaryLabel);
+
+    // Results tree: one row per file, its matches below
+    m_treeView = new QTreeView(this);
+    m_treeView->setHeaderHidden(true);
+    m_treeView->setUniformRowHeights(true);
+    m_treeView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_treeView->setIndentation(16);
+    m_layout->addWidget(m_treeView);
+
+    m_model = new QStandardItemModel(this);
+    m_treeView->setModel(m_model);
+
+    // Connect signals
+    connect(m_treeView, &QTreeView::doubleClicked,
+            this, &FindInFilesPanel::onItemDoubleClicked);
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, &FindInFilesPanel::searchRequested);
+    connect(m_searchButton, &QPushButton::clicked, this, [this]() {
+        if (m_search->isRunning()) {
+            cancel();
+        } else {
+            emit searchRequested();
+        }
+    });
+}
+
+void FindInFilesPanel::activate(const QString& text)
+{
+    if (!text.isEmpty()) {
+        m_searchEdit->setText(text);
+    }
+    m_searchEdit->setFocus();
+    m_searchEdit->selectAll();
+}
+
+void FindInFilesPanel::search(const QString& rootPath, const QStringList& excludedPaths,
+                              const QHash<QString, QString>& buffers)
+{
+    m_search->cancel();
+    m_model->clear();
+    m_fileMatchCount = 0;
+    m_rootPath = rootPath;
+
+    FindInFiles::Query query;
+    query.pattern = m_searchEdit->text();
+    query.options.caseSensitive = m_caseSensitiveCheck->isChecked();
+    query.options.wholeWord = m_wholeWordCheck->isChecked();
+    query.options.useRegex = m_regexCheck->isChecked();
+    query.rootPath = rootPath;
+    query.excludedPaths = excludedPaths;
+
+    TextSearch check(query.pattern, query.options);
+    if (!check.isValid()) {
+        m_summaryLabel->setText(query.pattern.isEmpty() ? QString()
+                                                        : tr("Invalid regular expression: %1").arg(check.errorString()));
+        return;
+    }
+
+    if (m_index && m_index->isReady() && m_index->rootPath() == QDir::cleanPath(rootPath)) {
+        query.useFiles = m_index->candidates(query.pattern, query.options, query.files);
+        if (query.useFiles) {
+            query.moreFiles = m_index->unindexedFiles();
+        }
+    }
+
+    m_search->start(query, buffers);
+    m_searchButton->setText(tr("Stop"));
+    updateSummary();
+}
+
+void FindInFilesPanel::cancel()
+{
+    m_search->cancel();
+}
+
+void FindInFilesPanel::addResults(const QList<FindInFiles::FileResult>& results)
+{
+    QDir root(m_rootPath);
+    for (const FindInFiles::FileResult& result : results) {
+        QStandardItem* fileItem = new QStandardItem(
+            QString("%1 (%2)").arg(QDir::toNativeSeparators(root.relativeFilePath(result.filePath)))
+                              .arg(result.matches.size()));
+        fileItem->setData(result.filePath, FileRole);
+        fileItem->setToolTip(QDir::toNativeSeparators(result.filePath));
+
+        QList<QStandardItem*> rows;
+        rows.reserve(result.matches.size());
+        for (const FindInFiles::Match& match : result.matches) {
+            QStandardItem* matchItem = new QStandardItem(
+                QString("%1: %2").arg(match.line).arg(match.lineText.trimmed()));
+            matchItem->setData(result.filePath, FileRole);
+            matchItem->setData(match.line, LineRole);
+            matchItem->setData(match.column, ColumnRole);
+            rows.append(matchItem);
+        }
+        fileItem->appendRows(rows);
+        m_model->appendRow(fileItem);
+        ++m_fileMatchCount;
+    }
+    updateSummary();
+}
+
+void FindInFilesPanel::updateSummary()
+{
+    QString text = tr("%n match(es) in %1 file(s)", "", m_search->matchCount()).arg(m_fileMatchCount);
+    text += tr(", %n file(s) searched", "", m_search->fileCount());
+    if (m_search->isRunning()) {
+        text += tr(" - searching...");
+    } else if (m_search->limitReached()) {
+        text += tr(" - stopped after %1 matches").arg(FindInFiles::MAX_MATCHES);
+    }
+    m_summaryLabel->setText(text);
+}
+
+void FindInFilesPanel::onItemDoubleClicked(const QModelIndex& index)
+{
+    QString file = index.data(FileRole).toString();
+    int line = index.data(LineRole).toInt();
+    if (file.isEmpty() || line <= 0) {
+        return;
+    }
+    emit matchActivated(file, line, index.data(ColumnRole).toInt());
+}
+
+} // namespace XXMLStudio
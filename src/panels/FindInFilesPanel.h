@@ -0,0 +1,74 @@
+#ifndef FINDINFILESPANEL_H
+#define FINDINFILESPANEL_H
+
+#include <QWidget>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include <QStandardItemModel>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include "../editor/FindInFiles.h"
+#include "../project/TrigramIndex.h"
+
+namespace XXMLStudio {
+
+/**
+ * Panel for searching the whole project, listing matches grouped by
+ * file as the search finds them.
+ */
+class FindInFilesPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FindInFilesPanel(QWidget* parent = nullptr);
+    ~FindInFilesPanel();
+
+    // Focus the search field, optionally filled with text
+    void activate(const QString& text = QString());
+
+    // Search the tree; buffers maps paths to unsaved editor text
+    void search(const QString& rootPath, const QStringList& excludedPaths,
+                const QHash<QString, QString>& buffers);
+    void cancel();
+
+    // Narrow searches down with an index of the tree, when it covers it
+    void setIndex(TrigramIndex* index) { m_index = index; }
+
+    QString searchText() const { return m_searchEdit->text(); }
+
+signals:
+    // The user asked for a search; the receiver supplies the context
+    // and calls search()
+    void searchRequested();
+    void matchActivated(const QString& file, int line, int column);
+
+private slots:
+    void onItemDoubleClicked(const QModelIndex& index);
+
+private:
+    void setupUi();
+    void addResults(const QList<FindInFiles::FileResult>& results);
+    void updateSummary();
+
+    QVBoxLayout* m_layout = nullptr;
+    QLineEdit* m_searchEdit = nullptr;
+    QCheckBox* m_caseSensitiveCheck = nullptr;
+    QCheckBox* m_wholeWordCheck = nullptr;
+    QCheckBox* m_regexCheck = nullptr;
+    QPushButton* m_searchButton = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    QTreeView* m_treeView = nullptr;
+    QStandardItemModel* m_model = nullptr;
+
+    FindInFiles* m_search = nullptr;
+    TrigramIndex* m_index = nullptr;
+    QString m_rootPath;
+    int m_fileMatchCount = 0;
+};
+
+} // namespace XXMLStudio
+
+#endif // FINDINFILESPANEL_H
@@ -158,8 +158,15 @@ void GitChangesPanel::setupChangesTree()
     m_changesTree->setContextMenuPolicy(Qt::CustomContextMenu);
     m_changesTree->setAnimated(true);
 
-    // Expand all sections by default
+    // Expand all sections by default. The model updates rows in place,
+    // so a section the user collapses stays collapsed until it empties.
     m_changesTree->expandAll();
+    connect(m_statusModel, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex& parent, int first, int last) {
+        if (parent.isValid() && m_statusModel->rowCount(parent) == last - first + 1) {
+            m_changesTree->expand(parent);
+        }
+    });
 
     // Context menu actions
     m_stageAction = new QAction(tr("Stage"), this);
@@ -317,9 +324,6 @@ void GitChangesPanel::onStatusRefreshed(const GitRepositoryStatus& status)
              << "entries:" << status.entries.size();
     m_statusModel->setStatus(status);
 
-    // Expand all sections after refresh
-    m_changesTree->expandAll();
-
     qDebug() << "[GitChangesPanel] Model row count at root:" << m_statusModel->rowCount()
              << "staged:" << m_statusModel->stagedEntries().size()
              << "unstaged:" << m_statusModel->unstagedEntries().size()
@@ -12,6 +12,11 @@ namespace XXMLStudio {
 GitFileDecorator::GitFileDecorator(QObject* parent)
     : QIdentityProxyModel(parent)
 {
+    // The proxy forwards the source model's structural changes
+    connect(this, &QAbstractItemModel::rowsAboutToBeRemoved, this, &GitFileDecorator::clearRelativePaths);
+    connect(this, &QAbstractItemModel::rowsAboutToBeMoved, this, &GitFileDecorator::clearRelativePaths);
+    connect(this, &QAbstractItemModel::layoutAboutToBeChanged, this, &GitFileDecorator::clearRelativePaths);
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, this, &GitFileDecorator::clearRelativePaths);
 }
 
 GitFileDecorator::~GitFileDecorator()
@@ -39,7 +44,10 @@ void GitFileDecorator::setGitManager(GitManager* manager)
 void GitFileDecorator::setRootPath(const QString& path)
 {
     m_rootPath = path;
-    m_statusCache.clear();
+    m_fileStatus.clear();
+    m_directoryStatus.clear();
+    m_paintedPaths.clear();
+    clearRelativePaths();
 }
 
 void GitFileDecorator::setCompilationEntrypoint(const QString& relativePath)
@@ -59,41 +67,108 @@ void GitFileDecorator::onRepositoryChanged(bool isGitRepo)
 {
     m_hasGitRepo = isGitRepo;
     if (!isGitRepo) {
-        m_statusCache.clear();
-        // Emit data changed for all items
-        if (sourceModel()) {
-            emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
-        }
+        updateStatus({}, {});
     }
 }
 
 void GitFileDecorator::onStatusRefreshed(const GitRepositoryStatus& status)
 {
-    m_statusCache.clear();
+    QHash<QString, GitFileStatus> fileStatuses;
+    QHash<QString, GitFileStatus> directoryStatuses;
+    fileStatuses.reserve(status.entries.size());
 
     for (const GitStatusEntry& entry : status.entries) {
-        m_statusCache[entry.path] = entry;
+        GitFileStatus fileStatus = displayStatus(entry);
+        if (fileStatus != GitFileStatus::Unmodified) {
+            fileStatuses.insert(entry.path, fileStatus);
+        }
+
+        // Raise each ancestor to this entry's status; once one already
+        // has it, so do all above it
+        const int rank = severity(fileStatus);
+        for (int slash = entry.path.lastIndexOf('/'); slash > 0; slash = entry.path.lastIndexOf('/', slash - 1)) {
+            auto it = directoryStatuses.find(entry.path.left(slash));
+            if (it == directoryStatuses.end()) {
+                directoryStatuses.insert(entry.path.left(slash), fileStatus);
+            } else if (severity(*it) < rank) {
+                *it = fileStatus;
+            } else {
+                break;
+            }
+        }
     }
 
-    // Emit data changed for all items
-    if (sourceModel()) {
-        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+    updateStatus(std::move(fileStatuses), std::move(directoryStatuses));
+}
+
+void GitFileDecorator::updateStatus(QHash<QString, GitFileStatus> fileStatuses,
+                                    QHash<QString, GitFileStatus> directoryStatuses)
+{
+    // Paths whose entry appeared, went away or changed; a directory only
+    // when the worst status below it did
+    QSet<QString> changed;
+    auto collectChanges = [&changed](const QHash<QString, GitFileStatus>& before,
+                                     const QHash<QString, GitFileStatus>& after) {
+        for (auto it = before.cbegin(); it != before.cend(); ++it) {
+            auto now = after.constFind(it.key());
+            if (now == after.cend() || *now != it.value()) {
+                changed.insert(it.key());
+            }
+        }
+        for (auto it = after.cbegin(); it != after.cend(); ++it) {
+            if (!before.contains(it.key())) {
+                changed.insert(it.key());
+            }
+        }
+    };
+    collectChanges(m_fileStatus, fileStatuses);
+    collectChanges(m_directoryStatus, directoryStatuses);
+
+    m_fileStatus = std::move(fileStatuses);
+    m_directoryStatus = std::move(directoryStatuses);
+
+    QFileSystemModel* fsModel = qobject_cast<QFileSystemModel*>(sourceModel());
+    if (!fsModel) {
+        return;
+    }
+    QDir rootDir(m_rootPath);
+    for (const QString& relativePath : std::as_const(changed)) {
+        // Rows never painted ask for their color when they are; looking
+        // them up would make the file system model load them
+        if (!m_paintedPaths.contains(relativePath)) {
+            continue;
+        }
+        QModelIndex changedIndex = mapFromSource(fsModel->index(rootDir.filePath(relativePath)));
+        if (changedIndex.isValid()) {
+            emit dataChanged(changedIndex, changedIndex, {Qt::ForegroundRole});
+        }
     }
 }
 
+void GitFileDecorator::clearRelativePaths()
+{
+    m_relativePaths.clear();
+}
+
 QString GitFileDecorator::getRelativePath(const QModelIndex& index) const
 {
     if (!sourceModel() || m_rootPath.isEmpty()) {
         return QString();
     }
 
+    const QModelIndex sourceIndex = mapToSource(index);
+    auto cached = m_relativePaths.constFind(sourceIndex.internalPointer());
+    if (cached != m_relativePaths.constEnd()) {
+        return *cached;
+    }
+
     // Get the file path from the source model (QFileSystemModel)
     QFileSystemModel* fsModel = qobject_cast<QFileSystemModel*>(sourceModel());
     if (!fsModel) {
         return QString();
     }
 
-    QString filePath = fsModel->filePath(mapToSource(index));
+    QString filePath = fsModel->filePath(sourceIndex);
     if (filePath.isEmpty()) {
         return QString();
     }
@@ -105,6 +180,8 @@ QString GitFileDecorator::getRelativePath(const QModelIndex& index) const
     // Normalize to forward slashes (Git uses forward slashes)
     relativePath = relativePath.replace('\\', '/');
 
+    m_relativePaths.insert(sourceIndex.internalPointer(), relativePath);
+    m_paintedPaths.insert(relativePath);
     return relativePath;
 }
 
@@ -129,34 +206,21 @@ QVariant GitFileDecorator::data(const QModelIndex& index, int role) const
     }
 
     // Add foreground color based on Git status
-    if (role == Qt::ForegroundRole && m_hasGitRepo) {
+    if (role == Qt::ForegroundRole) {
+        // Resolved even without a repository, so rows painted before
+        // `git init` are known when the first status arrives
         QString relativePath = getRelativePath(index);
 
-        if (!relativePath.isEmpty() && m_statusCache.contains(relativePath)) {
-            const GitStatusEntry& entry = m_statusCache[relativePath];
-
-            // Use work tree status if unstaged, otherwise index status
-            GitFileStatus status = GitFileStatus::Unmodified;
-            if (entry.isUntracked()) {
-                status = GitFileStatus::Untracked;
-            } else if (entry.isUnstaged()) {
-                status = entry.workTreeStatus;
-            } else if (entry.isStaged()) {
-                status = entry.indexStatus;
-            }
-
-            if (status != GitFileStatus::Unmodified) {
-                return statusColor(status);
+        if (m_hasGitRepo && !relativePath.isEmpty()) {
+            auto file = m_fileStatus.constFind(relativePath);
+            if (file != m_fileStatus.constEnd()) {
+                return statusColor(*file);
             }
-        }
 
-        // Check if any parent directory has this file as part of its path
-        // (e.g., if "src/foo.cpp" is modified, we might want to mark "src" folder)
-        for (auto it = m_statusCache.begin(); it != m_statusCache.end(); ++it) {
-            if (it.key().startsWith(relativePath + "/")) {
-                // This is a directory containing modified files
-                // Use a subtle indicator (dimmed orange)
-                return QColor("#8b7355");
+            // A directory containing changed files
+            auto directory = m_directoryStatus.constFind(relativePath);
+            if (directory != m_directoryStatus.constEnd()) {
+                return directoryColor(*directory);
             }
         }
     }
@@ -184,6 +248,43 @@ QColor GitFileDecorator::statusColor(GitFileStatus status) const
     }
 }
 
+QColor GitFileDecorator::directoryColor(GitFileStatus status) const
+{
+    if (status == GitFileStatus::Conflicted) {
+        return statusColor(status);
+    }
+    // Use a subtle indicator (dimmed orange)
+    return QColor("#8b7355");
+}
+
+GitFileStatus GitFileDecorator::displayStatus(const GitStatusEntry& entry)
+{
+    // Use work tree status if unstaged, otherwise index status
+    if (entry.isUntracked()) {
+        return GitFileStatus::Untracked;
+    } else if (entry.isUnstaged()) {
+        return entry.workTreeStatus;
+    } else if (entry.isStaged()) {
+        return entry.indexStatus;
+    }
+    return GitFileStatus::Unmodified;
+}
+
+int GitFileDecorator::severity(GitFileStatus status)
+{
+    switch (status) {
+    case GitFileStatus::Conflicted: return 4;
+    case GitFileStatus::Deleted: return 3;
+    case GitFileStatus::Modified:
+    case GitFileStatus::Added:
+    case GitFileStatus::Renamed:
+    case GitFileStatus::Copied:
+    case GitFileStatus::TypeChanged: return 2;
+    case GitFileStatus::Untracked: return 1;
+    default: return 0;
+    }
+}
+
 QIcon GitFileDecorator::createEntrypointIcon(const QIcon& baseIcon) const
 {
     // Create icon with multiple sizes for proper scaling
@@ -4,6 +4,7 @@
 #include <QIdentityProxyModel>
 #include <QIcon>
 #include <QHash>
+#include <QSet>
 #include "git/GitTypes.h"
 
 namespace XXMLStudio {
@@ -19,6 +20,13 @@ class GitManager;
  *   - Added: Green
  *   - Deleted: Red
  *   - Untracked: Gray
+ *
+ * Directories containing changes get a dimmed color, or red when a
+ * conflict is somewhere below them. Each directory's worst status is
+ * worked out once per status refresh, and each row's relative path is
+ * kept until the rows change, so painting a row costs two hash lookups
+ * however many files have changed. A refresh compares the new statuses
+ * with the old ones and only signals the rows whose color changed.
  */
 class GitFileDecorator : public QIdentityProxyModel
 {
@@ -41,7 +49,17 @@ private slots:
 
 private:
     QColor statusColor(GitFileStatus status) const;
+    QColor directoryColor(GitFileStatus status) const;
     QString getRelativePath(const QModelIndex& index) const;
+    void clearRelativePaths();
+    // Replaces the statuses and signals the rows that look different
+    void updateStatus(QHash<QString, GitFileStatus> fileStatuses,
+                      QHash<QString, GitFileStatus> directoryStatuses);
+
+    // The status a file is shown with, Unmodified if none
+    static GitFileStatus displayStatus(const GitStatusEntry& entry);
+    // Higher is more important to show on a directory
+    static int severity(GitFileStatus status);
     QIcon createEntrypointIcon(const QIcon& baseIcon) const;
 
     GitManager* m_gitManager = nullptr;
@@ -49,8 +67,17 @@ private:
     bool m_hasGitRepo = false;
     QString m_compilationEntrypoint;  // Relative path to entrypoint file
 
-    // Cache: relative path -> status entry
-    QHash<QString, GitStatusEntry> m_statusCache;
+    // Relative path -> status shown for a changed file
+    QHash<QString, GitFileStatus> m_fileStatus;
+    // Relative path -> worst status of anything below a directory
+    QHash<QString, GitFileStatus> m_directoryStatus;
+
+    // Source node -> relative path; cleared whenever rows go away, as
+    // their nodes may be reused
+    mutable QHash<const void*, QString> m_relativePaths;
+    // Relative paths the view has asked about; only those rows can be
+    // showing a stale color
+    mutable QSet<QString> m_paintedPaths;
 };
 
 } // namespace XXMLStudio
@@ -0,0 +1,304 @@
+#include "LSPTrafficPanel.h"
+#include "lsp/LSPTrafficMonitor.h"
+
+#include <QAction>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QMessageBox>
+#include <QSplitter>
+#include <algorithm>
+
+namespace XXMLStudio {
+
+namespace {
+
+enum Column {
+    MethodColumn,
+    SentColumn,
+    ReceivedColumn,
+    InFlightColumn,
+    ErrorsColumn,
+    CancelledColumn,
+    BytesOutColumn,
+    BytesInColumn,
+    P50Column,
+    P95Column,
+    P99Column,
+    ServerP95Column,
+    DecodeP95Column,
+    UiP95Column,
+    ColumnCount
+};
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes < 1024) {
+        return QString("%1 B").arg(bytes);
+    }
+    if (bytes < 1024 * 1024) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString formatLatency(const LatencySamples& samples, double percentile)
+{
+    if (samples.isEmpty()) {
+        return QString("-");
+    }
+    return QString("%1 ms").arg(samples.percentileMs(percentile), 0, 'f', 1);
+}
+
+} // namespace
+
+LSPTrafficPanel::LSPTrafficPanel(QWidget* parent)
+    : QWidget(parent)
+{
+    setupUi();
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &LSPTrafficPanel::refresh);
+}
+
+LSPTrafficPanel::~LSPTrafficPanel()
+{
+}
+
+void LSPTrafficPanel::setupUi()
+{
+    m_layout = new QVBoxLayout(this);
+    m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->setSpacing(0);
+
+    // Toolbar
+    m_toolbar = new QToolBar(this);
+    m_toolbar->setIconSize(QSize(16, 16));
+
+    QAction* clearAction = m_toolbar->addAction(tr("Clear"));
+    connect(clearAction, &QAction::triggered, this, [this]() {
+        if (m_monitor) {
+            m_monitor->clear();
+        }
+    });
+
+    QAction* exportAction = m_toolbar->addAction(tr("Export..."));
+    connect(exportAction, &QAction::triggered, this, &LSPTrafficPanel::exportToFile);
+
+    m_toolbar->addSeparator();
+    m_summaryLabel = new QLabel(tr("No traffic"), this);
+    m_summaryLabel->setStyleSheet("padding: 0 4px;");
+    m_toolbar->addWidget(m_summaryLabel);
+
+    m_layout->addWidget(m_toolbar);
+
+    QSplitter* splitter = new QSplitter(Qt::Horizontal, this);
+
+    // Per-method table
+    m_tableView = new QTableView(splitter);
+    m_tableView->setShowGrid(false);
+    m_tableView->setAlternatingRowColors(true);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableView->verticalHeader()->hide();
+    m_tableView->horizontalHeader()->setStretchLastSection(true);
+
+    m_model = new QStandardItemModel(0, ColumnCount, this);
+    m_model->setHorizontalHeaderLabels({
+        tr("Method"), tr("Sent"), tr("Received"), tr("In Flight"), tr("Errors"),
+        tr("Cancelled"), tr("Out"), tr("In"), tr("p50"), tr("p95"), tr("p99"),
+        tr("Server p95"), tr("Decode p95"), tr("UI p95")
+    });
+    m_tableView->setModel(m_model);
+    m_tableView->setColumnWidth(MethodColumn, 220);
+    for (int column = SentColumn; column < ColumnCount; ++column) {
+        m_tableView->setColumnWidth(column, 75);
+    }
+
+    connect(m_tableView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &LSPTrafficPanel::updateHistogram);
+
+    // Histogram of the selected method
+    m_histogramView = new QPlainTextEdit(splitter);
+    m_histogramView->setReadOnly(true);
+    m_histogramView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    QFont font("Consolas", 9);
+    font.setStyleHint(QFont::Monospace);
+    m_histogramView->setFont(font);
+
+    splitter->addWidget(m_tableView);
+    splitter->addWidget(m_histogramView);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+    m_layout->addWidget(splitter);
+}
+
+void LSPTrafficPanel::setTrafficMonitor(LSPTrafficMonitor* monitor)
+{
+    if (m_monitor) {
+        disconnect(m_monitor, nullptr, this, nullptr);
+    }
+
+    m_monitor = monitor;
+
+    if (m_monitor) {
+        connect(m_monitor, &LSPTrafficMonitor::changed, this, [this]() {
+            // Only repaint while someone is looking
+            if (isVisible() && !m_refreshTimer->isActive()) {
+                m_refreshTimer->start();
+            }
+        });
+    }
+
+    refresh();
+}
+
+void LSPTrafficPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+}
+
+QString LSPTrafficPanel::selectedMethod() const
+{
+    QModelIndex current = m_tableView->currentIndex();
+    if (!current.isValid()) {
+        return QString();
+    }
+    return m_model->item(current.row(), MethodColumn)->text();
+}
+
+void LSPTrafficPanel::refresh()
+{
+    if (!m_monitor) {
+        return;
+    }
+
+    QString selected = selectedMethod();
+    const QList<LSPTrafficMonitor::MethodStats> allStats = m_monitor->methodStats();
+
+    m_model->setRowCount(allStats.size());
+    int selectedRow = -1;
+    for (int row = 0; row < allStats.size(); ++row) {
+        const LSPTrafficMonitor::MethodStats& stats = allStats[row];
+        if (stats.method == selected) {
+            selectedRow = row;
+        }
+
+        const QStringList values = {
+            stats.method,
+            QString::number(stats.sent),
+            QString::number(stats.received),
+            QString::number(stats.inFlight),
+            QString::number(stats.errors),
+            QString::number(stats.cancelled),
+            formatBytes(stats.bytesOut),
+            formatBytes(stats.bytesIn),
+            formatLatency(stats.roundTrip, 50),
+            formatLatency(stats.roundTrip, 95),
+            formatLatency(stats.roundTrip, 99),
+            formatLatency(stats.server, 95),
+            formatLatency(stats.decode, 95),
+            formatLatency(stats.ui, 95)
+        };
+
+        for (int column = 0; column < ColumnCount; ++column) {
+            QStandardItem* item = m_model->item(row, column);
+            if (!item) {
+                item = new QStandardItem();
+                if (column != MethodColumn) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_model->setItem(row, column, item);
+            }
+            item->setText(values[column]);
+        }
+    }
+
+    if (selectedRow >= 0) {
+        m_tableView->setCurrentIndex(m_model->index(selectedRow, MethodColumn));
+    }
+
+    m_summaryLabel->setText(tr("In flight: %1   Sent: %2   Received: %3")
+        .arg(m_monitor->inFlight())
+        .arg(formatBytes(m_monitor->bytesOut()))
+        .arg(formatBytes(m_monitor->bytesIn())));
+
+    updateHistogram();
+}
+
+void LSPTrafficPanel::updateHistogram()
+{
+    m_histogramView->clear();
+    if (!m_monitor) {
+        return;
+    }
+
+    QString method = selectedMethod();
+    if (method.isEmpty()) {
+        m_histogramView->setPlainText(tr("Select a method to see its latency histogram."));
+        return;
+    }
+
+    const QList<LSPTrafficMonitor::MethodStats> allStats = m_monitor->methodStats();
+    for (const LSPTrafficMonitor::MethodStats& stats : allStats) {
+        if (stats.method != method) {
+            continue;
+        }
+
+        QStringList lines;
+        lines << method;
+
+        auto appendHistogram = [&lines](const QString& title, const LatencySamples& samples) {
+            lines << QString() << QString("%1 (%2 samples)").arg(title).arg(samples.count());
+            if (samples.isEmpty()) {
+                return;
+            }
+
+            const QList<int> buckets = samples.histogram();
+            int maxCount = *std::max_element(buckets.begin(), buckets.end());
+            for (int i = 0; i < buckets.size(); ++i) {
+                if (buckets[i] == 0) {
+                    continue;
+                }
+                int width = qMax(1, buckets[i] * 30 / maxCount);
+                lines << QString("%1 %2 %3")
+                             .arg(LatencySamples::bucketLabel(i), 12)
+                             .arg(QString(width, QChar(0x2588)), -30)
+                             .arg(buckets[i]);
+            }
+        };
+
+        appendHistogram(tr("Round trip"), stats.roundTrip);
+        appendHistogram(tr("Server"), stats.server);
+        appendHistogram(tr("Decode"), stats.decode);
+        appendHistogram(tr("UI delivery"), stats.ui);
+
+        m_histogramView->setPlainText(lines.join('\n'));
+        return;
+    }
+}
+
+void LSPTrafficPanel::exportToFile()
+{
+    if (!m_monitor) {
+        return;
+    }
+
+    QString path = QFileDialog::getSaveFileName(this, tr("Export LSP Traffic"),
+        QString("lsp-traffic.json"), tr("JSON Files (*.json);;All Files (*)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QString errorMessage;
+    if (!m_monitor->exportToFile(path, &errorMessage)) {
+        QMessageBox::warning(this, tr("Export Failed"),
+            tr("Could not write %1:\n%2").arg(path, errorMessage));
+    }
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,60 @@
+#ifndef LSPTRAFFICPANEL_H
+#define LSPTRAFFICPANEL_H
+
+#include <QWidget>
+#include <QTableView>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
+#include <QStandardItemModel>
+#include <QToolBar>
+#include <QLabel>
+#include <QTimer>
+
+namespace XXMLStudio {
+
+class LSPTrafficMonitor;
+
+/**
+ * Panel showing LSP traffic per method: message counts, in-flight
+ * requests, payload sizes and p50/p95/p99 latencies split into server,
+ * decoding and UI delivery time, with a histogram for the selected method.
+ */
+class LSPTrafficPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LSPTrafficPanel(QWidget* parent = nullptr);
+    ~LSPTrafficPanel();
+
+    void setTrafficMonitor(LSPTrafficMonitor* monitor);
+
+public slots:
+    void refresh();
+    void exportToFile();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+private:
+    void setupUi();
+    void updateHistogram();
+    QString selectedMethod() const;
+
+    QVBoxLayout* m_layout = nullptr;
+    QToolBar* m_toolbar = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    QTableView* m_tableView = nullptr;
+    QStandardItemModel* m_model = nullptr;
+    QPlainTextEdit* m_histogramView = nullptr;
+
+    LSPTrafficMonitor* m_monitor = nullptr;
+
+    // Traffic can arrive in bursts; repaint at most this often
+    QTimer* m_refreshTimer = nullptr;
+    static constexpr int REFRESH_INTERVAL_MS = 500;
+};
+
+} // namespace XXMLStudio
+
+#endif // LSPTRAFFICPANEL_H
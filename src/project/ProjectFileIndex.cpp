@@ -0,0 +1,139 @@
+#include "ProjectFileIndex.h"
+#include "ProjectWatcher.h"
+#include "../core/FuzzyMatcher.h"
+
+#include <QDir>
+#include <QHash>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace XXMLStudio {
+
+namespace {
+
+using SnapshotPtr = std::shared_ptr<const ProjectFileIndex::Snapshot>;
+
+SnapshotPtr build(std::shared_ptr<const ProjectWatcher::Tree> tree)
+{
+    QStringList relativePaths;
+    relativePaths.reserve(tree->files.size());
+    const qsizetype prefixLength = tree->rootPath.size() + 1;
+    for (const QString& path : tree->files) {
+        relativePaths.append(path.mid(prefixLength));
+    }
+    return ProjectFileIndex::snapshotOf(tree->rootPath, relativePaths);
+}
+
+} // namespace
+
+QString ProjectFileIndex::Snapshot::relativePath(int file) const
+{
+    const QString& dir = directories[files[file].directory];
+    return dir.isEmpty() ? names[files[file].name] : dir + QLatin1Char('/') + names[files[file].name];
+}
+
+QString ProjectFileIndex::Snapshot::absolutePath(int file) const
+{
+    return rootPath + QLatin1Char('/') + relativePath(file);
+}
+
+ProjectFileIndex::ProjectFileIndex(ProjectWatcher* watcher, QObject* parent)
+    : QObject(parent)
+    , m_watcher(watcher)
+{
+    connect(m_watcher, &ProjectWatcher::treeChanged, this, &ProjectFileIndex::rebuild);
+
+    connect(&m_buildWatcher, &QFutureWatcher<SnapshotPtr>::finished, this, [this]() {
+        if (m_rootPath.isEmpty() || m_buildWatcher.isCanceled() || m_buildWatcher.future().resultCount() == 0) {
+            return;
+        }
+        SnapshotPtr snapshot = m_buildWatcher.result();
+        if (snapshot->rootPath != m_rootPath) {
+            return;     // Built from a tree no longer shown
+        }
+        m_snapshot = std::move(snapshot);
+        emit changed();
+    });
+}
+
+ProjectFileIndex::~ProjectFileIndex()
+{
+    close();
+}
+
+void ProjectFileIndex::open(const QString& rootPath)
+{
+    close();
+    m_rootPath = QDir::cleanPath(rootPath);
+    rebuild();
+}
+
+void ProjectFileIndex::close()
+{
+    if (m_rootPath.isEmpty()) return;
+
+    m_buildWatcher.cancel();
+    m_buildWatcher.waitForFinished();
+
+    m_rootPath.clear();
+    m_snapshot.reset();
+    emit changed();
+}
+
+void ProjectFileIndex::rebuild()
+{
+    // The watcher may still be walking, or walking another tree
+    const std::shared_ptr<const ProjectWatcher::Tree> tree = m_watcher->tree();
+    if (m_rootPath.isEmpty() || !tree || tree->rootPath != m_rootPath) {
+        return;
+    }
+
+    // A build still under way is out of date already; its result is
+    // dropped when this one is watched instead
+    m_buildWatcher.setFuture(QtConcurrent::run(build, tree));
+}
+
+std::shared_ptr<const ProjectFileIndex::Snapshot> ProjectFileIndex::snapshotOf(const QString& rootPath,
+                                                                            const QStringList& relativePaths)
+{
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->rootPath = QDir::cleanPath(rootPath);
+
+    // Sorted paths mostly keep a directory's files together, so the
+    // directory lookup is skipped for runs of them
+    QStringList paths = relativePaths;
+    std::sort(paths.begin(), paths.end());
+
+    QHash<QString, qint32> directoryIds;
+    QHash<QString, qint32> nameIds;
+    QString currentDirectory;
+    qint32 currentDirectoryId = -1;
+    snapshot->files.reserve(paths.size());
+    for (const QString& path : std::as_const(paths)) {
+        const qsizetype slash = path.lastIndexOf(QLatin1Char('/'));
+        const QStringView dir = slash < 0 ? QStringView() : QStringView(path).left(slash);
+        const QString name = path.mid(slash + 1);
+
+        if (currentDirectoryId < 0 || dir != currentDirectory) {
+            currentDirectory = dir.toString();
+            auto it = directoryIds.constFind(currentDirectory);
+            if (it == directoryIds.constEnd()) {
+                it = directoryIds.insert(currentDirectory, snapshot->directories.size());
+                snapshot->directories.append(currentDirectory);
+            }
+            currentDirectoryId = *it;
+        }
+
+        auto nameId = nameIds.constFind(name);
+        if (nameId == nameIds.constEnd()) {
+            nameId = nameIds.insert(name, snapshot->names.size());
+            snapshot->names.append(name);
+            snapshot->nameMasks.append(FuzzyMatcher::charMask(name));
+        }
+
+        snapshot->files.append({currentDirectoryId, *nameId, FuzzyMatcher::charMask(path)});
+    }
+    return snapshot;
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,83 @@
+#ifndef PROJECTFILEINDEX_H
+#define PROJECTFILEINDEX_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <memory>
+
+namespace XXMLStudio {
+
+class ProjectWatcher;
+
+/**
+ * In-memory list of every file in a project tree, for Go to File.
+ *
+ * Each walk of the tree by the ProjectWatcher is turned into an
+ * immutable Snapshot on a background thread. Path segments are
+ * interned: each directory's path is stored once and shared by its
+ * files, and repeated file names (CMakeLists.txt, README.md) share one
+ * string. The previous snapshot stays usable until the new one
+ * replaces it.
+ */
+class ProjectFileIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Snapshot {
+        struct File {
+            qint32 directory;           // Index into directories
+            qint32 name;                // Index into names
+            quint64 pathMask;           // FuzzyMatcher::charMask of the relative path
+        };
+
+        QString rootPath;
+        QStringList directories;        // Relative, "" for the root
+        QStringList names;
+        QVector<quint64> nameMasks;     // FuzzyMatcher::charMask of each name
+        QVector<File> files;            // Sorted by relative path
+
+        int fileCount() const { return files.size(); }
+        QStringView fileName(int file) const { return names[files[file].name]; }
+        QStringView directory(int file) const { return directories[files[file].directory]; }
+        QString relativePath(int file) const;
+        QString absolutePath(int file) const;
+    };
+
+    explicit ProjectFileIndex(ProjectWatcher* watcher, QObject* parent = nullptr);
+    ~ProjectFileIndex();
+
+    // Lists the tree the watcher follows at rootPath, in the background
+    void open(const QString& rootPath);
+    void close();
+
+    QString rootPath() const { return m_rootPath; }
+    bool isReady() const { return m_snapshot != nullptr; }
+
+    // The latest complete snapshot, or null while the first is built
+    std::shared_ptr<const Snapshot> snapshot() const { return m_snapshot; }
+
+    // Builds a snapshot from paths relative to rootPath
+    static std::shared_ptr<const Snapshot> snapshotOf(const QString& rootPath, const QStringList& relativePaths);
+
+signals:
+    // A new snapshot is available
+    void changed();
+
+private:
+    void rebuild();
+
+    ProjectWatcher* m_watcher = nullptr;
+    QString m_rootPath;
+    std::shared_ptr<const Snapshot> m_snapshot;
+
+    QFutureWatcher<std::shared_ptr<const Snapshot>> m_buildWatcher;
+};
+
+} // namespace XXMLStudio
+
+#endif // PROJECTFILEINDEX_H
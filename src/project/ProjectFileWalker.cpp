@@ -0,0 +1,230 @@
+#include "ProjectFileWalker.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+namespace XXMLStudio {
+
+namespace {
+
+QString normalizedRelativePath(const QString& path)
+{
+    QString cleaned = QDir::cleanPath(QDir::fromNativeSeparators(path));
+    if (cleaned == QLatin1String(".")) {
+        return QString();
+    }
+    if (cleaned.startsWith(QLatin1String("./"))) {
+        cleaned.remove(0, 2);
+    }
+    while (cleaned.endsWith(QLatin1Char('/'))) {
+        cleaned.chop(1);
+    }
+    return cleaned;
+}
+
+} // namespace
+
+ProjectFileWalker::ProjectFileWalker(const QString& rootPath)
+    : m_rootPath(QDir::cleanPath(rootPath))
+{
+}
+
+void ProjectFileWalker::setExcludedPaths(const QStringList& relativePaths)
+{
+    m_excludedPaths.clear();
+    for (const QString& path : relativePaths) {
+        QString normalized = normalizedRelativePath(path);
+        if (!normalized.isEmpty() && !normalized.startsWith(QLatin1String(".."))
+            && !QDir::isAbsolutePath(normalized)) {
+            m_excludedPaths.append(normalized);
+        }
+    }
+}
+
+QStringList ProjectFileWalker::defaultExcludedPaths(const QStringList& outputDirs)
+{
+    QStringList paths = {QStringLiteral("Library")};
+    for (const QString& dir : outputDirs) {
+        if (!dir.isEmpty() && !paths.contains(dir)) {
+            paths.append(dir);
+        }
+    }
+    return paths;
+}
+
+bool ProjectFileWalker::walk(const std::function<bool(const QString& path)>& visit,
+                             const std::function<void(const QString& path)>& enterDirectory) const
+{
+    struct Directory {
+        QString path;
+        QString relativePath;
+        int ignoreDepth;    // Ignore files in effect for this directory
+    };
+
+    // Depth first with an explicit stack; the ignore files of a directory's
+    // ancestors are exactly the first ignoreDepth entries of ignoreFiles
+    QVector<Directory> pending = {{m_rootPath, QString(), 0}};
+    QVector<IgnoreFile> ignoreFiles;
+
+    while (!pending.isEmpty()) {
+        Directory dir = pending.takeLast();
+        ignoreFiles.resize(dir.ignoreDepth);
+        if (enterDirectory) {
+            enterDirectory(dir.path);
+        }
+
+        if (m_respectGitIgnore) {
+            IgnoreFile ignoreFile = readIgnoreFile(dir.path, dir.relativePath);
+            if (!ignoreFile.rules.isEmpty()) {
+                ignoreFiles.append(ignoreFile);
+            }
+        }
+
+        QVector<Directory> subdirectories;
+        QDirIterator it(dir.path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+        while (it.hasNext()) {
+            it.next();
+            QFileInfo info = it.fileInfo();
+            QString name = info.fileName();
+            QString relativePath = dir.relativePath.isEmpty() ? name : dir.relativePath + QLatin1Char('/') + name;
+
+            if (info.isDir()) {
+                // Symlinked directories could loop back into the tree
+                if (info.isSymLink() || name == QLatin1String(".git")
+                    || m_excludedPaths.contains(relativePath)
+                    || isIgnored(ignoreFiles, relativePath, true)) {
+                    continue;
+                }
+                subdirectories.append({info.filePath(), relativePath, int(ignoreFiles.size())});
+            } else if (!isIgnored(ignoreFiles, relativePath, false)) {
+                if (!visit(info.filePath())) {
+                    return false;
+                }
+            }
+        }
+
+        // Reversed so the stack pops them in iteration order
+        for (auto sub = subdirectories.crbegin(); sub != subdirectories.crend(); ++sub) {
+            pending.append(*sub);
+        }
+    }
+    return true;
+}
+
+ProjectFileWalker::IgnoreFile ProjectFileWalker::readIgnoreFile(const QString& directory, const QString& relativePath)
+{
+    IgnoreFile ignoreFile;
+    ignoreFile.baseRelativePath = relativePath;
+
+    QFile file(directory + QLatin1String("/.gitignore"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return ignoreFile;
+    }
+
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        while (line.endsWith(QLatin1Char('\n')) || line.endsWith(QLatin1Char('\r'))
+               || (line.endsWith(QLatin1Char(' ')) && !line.endsWith(QLatin1String("\\ ")))) {
+            line.chop(1);
+        }
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        IgnoreRule rule;
+        if (line.startsWith(QLatin1Char('!'))) {
+            rule.negated = true;
+            line.remove(0, 1);
+        } else if (line.startsWith(QLatin1String("\\#")) || line.startsWith(QLatin1String("\\!"))) {
+            line.remove(0, 1);
+        }
+        if (line.endsWith(QLatin1Char('/'))) {
+            rule.directoryOnly = true;
+            line.chop(1);
+        }
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // A slash anywhere but the end anchors the pattern to this
+        // directory; otherwise it matches a name at any depth
+        QString regex;
+        if (line.contains(QLatin1Char('/'))) {
+            if (line.startsWith(QLatin1Char('/'))) {
+                line.remove(0, 1);
+            }
+            regex = globToRegex(line);
+        } else {
+            regex = QStringLiteral("(?:.*/)?") + globToRegex(line);
+        }
+        rule.pattern = QRegularExpression(QRegularExpression::anchoredPattern(regex));
+        if (rule.pattern.isValid()) {
+            ignoreFile.rules.append(rule);
+        }
+    }
+    return ignoreFile;
+}
+
+QString ProjectFileWalker::globToRegex(const QString& glob)
+{
+    QString regex;
+    for (qsizetype i = 0; i < glob.size(); ++i) {
+        QChar ch = glob[i];
+        if (ch == QLatin1Char('*')) {
+            if (i + 1 < glob.size() && glob[i + 1] == QLatin1Char('*')) {
+                bool atStart = i == 0 || glob[i - 1] == QLatin1Char('/');
+                if (atStart && i + 2 < glob.size() && glob[i + 2] == QLatin1Char('/')) {
+                    regex += QLatin1String("(?:.*/)?");     // "**/": any leading directories
+                    i += 2;
+                } else {
+                    regex += QLatin1String(".*");           // "/**" or a bare "**"
+                    i += 1;
+                }
+            } else {
+                regex += QLatin1String("[^/]*");
+            }
+        } else if (ch == QLatin1Char('?')) {
+            regex += QLatin1String("[^/]");
+        } else if (ch == QLatin1Char('[')) {
+            qsizetype close = glob.indexOf(QLatin1Char(']'), i + 2);
+            if (close < 0) {
+                regex += QLatin1String("\\[");
+                continue;
+            }
+            QString set = glob.mid(i + 1, close - i - 1);
+            if (set.startsWith(QLatin1Char('!'))) {
+                set[0] = QLatin1Char('^');
+            }
+            regex += QLatin1Char('[') + set.replace(QLatin1String("\\"), QLatin1String("\\\\")) + QLatin1Char(']');
+            i = close;
+        } else if (ch == QLatin1Char('\\') && i + 1 < glob.size()) {
+            regex += QRegularExpression::escape(QString(glob[++i]));
+        } else {
+            regex += QRegularExpression::escape(QString(ch));
+        }
+    }
+    return regex;
+}
+
+bool ProjectFileWalker::isIgnored(const QVector<IgnoreFile>& ignoreFiles, const QString& relativePath, bool isDirectory)
+{
+    bool ignored = false;
+    for (const IgnoreFile& ignoreFile : ignoreFiles) {
+        QString path = ignoreFile.baseRelativePath.isEmpty()
+            ? relativePath
+            : relativePath.mid(ignoreFile.baseRelativePath.size() + 1);
+        for (const IgnoreRule& rule : ignoreFile.rules) {
+            if (rule.directoryOnly && !isDirectory) {
+                continue;
+            }
+            if (rule.negated == ignored && rule.pattern.match(path).hasMatch()) {
+                ignored = !rule.negated;
+            }
+        }
+    }
+    return ignored;
+}
+
+} // namespace XXMLStudio
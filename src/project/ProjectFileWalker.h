@@ -0,0 +1,63 @@
+#ifndef PROJECTFILEWALKER_H
+#define PROJECTFILEWALKER_H
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+namespace XXMLStudio {
+
+/**
+ * Enumerates the files of a project tree the way a user thinks of it.
+ *
+ * Directories named in the exclusion list (relative to the root, such
+ * as the Library folder or a build output directory) are not entered,
+ * nor is .git. Each directory's .gitignore is read on the way down and
+ * applies to everything beneath it, with the usual precedence: later
+ * patterns override earlier ones and deeper files override shallower
+ * ones. Safe to use from a worker thread.
+ */
+class ProjectFileWalker
+{
+public:
+    explicit ProjectFileWalker(const QString& rootPath);
+
+    // Paths relative to the root; matched as whole path components
+    void setExcludedPaths(const QStringList& relativePaths);
+    void setRespectGitIgnore(bool respect) { m_respectGitIgnore = respect; }
+
+    // Calls visit with each file's absolute path, in directory order,
+    // until it returns false. Returns false if the walk was stopped.
+    // enterDirectory, if given, sees every directory walked, root first.
+    bool walk(const std::function<bool(const QString& path)>& visit,
+              const std::function<void(const QString& path)>& enterDirectory = {}) const;
+
+    // Excluded directories for a project: its Library folder and every
+    // build configuration's output directory
+    static QStringList defaultExcludedPaths(const QStringList& outputDirs);
+
+private:
+    struct IgnoreRule {
+        QRegularExpression pattern;   // Against the path relative to the rule's directory
+        bool negated = false;
+        bool directoryOnly = false;
+    };
+    struct IgnoreFile {
+        QString baseRelativePath;      // Directory holding the .gitignore, "" for the root
+        QVector<IgnoreRule> rules;
+    };
+
+    static IgnoreFile readIgnoreFile(const QString& directory, const QString& relativePath);
+    static QString globToRegex(const QString& glob);
+    static bool isIgnored(const QVector<IgnoreFile>& ignoreFiles, const QString& relativePath, bool isDirectory);
+
+    QString m_rootPath;
+    QStringList m_excludedPaths;
+    bool m_respectGitIgnore = true;
+};
+
+} // namespace XXMLStudio
+
+#endif // PROJECTFILEWALKER_H
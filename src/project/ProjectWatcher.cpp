@@ -0,0 +1,137 @@
+#include "ProjectWatcher.h"
+#include "ProjectFileWalker.h"
+
+#include <QDir>
+#include <QPromise>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace XXMLStudio {
+
+namespace {
+
+using TreePtr = std::shared_ptr<const ProjectWatcher::Tree>;
+
+void walkTree(QPromise<TreePtr>& promise, const QString& rootPath, const QStringList& excludedPaths)
+{
+    auto tree = std::make_shared<ProjectWatcher::Tree>();
+    tree->rootPath = rootPath;
+
+    ProjectFileWalker walker(rootPath);
+    walker.setExcludedPaths(excludedPaths);
+    bool complete = walker.walk(
+        [&](const QString& path) {
+            if (promise.isCanceled()) {
+                return false;
+            }
+            tree->files.append(path);
+            return true;
+        },
+        [&](const QString& directory) { tree->directories.append(QDir::cleanPath(directory)); });
+    if (complete) {
+        promise.addResult(TreePtr(std::move(tree)));
+    }
+}
+
+} // namespace
+
+ProjectWatcher::ProjectWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(m_fileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString& path) {
+        emit directoryChanged(QDir::cleanPath(path));
+        m_rewalkTimer->start();
+    });
+
+    m_rewalkTimer = new QTimer(this);
+    m_rewalkTimer->setSingleShot(true);
+    m_rewalkTimer->setInterval(REWALK_DELAY_MS);
+    connect(m_rewalkTimer, &QTimer::timeout, this, &ProjectWatcher::rewalk);
+
+    connect(&m_walkWatcher, &QFutureWatcher<TreePtr>::finished, this, [this]() {
+        if (m_rootPath.isEmpty() || m_walkWatcher.isCanceled() || m_walkWatcher.future().resultCount() == 0) {
+            return;
+        }
+        m_tree = m_walkWatcher.result();
+        watch(m_tree->directories);
+        emit treeChanged();
+    });
+}
+
+ProjectWatcher::~ProjectWatcher()
+{
+    close();
+}
+
+void ProjectWatcher::open(const QString& rootPath, const QStringList& excludedPaths)
+{
+    close();
+    m_rootPath = QDir::cleanPath(rootPath);
+    m_excludedPaths = excludedPaths;
+    rewalk();
+}
+
+void ProjectWatcher::close()
+{
+    if (m_rootPath.isEmpty()) return;
+
+    m_rewalkTimer->stop();
+    m_walkWatcher.cancel();
+    m_walkWatcher.waitForFinished();
+    watch({});
+
+    m_rootPath.clear();
+    m_excludedPaths.clear();
+    m_tree.reset();
+}
+
+void ProjectWatcher::rewalk()
+{
+    if (m_rootPath.isEmpty()) return;
+
+    // A walk still under way is out of date already
+    m_walkWatcher.cancel();
+    m_walkWatcher.waitForFinished();
+    m_walkWatcher.setFuture(QtConcurrent::run(walkTree, m_rootPath, m_excludedPaths));
+}
+
+void ProjectWatcher::watch(const QStringList& directories)
+{
+    // Shallow directories first if there are too many: they also see
+    // new subdirectories
+    QStringList watch = directories;
+    if (watch.size() > MAX_WATCHED_DIRECTORIES) {
+        std::stable_sort(watch.begin(), watch.end(), [](const QString& a, const QString& b) {
+            return a.count(QLatin1Char('/')) < b.count(QLatin1Char('/'));
+        });
+        watch = watch.mid(0, MAX_WATCHED_DIRECTORIES);
+    }
+
+    // Only the difference, so directories kept across a walk never go
+    // unwatched in between
+    const QStringList watchedList = m_fileSystemWatcher->directories();
+    const QSet<QString> watched(watchedList.cbegin(), watchedList.cend());
+    const QSet<QString> wanted(watch.cbegin(), watch.cend());
+    QStringList removed;
+    for (const QString& directory : watchedList) {
+        if (!wanted.contains(directory)) {
+            removed.append(directory);
+        }
+    }
+    QStringList added;
+    for (const QString& directory : std::as_const(watch)) {
+        if (!watched.contains(directory)) {
+            added.append(directory);
+        }
+    }
+    if (!removed.isEmpty()) {
+        m_fileSystemWatcher->removePaths(removed);
+    }
+    if (!added.isEmpty()) {
+        m_fileSystemWatcher->addPaths(added);
+    }
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,77 @@
+#ifndef PROJECTWATCHER_H
+#define PROJECTWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+
+namespace XXMLStudio {
+
+/**
+ * Follows a project tree on disk for everything that needs to.
+ *
+ * The tree is walked with ProjectFileWalker on a background thread into
+ * an immutable Tree of its files and directories, and the directories
+ * are watched. A directory change is passed on at once; when changes
+ * settle the tree is walked again. Find in Files, Go to File and Git
+ * status all subscribe, so a change costs one walk and a directory
+ * one watch however many of them follow it.
+ */
+class ProjectWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Tree {
+        QString rootPath;
+        QStringList files;              // Absolute, in directory order
+        QStringList directories;        // Absolute, root first
+    };
+
+    explicit ProjectWatcher(QObject* parent = nullptr);
+    ~ProjectWatcher();
+
+    // Starts walking and watching a tree in the background
+    void open(const QString& rootPath, const QStringList& excludedPaths);
+    void close();
+
+    QString rootPath() const { return m_rootPath; }
+    QStringList excludedPaths() const { return m_excludedPaths; }
+
+    // The latest complete walk, or null while the first is under way
+    std::shared_ptr<const Tree> tree() const { return m_tree; }
+    // A change has been seen that no walk reflects yet
+    bool isWalking() const { return m_rewalkTimer->isActive() || m_walkWatcher.isRunning(); }
+
+signals:
+    // A watched directory changed; the walk that follows is still to come
+    void directoryChanged(const QString& path);
+    // A new walk of the tree is available
+    void treeChanged();
+
+private:
+    void rewalk();
+    void watch(const QStringList& directories);
+
+    QString m_rootPath;
+    QStringList m_excludedPaths;
+    std::shared_ptr<const Tree> m_tree;
+
+    QFutureWatcher<std::shared_ptr<const Tree>> m_walkWatcher;
+    QFileSystemWatcher* m_fileSystemWatcher = nullptr;
+    QTimer* m_rewalkTimer = nullptr;
+
+    // Checkouts and builds change many directories at once
+    static constexpr int REWALK_DELAY_MS = 500;
+    // Directories beyond this are not watched; saves from the editor,
+    // git's own files and the walk at the next open still catch them
+    static constexpr int MAX_WATCHED_DIRECTORIES = 4096;
+};
+
+} // namespace XXMLStudio
+
+#endif // PROJECTWATCHER_H
@@ -0,0 +1,646 @@
+#include "TrigramIndex.h"
+#include "ProjectWatcher.h"
+#include "../editor/FindInFiles.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPromise>
+#include <QReadWriteLock>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace XXMLStudio {
+
+struct TrigramIndex::Data
+{
+    struct FileEntry {
+        QString relativePath;
+        qint64 modified = 0;            // ms since epoch
+        qint64 size = 0;
+        bool live = true;
+    };
+
+    // Ids in increasing order, stored as varint-encoded gaps
+    struct PostingList {
+        QByteArray deltas;
+        qint32 lastId = -1;
+        qint32 count = 0;
+    };
+
+    mutable QReadWriteLock lock;
+    QString rootPath;
+
+    QVector<FileEntry> files;           // Indexed by id
+    QHash<QString, qint32> ids;         // Live id of each relative path
+    QHash<quint32, PostingList> postings;
+    qint32 deadCount = 0;
+    bool dirty = false;
+};
+
+namespace {
+
+constexpr quint32 INDEX_MAGIC = 0x58544749;  // "XTGI"
+constexpr quint32 INDEX_VERSION = 1;
+
+// A NUL byte this early marks a binary file, as in FindInFiles
+constexpr qint64 BINARY_CHECK_BYTES = 8000;
+
+// Compact once dead entries outnumber live ones, but not for a handful
+constexpr qint32 MIN_DEAD_TO_COMPACT = 1000;
+
+inline uchar asciiLower(uchar ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? uchar(ch + ('a' - 'A')) : ch;
+}
+
+void appendVarint(QByteArray& out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+QVector<qint32> decode(const TrigramIndex::Data::PostingList& list)
+{
+    QVector<qint32> ids;
+    ids.reserve(list.count);
+    const uchar* p = reinterpret_cast<const uchar*>(list.deltas.constData());
+    const uchar* end = p + list.deltas.size();
+    qint32 id = -1;
+    while (p < end) {
+        quint32 delta = 0;
+        int shift = 0;
+        while (p < end) {
+            uchar byte = *p++;
+            delta |= quint32(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        id += qint32(delta);
+        ids.append(id);
+    }
+    return ids;
+}
+
+// A posting list read from disk must decode to increasing ids below
+// fileCount that agree with its stored count and last id; anything else
+// would index past the file table
+bool isValid(const TrigramIndex::Data::PostingList& list, qint32 fileCount)
+{
+    const uchar* p = reinterpret_cast<const uchar*>(list.deltas.constData());
+    const uchar* end = p + list.deltas.size();
+    qint64 id = -1;
+    qint32 count = 0;
+    while (p < end) {
+        quint64 delta = 0;
+        int shift = 0;
+        bool complete = false;
+        while (p < end && shift < 35) {
+            uchar byte = *p++;
+            delta |= quint64(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) {
+                complete = true;
+                break;
+            }
+        }
+        id += qint64(delta);
+        if (!complete || delta == 0 || id >= fileCount) {
+            return false;
+        }
+        ++count;
+    }
+    return count > 0 && count == list.count && id == list.lastId;
+}
+
+// Distinct trigrams of a byte buffer, ASCII case-folded and sorted. A
+// bitmap over all 2^24 keys removes duplicates without sorting every
+// position of a large file; it is reused from file to file.
+class TrigramCollector
+{
+public:
+    TrigramCollector() : m_seen((1u << 24) / 64, 0) {}
+
+    const QVector<quint32>& collect(const char* data, qint64 size)
+    {
+        for (quint32 key : std::as_const(m_keys)) {
+            m_seen[key >> 6] = 0;
+        }
+        m_keys.clear();
+
+        const uchar* bytes = reinterpret_cast<const uchar*>(data);
+        quint32 key = 0;
+        for (qint64 i = 0; i < size; ++i) {
+            key = ((key << 8) | asciiLower(bytes[i])) & 0xFFFFFF;
+            if (i < 2) continue;
+            quint64& word = m_seen[key >> 6];
+            const quint64 bit = quint64(1) << (key & 63);
+            if (!(word & bit)) {
+                word |= bit;
+                m_keys.append(key);
+            }
+        }
+        std::sort(m_keys.begin(), m_keys.end());
+        return m_keys;
+    }
+
+private:
+    std::vector<quint64> m_seen;
+    QVector<quint32> m_keys;
+};
+
+// Trigrams of a short query literal
+QVector<quint32> queryTrigrams(const QByteArray& bytes)
+{
+    QVector<quint32> keys;
+    quint32 key = 0;
+    for (qsizetype i = 0; i < bytes.size(); ++i) {
+        key = ((key << 8) | asciiLower(uchar(bytes[i]))) & 0xFFFFFF;
+        if (i >= 2) keys.append(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// Caller holds the write lock
+void tombstone(TrigramIndex::Data& data, const QString& relativePath)
+{
+    auto it = data.ids.find(relativePath);
+    if (it == data.ids.end()) return;
+    data.files[*it].live = false;
+    ++data.deadCount;
+    data.ids.erase(it);
+    data.dirty = true;
+}
+
+// Caller holds the write lock. New ids are always the largest so far,
+// which keeps every posting list sorted by appending.
+void addFile(TrigramIndex::Data& data, const QString& relativePath, qint64 modified, qint64 size,
+             const QVector<quint32>& trigrams)
+{
+    tombstone(data, relativePath);
+
+    const qint32 id = data.files.size();
+    data.files.append({relativePath, modified, size, true});
+    data.ids.insert(relativePath, id);
+    for (quint32 trigram : trigrams) {
+        TrigramIndex::Data::PostingList& list = data.postings[trigram];
+        appendVarint(list.deltas, quint32(id - list.lastId));
+        list.lastId = id;
+        ++list.count;
+    }
+    data.dirty = true;
+}
+
+// Caller holds the write lock
+void compact(TrigramIndex::Data& data)
+{
+    if (data.deadCount < MIN_DEAD_TO_COMPACT || data.deadCount * 2 < data.files.size()) {
+        return;
+    }
+
+    QVector<qint32> newIds(data.files.size(), -1);
+    QVector<TrigramIndex::Data::FileEntry> files;
+    files.reserve(data.files.size() - data.deadCount);
+    data.ids.clear();
+    for (qint32 id = 0; id < data.files.size(); ++id) {
+        if (!data.files[id].live) continue;
+        newIds[id] = files.size();
+        data.ids.insert(data.files[id].relativePath, files.size());
+        files.append(data.files[id]);
+    }
+
+    for (auto it = data.postings.begin(); it != data.postings.end(); ) {
+        TrigramIndex::Data::PostingList list;
+        for (qint32 id : decode(*it)) {
+            if (newIds[id] < 0) continue;
+            appendVarint(list.deltas, quint32(newIds[id] - list.lastId));
+            list.lastId = newIds[id];
+            ++list.count;
+        }
+        if (list.count == 0) {
+            it = data.postings.erase(it);
+        } else {
+            *it = std::move(list);
+            ++it;
+        }
+    }
+
+    data.files = std::move(files);
+    data.deadCount = 0;
+    data.dirty = true;
+}
+
+// Trigrams of a file on disk. Binary and oversized files, which Find in
+// Files skips anyway, are indexed with none.
+bool readTrigrams(const QString& path, TrigramCollector& collector, const QVector<quint32>*& trigrams)
+{
+    static const QVector<quint32> none;
+    trigrams = &none;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 size = file.size();
+    if (size == 0 || size > FindInFiles::MAX_FILE_BYTES) {
+        return true;
+    }
+
+    QByteArray bytes;
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        bytes = file.readAll();
+        data = bytes.constData();
+        size = bytes.size();
+    }
+    if (std::memchr(data, 0, static_cast<size_t>(qMin(size, BINARY_CHECK_BYTES)))) {
+        return true;
+    }
+    trigrams = &collector.collect(data, size);
+    return true;
+}
+
+bool load(TrigramIndex::Data& data, const QString& indexPath)
+{
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString rootPath;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+        return false;
+    }
+    in.setVersion(QDataStream::Qt_6_0);
+    in >> rootPath;
+    if (rootPath != data.rootPath) {
+        return false;                   // Hash collision; start over
+    }
+
+    QVector<TrigramIndex::Data::FileEntry> files;
+    QHash<QString, qint32> ids;
+    QHash<quint32, TrigramIndex::Data::PostingList> postings;
+    qint32 fileCount = 0;
+    qint32 deadCount = 0;
+    in >> fileCount;
+    files.reserve(qMax(0, fileCount));
+    for (qint32 id = 0; id < fileCount && in.status() == QDataStream::Ok; ++id) {
+        TrigramIndex::Data::FileEntry entry;
+        in >> entry.relativePath >> entry.modified >> entry.size >> entry.live;
+        if (entry.live) {
+            ids.insert(entry.relativePath, id);
+        } else {
+            ++deadCount;
+        }
+        files.append(entry);
+    }
+    qint32 postingCount = 0;
+    in >> postingCount;
+    postings.reserve(qMax(0, postingCount));
+    for (qint32 i = 0; i < postingCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 trigram = 0;
+        TrigramIndex::Data::PostingList list;
+        in >> trigram >> list.lastId >> list.count >> list.deltas;
+        if (in.status() == QDataStream::Ok && !isValid(list, files.size())) {
+            return false;               // Stale or corrupt; rebuild from scratch
+        }
+        postings.insert(trigram, std::move(list));
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QWriteLocker locker(&data.lock);
+    data.files = std::move(files);
+    data.ids = std::move(ids);
+    data.postings = std::move(postings);
+    data.deadCount = deadCount;
+    data.dirty = false;
+    return true;
+}
+
+void save(std::shared_ptr<TrigramIndex::Data> sharedData, const QString& indexPath)
+{
+    TrigramIndex::Data& data = *sharedData;
+
+    // Serialize under the read lock; queries may go on meanwhile
+    QReadLocker locker(&data.lock);
+    if (!data.dirty) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(indexPath).absolutePath());
+    QSaveFile file(indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION;
+    out.setVersion(QDataStream::Qt_6_0);
+    out << data.rootPath;
+    out << qint32(data.files.size());
+    for (const TrigramIndex::Data::FileEntry& entry : data.files) {
+        out << entry.relativePath << entry.modified << entry.size << entry.live;
+    }
+    out << qint32(data.postings.size());
+    for (auto it = data.postings.constBegin(); it != data.postings.constEnd(); ++it) {
+        out << it.key() << it->lastId << it->count << it->deltas;
+    }
+    if (file.commit()) {
+        // Only this thread writes, so clearing under the read lock is safe
+        data.dirty = false;
+    }
+}
+
+// Brings the index in line with a walk of the tree: files whose size or
+// time changed are reindexed, files no longer there are dropped
+void refresh(QPromise<bool>& promise, std::shared_ptr<TrigramIndex::Data> data,
+             std::shared_ptr<const ProjectWatcher::Tree> tree)
+{
+    const QDir root(data->rootPath);
+    TrigramCollector collector;
+    QSet<QString> seen;
+    seen.reserve(tree->files.size());
+
+    for (const QString& path : tree->files) {
+        if (promise.isCanceled()) {
+            return;
+        }
+        const QFileInfo info(path);
+        const QString relativePath = root.relativeFilePath(path);
+        seen.insert(relativePath);
+
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        const qint64 size = info.size();
+        {
+            QReadLocker locker(&data->lock);
+            auto it = data->ids.constFind(relativePath);
+            if (it != data->ids.constEnd()) {
+                const TrigramIndex::Data::FileEntry& entry = data->files[*it];
+                if (entry.modified == modified && entry.size == size) {
+                    continue;
+                }
+            }
+        }
+
+        const QVector<quint32>* trigrams = nullptr;
+        if (readTrigrams(path, collector, trigrams)) {
+            QWriteLocker locker(&data->lock);
+            addFile(*data, relativePath, modified, size, *trigrams);
+        }
+    }
+
+    QWriteLocker locker(&data->lock);
+    QStringList gone;
+    for (auto it = data->ids.constBegin(); it != data->ids.constEnd(); ++it) {
+        if (!seen.contains(it.key())) {
+            gone.append(it.key());
+        }
+    }
+    for (const QString& relativePath : std::as_const(gone)) {
+        tombstone(*data, relativePath);
+    }
+    compact(*data);
+    locker.unlock();
+
+    promise.addResult(true);
+}
+
+void update(std::shared_ptr<TrigramIndex::Data> data, const QString& path)
+{
+    const QFileInfo info(path);
+    const QString relativePath = QDir(data->rootPath).relativeFilePath(path);
+    if (!info.isFile()) {
+        QWriteLocker locker(&data->lock);
+        tombstone(*data, relativePath);
+        return;
+    }
+
+    TrigramCollector collector;
+    const QVector<quint32>* trigrams = nullptr;
+    if (readTrigrams(path, collector, trigrams)) {
+        QWriteLocker locker(&data->lock);
+        addFile(*data, relativePath, info.lastModified().toMSecsSinceEpoch(), info.size(), *trigrams);
+        compact(*data);
+    }
+}
+
+} // namespace
+
+TrigramIndex::TrigramIndex(ProjectWatcher* watcher, QObject* parent)
+    : QObject(parent)
+    , m_watcher(watcher)
+{
+    m_worker.setMaxThreadCount(1);
+
+    connect(m_watcher, &ProjectWatcher::treeChanged, this, &TrigramIndex::reindex);
+
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SAVE_DELAY_MS);
+    connect(m_saveTimer, &QTimer::timeout, this, [this]() {
+        if (!m_data) return;
+        QtConcurrent::run(&m_worker, save, m_data, indexPathFor(m_rootPath));
+    });
+
+    connect(&m_refreshWatcher, &QFutureWatcher<bool>::finished, this, [this]() {
+        if (!m_data || m_refreshWatcher.isCanceled() || m_refreshWatcher.future().resultCount() == 0) {
+            return;
+        }
+        m_ready = true;
+        scheduleSave();
+        emit ready();
+    });
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    close();
+}
+
+void TrigramIndex::open(const QString& rootPath)
+{
+    close();
+
+    m_rootPath = QDir::cleanPath(rootPath);
+    m_excludedPaths = m_watcher->excludedPaths();
+    m_data = std::make_shared<Data>();
+    m_data->rootPath = m_rootPath;
+
+    // Loaded while the watcher walks; the worker runs the refresh after it
+    QtConcurrent::run(&m_worker, [data = m_data, indexPath = indexPathFor(m_rootPath)]() {
+        load(*data, indexPath);
+    });
+    reindex();
+}
+
+void TrigramIndex::close()
+{
+    if (!m_data) return;
+
+    m_saveTimer->stop();
+    m_refreshWatcher.cancel();
+
+    // Whatever was indexed before a cancelled refresh is still accurate
+    // per file, so it is worth keeping
+    QtConcurrent::run(&m_worker, save, m_data, indexPathFor(m_rootPath));
+    m_worker.waitForDone();
+
+    m_data.reset();
+    m_ready = false;
+    m_rootPath.clear();
+    m_excludedPaths.clear();
+}
+
+void TrigramIndex::fileChanged(const QString& path)
+{
+    if (!m_data) return;
+
+    const QString cleanPath = QDir::cleanPath(path);
+    if (!cleanPath.startsWith(m_rootPath + QLatin1Char('/'))) {
+        return;
+    }
+    const QString relativePath = cleanPath.mid(m_rootPath.size() + 1);
+    for (const QString& excluded : std::as_const(m_excludedPaths)) {
+        if (relativePath.startsWith(QDir::cleanPath(excluded) + QLatin1Char('/'))) {
+            return;
+        }
+    }
+
+    QtConcurrent::run(&m_worker, update, m_data, cleanPath);
+    scheduleSave();
+}
+
+bool TrigramIndex::candidates(const QString& pattern, const TextSearch::Options& options, QStringList& files) const
+{
+    if (!m_ready || !m_data) {
+        return false;
+    }
+    // Changes that are known but not indexed yet: a rewalk or refresh
+    // under way, or a saved file waiting on the worker
+    if (m_watcher->isWalking() || m_refreshWatcher.isRunning() || m_worker.activeThreadCount() > 0) {
+        return false;
+    }
+
+    const QString literal = options.useRegex ? FindInFiles::requiredLiteral(pattern) : pattern;
+    if (!options.caseSensitive
+        && !std::all_of(literal.cbegin(), literal.cend(), [](QChar ch) { return ch.unicode() < 0x80; })) {
+        return false;                   // Folding beyond ASCII is not indexed
+    }
+    const QByteArray bytes = literal.toUtf8();
+    if (bytes.size() < 3) {
+        return false;
+    }
+
+    const QVector<quint32> trigrams = queryTrigrams(bytes);
+
+    QReadLocker locker(&m_data->lock);
+
+    // Intersect the shortest lists first so the running set stays small
+    QVector<const Data::PostingList*> lists;
+    lists.reserve(trigrams.size());
+    for (quint32 trigram : trigrams) {
+        auto it = m_data->postings.constFind(trigram);
+        if (it == m_data->postings.constEnd()) {
+            files.clear();
+            return true;
+        }
+        lists.append(&*it);
+    }
+    std::sort(lists.begin(), lists.end(), [](const Data::PostingList* a, const Data::PostingList* b) {
+        return a->count < b->count;
+    });
+
+    QVector<qint32> ids = decode(*lists.first());
+    for (qsizetype i = 1; i < lists.size() && !ids.isEmpty(); ++i) {
+        const QVector<qint32> other = decode(*lists[i]);
+        QVector<qint32> both;
+        std::set_intersection(ids.cbegin(), ids.cend(), other.cbegin(), other.cend(), std::back_inserter(both));
+        ids = std::move(both);
+    }
+
+    files.clear();
+    files.reserve(ids.size());
+    const QString prefix = m_data->rootPath + QLatin1Char('/');
+    for (qint32 id : std::as_const(ids)) {
+        const Data::FileEntry& entry = m_data->files[id];
+        if (entry.live) {
+            files.append(prefix + entry.relativePath);
+        }
+    }
+    return true;
+}
+
+std::function<QStringList()> TrigramIndex::unindexedFiles() const
+{
+    std::shared_ptr<const Data> data = m_data;
+    std::shared_ptr<const ProjectWatcher::Tree> tree = m_watcher->tree();
+    if (!data || !tree || tree->rootPath != data->rootPath) {
+        return {};
+    }
+
+    // Files rewritten in place by other programs change no directory,
+    // so nothing tells the index about them
+    return [data, tree]() {
+        QStringList files;
+        const qsizetype prefixLength = data->rootPath.size() + 1;
+        for (const QString& path : tree->files) {
+            const QFileInfo info(path);
+            const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+            const qint64 size = info.size();
+
+            QReadLocker locker(&data->lock);
+            auto it = data->ids.constFind(path.mid(prefixLength));
+            if (it == data->ids.constEnd() || data->files[*it].modified != modified
+                || data->files[*it].size != size) {
+                files.append(path);
+            }
+        }
+        return files;
+    };
+}
+
+QString TrigramIndex::indexPathFor(const QString& rootPath)
+{
+    const QByteArray key = QCryptographicHash::hash(QDir::cleanPath(rootPath).toUtf8(), QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + QStringLiteral("/trigram/") + QString::fromLatin1(key.toHex()) + QStringLiteral(".idx");
+}
+
+void TrigramIndex::reindex()
+{
+    // The watcher may still be walking, or walking another tree
+    const std::shared_ptr<const ProjectWatcher::Tree> tree = m_watcher->tree();
+    if (!m_data || !tree || tree->rootPath != m_rootPath) {
+        return;
+    }
+
+    // A refresh still under way is out of date already
+    m_refreshWatcher.cancel();
+    m_refreshWatcher.setFuture(QtConcurrent::run(&m_worker, refresh, m_data, tree));
+}
+
+void TrigramIndex::scheduleSave()
+{
+    if (!m_saveTimer->isActive()) {
+        m_saveTimer->start();
+    }
+}
+
+} // namespace XXMLStudio
@@ -0,0 +1,96 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <functional>
+#include <memory>
+#include "../editor/TextSearch.h"
+
+namespace XXMLStudio {
+
+class ProjectWatcher;
+
+/**
+ * Trigram index of a project tree for Find in Files.
+ *
+ * Maps every three-byte sequence (ASCII case-folded) to the files that
+ * contain it. A query looks up the trigrams of a literal the pattern
+ * requires and intersects their posting lists, leaving only a handful
+ * of candidate files for FindInFiles to verify.
+ *
+ * The index is saved in the user's cache directory and loaded again
+ * when the project is opened; a stat pass over the tree then reindexes
+ * only the files whose size or modification time changed. Afterwards it
+ * follows saves from the editor and each new walk of the tree by the
+ * ProjectWatcher.
+ * Changed files get a new entry and their old one is marked dead;
+ * posting lists are compacted once dead entries dominate.
+ *
+ * All building happens on one background thread, so the GUI thread only
+ * ever waits for the brief moment an update or query holds the lock.
+ */
+class TrigramIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrigramIndex(ProjectWatcher* watcher, QObject* parent = nullptr);
+    ~TrigramIndex();
+
+    // Loads or builds the index for the tree the watcher follows at
+    // rootPath, in the background
+    void open(const QString& rootPath);
+    // Saves the index and forgets it
+    void close();
+
+    QString rootPath() const { return m_rootPath; }
+    bool isReady() const { return m_ready; }
+
+    // Reindex a file the IDE has just written
+    void fileChanged(const QString& path);
+
+    // Absolute paths of the files that may contain a match. Returns
+    // false if the index cannot narrow this query down (not ready yet,
+    // or no literal of three or more characters to look up).
+    bool candidates(const QString& pattern, const TextSearch::Options& options, QStringList& files) const;
+    // A task listing the files of the tree the index does not cover as
+    // they are on disk now (new, or changed in size or time), which must
+    // be searched on top of the candidates. It stats every file, so run
+    // it off the GUI thread.
+    std::function<QStringList()> unindexedFiles() const;
+
+    // Where the index of a tree is kept
+    static QString indexPathFor(const QString& rootPath);
+
+    struct Data;
+
+signals:
+    // The index is loaded and matches the tree on disk
+    void ready();
+
+private:
+    void reindex();
+    void scheduleSave();
+
+    ProjectWatcher* m_watcher = nullptr;
+    QString m_rootPath;
+    QStringList m_excludedPaths;
+    std::shared_ptr<Data> m_data;
+    bool m_ready = false;
+
+    // Runs load, refresh, update and save tasks one at a time, in order
+    QThreadPool m_worker;
+    QFutureWatcher<bool> m_refreshWatcher;
+    QTimer* m_saveTimer = nullptr;
+
+    static constexpr int SAVE_DELAY_MS = 30000;
+};
+
+} // namespace XXMLStudio
+
+#endif // TRIGRAMINDEX_H
@@ -5,21 +5,31 @@
 #include "editor/EditorTabWidget.h"
 #include "editor/CodeEditor.h"
 #include "editor/BookmarkManager.h"
+#include "editor/LargeFileViewer.h"
 #include "panels/ProjectExplorer.h"
 #include "panels/ProblemsPanel.h"
+#include "panels/FindInFilesPanel.h"
 #include "panels/BuildOutputPanel.h"
 #include "panels/TerminalPanel.h"
 #include "panels/OutlinePanel.h"
+#include "panels/LSPTrafficPanel.h"
 #include "project/ProjectManager.h"
 #include "project/Project.h"
+#include "project/ProjectFileWalker.h"
+#include "project/TrigramIndex.h"
+#include "project/ProjectFileIndex.h"
+#include "project/ProjectWatcher.h"
 #include "build/BuildManager.h"
 #include "build/ProcessRunner.h"
 #include "build/OutputParser.h"
 #include "build/ToolchainLocator.h"
 #include "lsp/LSPClient.h"
+#include "lsp/DocumentSyncManager.h"
 #include "lsp/LSPProtocol.h"
+#include "lsp/LSPTrafficMonitor.h"
 #include "dialogs/NewProjectDialog.h"
 #include "dialogs/GoToLineDialog.h"
+#include "dialogs/QuickOpenDialog.h"
 #include "dialogs/FindReplaceDialog.h"
 #include "dialogs/SettingsDialog.h"
 #include "dialogs/ResumeProjectDialog.h"
@@ -102,9 +112,18 @@ void MainWindow::setupUi()
 
     // Create LSP client
     m_lspClient = new LSPClient(this);
+    m_documentSync = new DocumentSyncManager(m_lspClient, this);
+
+    // One walk and one set of watches of the project tree, shared by
+    // Git status, Find in Files and Go to File
+    m_projectWatcher = new ProjectWatcher(this);
 
     // Create Git manager
-    m_gitManager = new GitManager(this);
+    m_gitManager = new GitManager(m_projectWatcher, this);
+
+    // Create Find in Files and Go to File indexes
+    m_trigramIndex = new TrigramIndex(m_projectWatcher, this);
+    m_projectFileIndex = new ProjectFileIndex(m_projectWatcher, this);
 
     createActions();
     setupMenuBar();
@@ -145,6 +164,9 @@ void MainWindow::createActions()
     m_openProjectAction = new QAction(tr("Open Project..."), this);
     m_openProjectAction->setShortcut(QKeySequence("Ctrl+Shift+O"));
 
+    m_quickOpenAction = new QAction(tr("Go to File..."), this);
+    m_quickOpenAction->setShortcut(QKeySequence("Ctrl+P"));
+
     m_saveAction = new QAction(tr("Save"), this);
     m_saveAction->setShortcut(QKeySequence::Save);
     m_saveAction->setIcon(IconUtils::loadForDarkBackground(":/icons/Save.svg"));
@@ -187,6 +209,9 @@ void MainWindow::createActions()
     m_findReplaceAction = new QAction(tr("Find and Replace..."), this);
     m_findReplaceAction->setShortcut(QKeySequence::Find);
 
+    m_findInFilesAction = new QAction(tr("Find in Files..."), this);
+    m_findInFilesAction->setShortcut(QKeySequence("Ctrl+Shift+F"));
+
     m_goToLineAction = new QAction(tr("Go to Line..."), this);
     m_goToLineAction->setShortcut(QKeySequence("Ctrl+G"));
 
@@ -267,6 +292,7 @@ void MainWindow::createFileMenu()
     fileMenu->addSeparator();
     fileMenu->addAction(m_openFileAction);
     fileMenu->addAction(m_openProjectAction);
+    fileMenu->addAction(m_quickOpenAction);
     fileMenu->addSeparator();
     fileMenu->addAction(m_saveAction);
     fileMenu->addAction(m_saveAsAction);
@@ -297,6 +323,7 @@ void MainWindow::createEditMenu()
     editMenu->addAction(m_selectAllAction);
     editMenu->addSeparator();
     editMenu->addAction(m_findReplaceAction);
+    editMenu->addAction(m_findInFilesAction);
     editMenu->addAction(m_goToLineAction);
     editMenu->addSeparator();
     editMenu->addAction(m_toggleBookmarkAction);
@@ -330,6 +357,12 @@ void MainWindow::createViewMenu()
     viewMenu->addAction(tr("Terminal"), this, [this]() {
         m_terminalDock->setVisible(!m_terminalDock->isVisible());
     });
+    viewMenu->addAction(tr("Find Results"), this, [this]() {
+        m_findInFilesDock->setVisible(!m_findInFilesDock->isVisible());
+        if (m_findInFilesDock->isVisible()) {
+            m_findInFilesDock->raise();
+        }
+    });
     viewMenu->addAction(tr("Git History"), this, [this]() {
         m_gitHistoryDock->setVisible(!m_gitHistoryDock->isVisible());
         if (m_gitHistoryDock->isVisible()) {
@@ -337,6 +370,12 @@ void MainWindow::createViewMenu()
             m_gitManager->getLog(100);  // Refresh history when shown
         }
     });
+    viewMenu->addAction(tr("LSP Traffic"), this, [this]() {
+        m_lspTrafficDock->setVisible(!m_lspTrafficDock->isVisible());
+        if (m_lspTrafficDock->isVisible()) {
+            m_lspTrafficDock->raise();
+        }
+    });
 
     viewMenu->addSeparator();
 
@@ -406,6 +445,14 @@ void MainWindow::createGitMenu()
         m_gitManager->push();
     });
 
+    QAction* cancelRemoteAction = gitMenu->addAction(tr("Cancel Remote Operations"));
+    connect(cancelRemoteAction, &QAction::triggered, this, [this]() {
+        m_gitManager->cancelNetworkOperations();
+    });
+    connect(gitMenu, &QMenu::aboutToShow, this, [this, cancelRemoteAction]() {
+        cancelRemoteAction->setEnabled(m_gitManager->isNetworkBusy());
+    });
+
     gitMenu->addSeparator();
 
     QAction* branchesAction = gitMenu->addAction(tr("Branches..."));
@@ -592,6 +639,14 @@ void MainWindow::setupDockWidgets()
     m_terminalDock->setObjectName("TerminalDock");
     m_terminalDock->setWidget(m_terminalPanel);
     tabifyDockWidget(m_buildOutputDock, m_terminalDock);
+
+    // Find in Files results (bottom, tabbed)
+    m_findInFilesPanel = new FindInFilesPanel(this);
+    m_findInFilesPanel->setIndex(m_trigramIndex);
+    m_findInFilesDock = new QDockWidget(tr("Find Results"), this);
+    m_findInFilesDock->setObjectName("FindInFilesDock");
+    m_findInFilesDock->setWidget(m_findInFilesPanel);
+    tabifyDockWidget(m_terminalDock, m_findInFilesDock);
     m_problemsDock->raise(); // Show Problems by default
 
     // Git Changes Panel (left, tabbed with Outline)
@@ -609,9 +664,18 @@ void MainWindow::setupDockWidgets()
     m_gitHistoryDock = new QDockWidget(tr("Git History"), this);
     m_gitHistoryDock->setObjectName("GitHistoryDock");
     m_gitHistoryDock->setWidget(m_gitHistoryPanel);
-    tabifyDockWidget(m_terminalDock, m_gitHistoryDock);
+    tabifyDockWidget(m_findInFilesDock, m_gitHistoryDock);
     m_problemsDock->raise(); // Keep Problems as default
 
+    // LSP Traffic Panel (bottom, tabbed with Git History, hidden until needed)
+    m_lspTrafficPanel = new LSPTrafficPanel(this);
+    m_lspTrafficPanel->setTrafficMonitor(m_lspClient->trafficMonitor());
+    m_lspTrafficDock = new QDockWidget(tr("LSP Traffic"), this);
+    m_lspTrafficDock->setObjectName("LSPTrafficDock");
+    m_lspTrafficDock->setWidget(m_lspTrafficPanel);
+    tabifyDockWidget(m_gitHistoryDock, m_lspTrafficDock);
+    m_lspTrafficDock->hide();
+
     // Set initial sizes
     resizeDocks({m_projectExplorerDock}, {250}, Qt::Horizontal);
     resizeDocks({m_problemsDock}, {200}, Qt::Vertical);
@@ -655,6 +719,7 @@ void MainWindow::setupConnections()
     connect(m_newFileAction, &QAction::triggered, this, &MainWindow::newFile);
     connect(m_newProjectAction, &QAction::triggered, this, &MainWindow::newProject);
     connect(m_openFileAction, &QAction::triggered, this, &MainWindow::openFileDialog);
+    connect(m_quickOpenAction, &QAction::triggered, this, &MainWindow::quickOpen);
     connect(m_openProjectAction, &QAction::triggered, this, &MainWindow::openProjectDialog);
     connect(m_saveAction, &QAction::triggered, this, &MainWindow::saveFile);
     connect(m_saveAsAction, &QAction::triggered, this, &MainWindow::saveFileAs);
@@ -670,6 +735,7 @@ void MainWindow::setupConnections()
     connect(m_pasteAction, &QAction::triggered, this, &MainWindow::paste);
     connect(m_selectAllAction, &QAction::triggered, this, &MainWindow::selectAll);
     connect(m_findReplaceAction, &QAction::triggered, this, &MainWindow::findReplace);
+    connect(m_findInFilesAction, &QAction::triggered, this, &MainWindow::findInFiles);
     connect(m_goToLineAction, &QAction::triggered, this, &MainWindow::goToLine);
     connect(m_toggleBookmarkAction, &QAction::triggered, this, &MainWindow::toggleBookmark);
     connect(m_nextBookmarkAction, &QAction::triggered, this, &MainWindow::nextBookmark);
@@ -761,9 +827,17 @@ void MainWindow::setupConnections()
         // Enable project-specific actions
         m_manageDependenciesAction->setEnabled(true);
 
+        // Walk and watch the tree for everything that follows it
+        m_projectWatcher->open(project->projectDir(), searchExcludedPaths(project));
+
         // Set up Git integration for this project directory
         m_gitManager->setRepositoryPath(project->projectDir());
 
+        // Load the Find in Files index, or build it in the background,
+        // and list the files for Go to File
+        m_trigramIndex->open(project->projectDir());
+        m_projectFileIndex->open(project->projectDir());
+
         // Update status bar color to blue (project loaded)
         updateStatusBarColor(IDEState::ProjectLoaded);
     });
@@ -783,6 +857,10 @@ void MainWindow::setupConnections()
         // Clear Git integration
         m_gitManager->setRepositoryPath(QString());
 
+        m_trigramIndex->close();
+        m_projectFileIndex->close();
+        m_projectWatcher->close();
+
         // Update status bar color to purple (idle)
         updateStatusBarColor(IDEState::Idle);
     });
@@ -857,14 +935,17 @@ void MainWindow::setupConnections()
     });
 
     connect(m_editorTabs, &EditorTabWidget::currentEditorChanged, this, [this](CodeEditor* editor) {
-        if (editor && m_lspClient->isReady()) {
+        if (editor && !editor->isLoading() && m_lspClient->isReady()) {
             // Request document symbols for outline
-            QString uri = "file:///" + editor->filePath().replace("\\", "/");
+            m_documentSync->flushDocument(editor->filePath());
+            QString uri = DocumentSyncManager::filePathToUri(editor->filePath());
             m_lspClient->requestDocumentSymbols(uri);
 
             // Update bookmark display
             QList<int> bookmarks = m_bookmarkManager->bookmarksForFile(editor->filePath());
             editor->setBookmarkedLines(bookmarks);
+
+            requestSemanticTokens(editor);
         }
         m_outlinePanel->clear();
 
@@ -872,33 +953,48 @@ void MainWindow::setupConnections()
         updateLineEndingsLabel();
     });
 
-    // Helper lambda to setup LSP for an editor
-    auto setupEditorLSP = [this](CodeEditor* editor) {
-        if (!editor || !m_lspClient->isReady()) return;
+    // Helper lambda to open an editor's document on the LSP server
+    auto openEditorDocument = [this](CodeEditor* editor) {
+        // Editors still loading are opened once fileOpened fires
+        if (!editor || editor->isLoading() || !m_lspClient->isReady()) return;
 
         QString path = editor->filePath();
         if (path.isEmpty()) return;
 
-        QString uri = "file:///" + path;
-        uri.replace("\\", "/");
+        logToFile(QString("LSP: Opening document %1").arg(DocumentSyncManager::filePathToUri(path)));
+        m_documentSync->openDocument(path, editor->toPlainText());
 
-        logToFile(QString("LSP: Opening document %1").arg(uri));
-        m_lspClient->openDocument(uri, "xxml", 1, editor->toPlainText());
+        if (editor == m_editorTabs->currentEditor()) {
+            m_lspClient->requestDocumentSymbols(DocumentSyncManager::filePathToUri(path));
+            requestSemanticTokens(editor);
+        }
+    };
+
+    // Keep the outline current as edits reach the server
+    connect(m_documentSync, &DocumentSyncManager::changesSent, this, [this](const QString& filePath) {
+        CodeEditor* editor = m_editorTabs->currentEditor();
+        if (editor && editor->filePath() == filePath) {
+            m_lspClient->requestDocumentSymbols(DocumentSyncManager::filePathToUri(filePath));
+            requestSemanticTokens(editor);
+        }
+    });
 
-        // Use a shared_ptr to track document version per editor
-        auto docVersion = std::make_shared<int>(1);
+    // Helper lambda to route an editor's changes and requests to the LSP
+    auto connectEditorLSP = [this](CodeEditor* editor) {
+        if (!editor) return;
 
-        // Document change -> LSP sync
-        connect(editor, &CodeEditor::documentChanged, this, [this, editor, docVersion]() {
+        // Document edit -> LSP sync (ranged when the server supports it)
+        connect(editor, &CodeEditor::documentEdited, this, [this, editor](const LSPTextChange& change) {
             if (!m_lspClient->isReady()) return;
 
             QString filePath = editor->filePath();
-            if (filePath.isEmpty()) return;
+            if (filePath.isEmpty() || !m_documentSync->isOpen(filePath)) return;
 
-            QString uri = "file:///" + filePath;
-            uri.replace("\\", "/");
-            logToFile(QString("LSP: Document changed %1 version %2").arg(uri).arg(*docVersion + 1));
-            m_lspClient->changeDocument(uri, ++(*docVersion), editor->toPlainText());
+            if (m_lspClient->textDocumentSyncKind() == TextDocumentSyncKind::Incremental) {
+                m_documentSync->documentEdited(filePath, change);
+            } else {
+                m_documentSync->documentChanged(filePath, editor->toPlainText());
+            }
         });
 
         // Completion request -> LSP
@@ -908,32 +1004,51 @@ void MainWindow::setupConnections()
             QString filePath = editor->filePath();
             if (filePath.isEmpty()) return;
 
-            QString uri = "file:///" + filePath;
-            uri.replace("\\", "/");
+            // The server must see every edit before computing completions
+            m_documentSync->flushDocument(filePath);
+
             logToFile(QString("LSP: Requesting completion at line %1 char %2").arg(line).arg(character));
-            m_lspClient->requestCompletion(uri, line, character);
+            m_lspClient->requestCompletion(DocumentSyncManager::filePathToUri(filePath), line, character);
+        });
+
+        // Scrolling a large file -> semantic tokens for the new viewport
+        connect(editor, &CodeEditor::viewportChanged, this, [this, editor]() {
+            if (editor == m_editorTabs->currentEditor()) {
+                requestSemanticTokens(editor, true);
+            }
         });
     };
 
-    connect(m_editorTabs, &EditorTabWidget::fileOpened, this, [this, setupEditorLSP](const QString& path) {
+    connect(m_editorTabs, &EditorTabWidget::fileOpened, this, [this, connectEditorLSP, openEditorDocument](const QString& path) {
         CodeEditor* editor = m_editorTabs->editorForFile(path);
-        setupEditorLSP(editor);
+        connectEditorLSP(editor);
+        openEditorDocument(editor);
     });
 
-    // When LSP becomes ready, set up all already-open editors
-    connect(m_lspClient, &LSPClient::initialized, this, [this, setupEditorLSP]() {
+    // When LSP becomes ready, open all already-open editors
+    connect(m_lspClient, &LSPClient::initialized, this, [this, openEditorDocument]() {
         logToFile(QString("LSP: Initialized, setting up %1 editors").arg(m_editorTabs->count()));
         for (int i = 0; i < m_editorTabs->count(); ++i) {
             CodeEditor* editor = m_editorTabs->editorAt(i);
-            setupEditorLSP(editor);
+            openEditorDocument(editor);
+        }
+    });
+
+    connect(m_editorTabs, &EditorTabWidget::fileSaved, this, [this](const QString& path) {
+        m_trigramIndex->fileChanged(path);
+        m_gitManager->notifyFilesChanged({path});
+
+        if (m_lspClient->isReady()) {
+            CodeEditor* editor = m_editorTabs->editorForFile(path);
+            if (editor) {
+                m_documentSync->documentSaved(path, editor->toPlainText());
+            }
         }
     });
 
     connect(m_editorTabs, &EditorTabWidget::fileClosed, this, [this](const QString& path) {
         if (m_lspClient->isReady()) {
-            QString uri = "file:///" + path;
-            uri.replace("\\", "/");
-            m_lspClient->closeDocument(uri);
+            m_documentSync->closeDocument(path);
         }
     });
 
@@ -968,15 +1083,13 @@ void MainWindow::setupConnections()
     });
 
     // LSP completion received -> route to editor
-    connect(m_lspClient, &LSPClient::completionReceived, this, [this](const QString& uri, const QList<LSPCompletionItem>& items) {
+    connect(m_lspClient, &LSPClient::completionReceived, this,
+            [this](const QString& uri, const QList<LSPCompletionItem>& items, int, bool isIncomplete) {
         logToFile(QString("MainWindow::completionReceived: %1 items for URI: %2").arg(items.size()).arg(uri));
         qDebug() << "MainWindow: Received" << items.size() << "completions for" << uri;
 
         // Convert URI to file path
-        QString path = uri;
-        if (path.startsWith("file:///")) {
-            path = path.mid(8);
-        }
+        QString path = DocumentSyncManager::uriToFilePath(uri);
 #ifdef Q_OS_WIN
         // Windows: convert forward slashes to backslashes
         path.replace("/", "\\");
@@ -1010,20 +1123,37 @@ void MainWindow::setupConnections()
 #endif
         if (editor) {
             logToFile(QString("MainWindow: Calling showCompletions with %1 items").arg(items.size()));
-            editor->showCompletions(items);
+            editor->showCompletions(items, isIncomplete);
         } else {
             logToFile(QString("MainWindow: Editor not found for any path variant"));
         }
     });
 
+    // Semantic tokens -> editor highlighting. Tokens are only painted on
+    // the exact text the server saw: not after a newer version was sent,
+    // nor while edits still wait in the sync debounce; the request that
+    // follows those edits brings fresh ones.
+    connect(m_lspClient, &LSPClient::semanticTokensReceived, this,
+            [this](const QString& uri, const QList<LSPSemanticToken>& tokens, int version) {
+        CodeEditor* editor = editorForUri(uri);
+        if (editor && isCurrentDocumentVersion(editor, version)) {
+            editor->setSemanticTokens(tokens);
+        }
+    });
+
+    connect(m_lspClient, &LSPClient::semanticTokensRangeReceived, this,
+            [this](const QString& uri, const LSPRange& range, const QList<LSPSemanticToken>& tokens, int version) {
+        CodeEditor* editor = editorForUri(uri);
+        if (editor && isCurrentDocumentVersion(editor, version)) {
+            editor->setSemanticTokens(tokens, range.start.line, range.end.line - 1);
+        }
+    });
+
     connect(m_lspClient, &LSPClient::diagnosticsReceived, this, [this](const QString& uri, const QList<LSPDiagnostic>& diagnostics) {
         logToFile(QString("LSP: Received %1 diagnostics for %2").arg(diagnostics.size()).arg(uri));
 
         // Convert URI to file path
-        QString path = uri;
-        if (path.startsWith("file:///")) {
-            path = path.mid(8);
-        }
+        QString path = DocumentSyncManager::uriToFilePath(uri);
 #ifdef Q_OS_WIN
         // Windows: convert forward slashes to backslashes
         path.replace("/", "\\");
@@ -1108,6 +1238,12 @@ void MainWindow::setupConnections()
     });
 
     connect(m_lspClient, &LSPClient::documentSymbolsReceived, this, [this](const QString& uri, const QList<LSPDocumentSymbol>& symbols) {
+        // Ignore symbols for a tab that is no longer current
+        CodeEditor* currentEditor = m_editorTabs->currentEditor();
+        if (!currentEditor || DocumentSyncManager::filePathToUri(currentEditor->filePath()) != uri) {
+            return;
+        }
+
         // Convert LSP symbols to outline panel symbols
         QList<DocumentSymbol> outlineSymbols;
 
@@ -1153,6 +1289,44 @@ void MainWindow::setupConnections()
         m_outlinePanel->setSymbols(outlineSymbols);
     });
 
+    // Find in Files: the panel asks for a search, this window knows the
+    // project and the unsaved buffers
+    connect(m_findInFilesPanel, &FindInFilesPanel::searchRequested, this, [this]() {
+        QString rootPath;
+        QStringList excludedPaths = ProjectFileWalker::defaultExcludedPaths({});
+        if (m_projectManager->hasProject()) {
+            Project* project = m_projectManager->currentProject();
+            rootPath = project->projectDir();
+            excludedPaths = searchExcludedPaths(project);
+        } else if (CodeEditor* editor = m_editorTabs->currentEditor(); editor && !editor->filePath().isEmpty()) {
+            rootPath = QFileInfo(editor->filePath()).absolutePath();
+        }
+        if (rootPath.isEmpty()) {
+            statusBar()->showMessage(tr("Open a project to search in files"), 3000);
+            return;
+        }
+
+        // Unsaved edits take precedence over what is on disk
+        QHash<QString, QString> buffers;
+        for (int i = 0; i < m_editorTabs->count(); ++i) {
+            CodeEditor* editor = m_editorTabs->editorAt(i);
+            if (editor && !editor->isLoading() && !editor->filePath().isEmpty()
+                && editor->document()->isModified()) {
+                buffers.insert(editor->filePath(), editor->toPlainText());
+            }
+        }
+
+        m_findInFilesPanel->search(rootPath, excludedPaths, buffers);
+    });
+    connect(m_findInFilesPanel, &FindInFilesPanel::matchActivated, this,
+            [this](const QString& file, int line, int column) {
+        openFile(file);
+        // Large hits may still be loading, or open in a LargeFileViewer
+        if (QWidget* target = m_editorTabs->goToPosition(file, line, column)) {
+            target->setFocus();
+        }
+    });
+
     // Outline panel signals
     connect(m_outlinePanel, &OutlinePanel::symbolDoubleClicked, this, [this](int line, int column) {
         CodeEditor* editor = m_editorTabs->currentEditor();
@@ -1384,6 +1558,56 @@ void MainWindow::updateLineEndingsLabel()
     }
 }
 
+CodeEditor* MainWindow::editorForUri(const QString& uri) const
+{
+    QString path = DocumentSyncManager::uriToFilePath(uri);
+#ifdef Q_OS_WIN
+    path.replace("/", "\\");
+#endif
+
+    CodeEditor* editor = m_editorTabs->editorForFile(path);
+#ifdef Q_OS_WIN
+    // The server may echo the drive letter in either case
+    if (!editor && path.length() > 1 && path[1] == ':') {
+        QString altPath = path;
+        altPath[0] = altPath[0].isLower() ? altPath[0].toUpper() : altPath[0].toLower();
+        editor = m_editorTabs->editorForFile(altPath);
+    }
+#endif
+    return editor;
+}
+
+bool MainWindow::isCurrentDocumentVersion(CodeEditor* editor, int version) const
+{
+    const QString filePath = editor->filePath();
+    return m_documentSync->documentVersion(filePath) == version && !m_documentSync->hasPendingChanges(filePath);
+}
+
+void MainWindow::requestSemanticTokens(CodeEditor* editor, bool viewportOnly)
+{
+    if (!editor || !m_lspClient->isReady()) return;
+
+    QString filePath = editor->filePath();
+    if (filePath.isEmpty() || !m_documentSync->isOpen(filePath)) return;
+
+    QString uri = DocumentSyncManager::filePathToUri(filePath);
+
+    // Large files only get tokens for what is on screen
+    bool useRange = m_lspClient->supportsSemanticTokensRange()
+        && (editor->blockCount() > SEMANTIC_RANGE_MIN_LINES || !m_lspClient->supportsSemanticTokens());
+
+    if (useRange) {
+        LSPRange range;
+        range.start.line = qMax(0, editor->firstVisibleLine() - SEMANTIC_RANGE_MARGIN_LINES);
+        range.start.character = 0;
+        range.end.line = qMin(editor->blockCount(), editor->lastVisibleLine() + SEMANTIC_RANGE_MARGIN_LINES + 1);
+        range.end.character = 0;
+        m_lspClient->requestSemanticTokensRange(uri, range);
+    } else if (!viewportOnly && m_lspClient->supportsSemanticTokens()) {
+        m_lspClient->requestSemanticTokens(uri);
+    }
+}
+
 void MainWindow::setCompilationEntrypoint(const QString& path)
 {
     Project* project = m_projectManager->currentProject();
@@ -1663,6 +1887,19 @@ void MainWindow::openFileDialog()
     }
 }
 
+void MainWindow::quickOpen()
+{
+    if (m_projectFileIndex->rootPath().isEmpty()) {
+        statusBar()->showMessage(tr("Open a project to go to its files"), 3000);
+        return;
+    }
+
+    QuickOpenDialog dialog(m_projectFileIndex, this);
+    if (dialog.exec() == QDialog::Accepted) {
+        openFile(dialog.selectedFile());
+    }
+}
+
 void MainWindow::openProjectDialog()
 {
     QString path = QFileDialog::getOpenFileName(this,
@@ -1735,6 +1972,11 @@ void MainWindow::findReplace()
         m_findReplaceDialog = new FindReplaceDialog(this);
 
         connect(m_findReplaceDialog, &FindReplaceDialog::findNext, this, [this]() {
+            if (LargeFileViewer* viewer = m_editorTabs->currentViewer()) {
+                findInViewer(viewer, false);
+                return;
+            }
+
             CodeEditor* editor = m_editorTabs->currentEditor();
             if (!editor) return;
 
@@ -1751,6 +1993,11 @@ void MainWindow::findReplace()
         });
 
         connect(m_findReplaceDialog, &FindReplaceDialog::findPrevious, this, [this]() {
+            if (LargeFileViewer* viewer = m_editorTabs->currentViewer()) {
+                findInViewer(viewer, true);
+                return;
+            }
+
             CodeEditor* editor = m_editorTabs->currentEditor();
             if (!editor) return;
 
@@ -1795,8 +2042,11 @@ void MainWindow::findReplace()
 
     // Set search text from current selection
     CodeEditor* editor = m_editorTabs->currentEditor();
+    LargeFileViewer* viewer = m_editorTabs->currentViewer();
     if (editor && editor->textCursor().hasSelection()) {
         m_findReplaceDialog->setSearchText(editor->textCursor().selectedText());
+    } else if (viewer && viewer->hasSelection() && !viewer->selectedText().contains('\n')) {
+        m_findReplaceDialog->setSearchText(viewer->selectedText());
     }
 
     m_findReplaceDialog->show();
@@ -1804,8 +2054,65 @@ void MainWindow::findReplace()
     m_findReplaceDialog->activateWindow();
 }
 
+void MainWindow::findInViewer(LargeFileViewer* viewer, bool backward)
+{
+    QString text = m_findReplaceDialog->searchText();
+
+    // The viewer searches in the background and reports back once
+    disconnect(viewer, &LargeFileViewer::findFinished, this, nullptr);
+    connect(viewer, &LargeFileViewer::findFinished, this, [this, text](bool found) {
+        if (found) {
+            statusBar()->showMessage(tr("Found: %1").arg(text), 2000);
+        } else {
+            statusBar()->showMessage(tr("Not found: %1").arg(text), 2000);
+        }
+    });
+
+    statusBar()->showMessage(tr("Searching: %1").arg(text));
+    viewer->find(text,
+                 m_findReplaceDialog->caseSensitive(),
+                 m_findReplaceDialog->wholeWord(),
+                 m_findReplaceDialog->useRegex(),
+                 backward);
+}
+
+QStringList MainWindow::searchExcludedPaths(Project* project) const
+{
+    // Build output would only repeat the sources it came from
+    QStringList outputDirs;
+    outputDirs << project->outputDir();
+    for (const BuildConfiguration& config : project->configurations()) {
+        outputDirs << config.outputDir;
+    }
+    return ProjectFileWalker::defaultExcludedPaths(outputDirs);
+}
+
+void MainWindow::findInFiles()
+{
+    QString text;
+    CodeEditor* editor = m_editorTabs->currentEditor();
+    if (editor && editor->textCursor().hasSelection()
+        && !editor->textCursor().selectedText().contains(QChar::ParagraphSeparator)) {
+        text = editor->textCursor().selectedText();
+    }
+
+    m_findInFilesDock->show();
+    m_findInFilesDock->raise();
+    m_findInFilesPanel->activate(text);
+}
+
 void MainWindow::goToLine()
 {
+    if (LargeFileViewer* viewer = m_editorTabs->currentViewer()) {
+        GoToLineDialog dialog(this);
+        dialog.setMaxLine(viewer->lineCount());
+        dialog.setCurrentLine(viewer->currentLine());
+        if (dialog.exec() == QDialog::Accepted) {
+            viewer->goToLine(dialog.selectedLine());
+        }
+        return;
+    }
+
     CodeEditor* editor = m_editorTabs->currentEditor();
     if (!editor) {
         return;
@@ -1934,6 +2241,7 @@ void MainWindow::resetLayout()
     m_problemsDock->setVisible(true);
     m_buildOutputDock->setVisible(true);
     m_terminalDock->setVisible(true);
+    m_findInFilesDock->setVisible(true);
     m_gitHistoryDock->setVisible(true);
 
     // Re-arrange docks
@@ -1945,7 +2253,9 @@ void MainWindow::resetLayout()
     addDockWidget(Qt::BottomDockWidgetArea, m_problemsDock);
     tabifyDockWidget(m_problemsDock, m_buildOutputDock);
     tabifyDockWidget(m_buildOutputDock, m_terminalDock);
-    tabifyDockWidget(m_terminalDock, m_gitHistoryDock);
+    tabifyDockWidget(m_terminalDock, m_findInFilesDock);
+    tabifyDockWidget(m_findInFilesDock, m_gitHistoryDock);
+    tabifyDockWidget(m_gitHistoryDock, m_lspTrafficDock);
     m_problemsDock->raise();
 
     resizeDocks({m_projectExplorerDock}, {250}, Qt::Horizontal);
@@ -1986,10 +2296,8 @@ void MainWindow::nextBookmark()
             // Open the file if it's different
             openFile(next.filePath);
         }
-        CodeEditor* targetEditor = m_editorTabs->editorForFile(next.filePath);
-        if (targetEditor) {
-            targetEditor->goToLine(next.line);
-        }
+        // Waits for the text if the file is still loading
+        m_editorTabs->goToPosition(next.filePath, next.line);
     }
 }
 
@@ -2009,10 +2317,8 @@ void MainWindow::previousBookmark()
             // Open the file if it's different
             openFile(prev.filePath);
         }
-        CodeEditor* targetEditor = m_editorTabs->editorForFile(prev.filePath);
-        if (targetEditor) {
-            targetEditor->goToLine(prev.line);
-        }
+        // Waits for the text if the file is still loading
+        m_editorTabs->goToPosition(prev.filePath, prev.line);
     }
 }
 
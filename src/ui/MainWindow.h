@@ -14,8 +14,10 @@ namespace XXMLStudio {
 
 class EditorTabWidget;
 class CodeEditor;
+class LargeFileViewer;
 class ProjectExplorer;
 class ProblemsPanel;
+class FindInFilesPanel;
 class BuildOutputPanel;
 class TerminalPanel;
 class OutlinePanel;
@@ -26,9 +28,14 @@ class ProcessRunner;
 class FindReplaceDialog;
 class BookmarkManager;
 class LSPClient;
+class DocumentSyncManager;
 class GitManager;
+class TrigramIndex;
+class ProjectFileIndex;
+class ProjectWatcher;
 class GitChangesPanel;
 class GitHistoryPanel;
+class LSPTrafficPanel;
 class GitBranchWidget;
 class GitStatusIndicator;
 class GitFileDecorator;
@@ -68,6 +75,7 @@ public slots:
     void newFile();
     void newProject();
     void openFileDialog();
+    void quickOpen();
     void openProjectDialog();
     void saveFile();
     void saveFileAs();
@@ -82,6 +90,7 @@ public slots:
     void paste();
     void selectAll();
     void findReplace();
+    void findInFiles();
     void goToLine();
     void toggleBookmark();
     void nextBookmark();
@@ -128,6 +137,16 @@ private:
     void updateStatusBarColor(IDEState state);
     void updateLineEndingsLabel();
     void setCompilationEntrypoint(const QString& path);
+    CodeEditor* editorForUri(const QString& uri) const;
+    // Whether an LSP result for this version still matches the editor's text
+    bool isCurrentDocumentVersion(CodeEditor* editor, int version) const;
+    void requestSemanticTokens(CodeEditor* editor, bool viewportOnly = false);
+    void findInViewer(LargeFileViewer* viewer, bool backward);
+    QStringList searchExcludedPaths(Project* project) const;
+
+    // Above this many lines, semantic tokens are requested for the viewport only
+    static constexpr int SEMANTIC_RANGE_MIN_LINES = 5000;
+    static constexpr int SEMANTIC_RANGE_MARGIN_LINES = 100;
 
     // IDE state tracking
     IDEState m_ideState = IDEState::Idle;
@@ -141,6 +160,7 @@ private:
     QDockWidget* m_buildOutputDock = nullptr;
     QDockWidget* m_terminalDock = nullptr;
     QDockWidget* m_outlineDock = nullptr;
+    QDockWidget* m_findInFilesDock = nullptr;
 
     // Panel widgets
     ProjectExplorer* m_projectExplorer = nullptr;
@@ -148,6 +168,7 @@ private:
     BuildOutputPanel* m_buildOutputPanel = nullptr;
     TerminalPanel* m_terminalPanel = nullptr;
     OutlinePanel* m_outlinePanel = nullptr;
+    FindInFilesPanel* m_findInFilesPanel = nullptr;
 
     // Toolbars
     QToolBar* m_mainToolBar = nullptr;
@@ -166,8 +187,16 @@ private:
     // Dialogs
     FindReplaceDialog* m_findReplaceDialog = nullptr;
 
+    // Find in Files and Go to File indexes of the open project
+    TrigramIndex* m_trigramIndex = nullptr;
+    ProjectFileIndex* m_projectFileIndex = nullptr;
+    ProjectWatcher* m_projectWatcher = nullptr;
+
     // LSP Client
     LSPClient* m_lspClient = nullptr;
+    DocumentSyncManager* m_documentSync = nullptr;
+    QDockWidget* m_lspTrafficDock = nullptr;
+    LSPTrafficPanel* m_lspTrafficPanel = nullptr;
 
     // Bookmark Manager
     BookmarkManager* m_bookmarkManager = nullptr;
@@ -193,6 +222,7 @@ private:
     QAction* m_newProjectAction = nullptr;
     QAction* m_openFileAction = nullptr;
     QAction* m_openProjectAction = nullptr;
+    QAction* m_quickOpenAction = nullptr;
     QAction* m_saveAction = nullptr;
     QAction* m_saveAsAction = nullptr;
     QAction* m_saveAllAction = nullptr;
@@ -207,6 +237,7 @@ private:
     QAction* m_pasteAction = nullptr;
     QAction* m_selectAllAction = nullptr;
     QAction* m_findReplaceAction = nullptr;
+    QAction* m_findInFilesAction = nullptr;
     QAction* m_goToLineAction = nullptr;
     QAction* m_toggleBookmarkAction = nullptr;
     QAction* m_nextBookmarkAction = nullptr;